@@ -22,13 +22,16 @@ if [ "$NM_VALUE" = "" ] ; then
   NM_VALUE=4
 fi
 
+# TARGET INSTRUCTION SET, e.g. OPT_ARCH=-march=native; empty by default.
+# The vector width of the kernels follows from the -m flags given here.
+
 CC=gcc
 OMP_ARGS="-fopenmp"
-OPT_ARGS="-O3 -fomit-frame-pointer -funroll-loops -finline-limit=10000000"
+OPT_ARGS="-O3 $OPT_ARCH -fomit-frame-pointer -funroll-loops -finline-limit=10000000"
 
 # CC=icc
 # OMP_ARGS="-qopenmp"
-# OPT_ARGS="-ip -prec-div -O3 -align -ansi-alias -fargument-noalias -fno-alias -fargument-noalias"
+# OPT_ARGS="-ip -prec-div -O3 $OPT_ARCH -align -ansi-alias -fargument-noalias -fno-alias -fargument-noalias"
 
 #------------------------------------------------------------------------------
 
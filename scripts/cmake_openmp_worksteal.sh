@@ -0,0 +1,49 @@
+#!/bin/bash -l
+#------------------------------------------------------------------------------
+
+# CLEANUP
+rm -rf CMakeCache.txt
+rm -rf CMakeFiles
+
+# SOURCE AND INSTALL
+if [ "$SOURCE" = "" ] ; then
+  SOURCE=../minisweep
+fi
+if [ "$INSTALL" = "" ] ; then
+  INSTALL=../install
+fi
+
+if [ "$BUILD" = "" ] ; then
+  BUILD=Debug
+  #BUILD=Release
+fi
+
+if [ "$NM_VALUE" = "" ] ; then
+  NM_VALUE=4
+fi
+
+# TARGET INSTRUCTION SET, e.g. OPT_ARCH=-march=native; empty by default.
+# The vector width of the kernels follows from the -m flags given here.
+
+CC=gcc
+OMP_ARGS="-fopenmp -pthread"
+OPT_ARGS="-O3 $OPT_ARCH -fomit-frame-pointer -funroll-loops -finline-limit=10000000"
+
+# CC=icc
+# OMP_ARGS="-qopenmp -pthread"
+# OPT_ARGS="-ip -prec-div -O3 $OPT_ARCH -align -ansi-alias -fargument-noalias -fno-alias -fargument-noalias"
+
+#------------------------------------------------------------------------------
+
+cmake \
+  -DCMAKE_BUILD_TYPE:STRING="$BUILD" \
+  -DCMAKE_INSTALL_PREFIX:PATH="$INSTALL" \
+ \
+  -DCMAKE_C_COMPILER:STRING=gcc \
+  -DCMAKE_C_FLAGS:STRING="-DNM_VALUE=$NM_VALUE -DUSE_OPENMP -DUSE_OPENMP_TASKS -DUSE_OPENMP_WORKSTEAL $OMP_ARGS" \
+  -DCMAKE_C_FLAGS_DEBUG:STRING="-g" \
+  -DCMAKE_C_FLAGS_RELEASE:STRING="$OPT_ARGS" \
+ \
+  $SOURCE
+
+#------------------------------------------------------------------------------
@@ -22,6 +22,9 @@ if [ "$NM_VALUE" = "" ] ; then
   NM_VALUE=4
 fi
 
+# TARGET INSTRUCTION SET, e.g. OPT_ARCH=-march=native; empty by default.
+# The vector width of the kernels follows from the -m flags given here.
+
 #------------------------------------------------------------------------------
 
 cmake \
@@ -31,7 +34,7 @@ cmake \
   -DCMAKE_C_COMPILER:STRING=gcc \
   -DCMAKE_C_FLAGS:STRING="-DNM_VALUE=$NM_VALUE $ALG_OPTIONS" \
   -DCMAKE_C_FLAGS_DEBUG:STRING="-g" \
-  -DCMAKE_C_FLAGS_RELEASE:STRING="-O3 -fomit-frame-pointer -funroll-loops -finline-limit=10000000" \
+  -DCMAKE_C_FLAGS_RELEASE:STRING="-O3 $OPT_ARCH -fomit-frame-pointer -funroll-loops -finline-limit=10000000" \
  \
   $SOURCE
 
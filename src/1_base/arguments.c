@@ -92,6 +92,26 @@ void Arguments_create_from_string( Arguments*  args,
   }
 } /*---Arguments_create_from_string---*/
 
+/*===========================================================================*/
+/* Pseudo-constructor that copies the unconsumed entries of another---*/
+
+void Arguments_create_copy( Arguments*       args,
+                            const Arguments* args_from )
+{
+  Assert( args != NULL );
+  Assert( args_from != NULL );
+  int i = 0;
+
+  args->argc = args_from->argc;
+  args->argv_unconsumed = (char**) malloc( args->argc * sizeof( char* ) );
+  args->argstring = 0;
+
+  for( i=0; i<args->argc; ++i )
+  {
+    args->argv_unconsumed[i] = args_from->argv_unconsumed[i];
+  }
+} /*---Arguments_create_copy---*/
+
 /*===========================================================================*/
 /* Pseudo-destructor for Arguments struct---*/
 
@@ -58,6 +58,14 @@ void Arguments_create( Arguments* args,
 void Arguments_create_from_string( Arguments*  args,
                                    const char* argstring );
 
+/*===========================================================================*/
+/* Pseudo-constructor that copies the unconsumed entries of another---*/
+
+/*---The copy refers to the strings of the original, which must outlive it---*/
+
+void Arguments_create_copy( Arguments*       args,
+                            const Arguments* args_from );
+
 /*===========================================================================*/
 /* Pseudo-destructor for Arguments struct---*/
 
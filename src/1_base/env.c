@@ -61,7 +61,8 @@ void Env_finalize( Env* env )
 
 Bool_t Env_is_proc_master( Env* env )
 {
-  return ( Env_is_proc_active( env ) && Env_proc_this( env ) == 0 );
+  return ( Env_is_proc_active( env ) && Env_proc_this( env ) == 0 &&
+           Env_proc_a_this( env ) == 0 && Env_proc_e_this( env ) == 0 );
 }
 
 /*===========================================================================*/
@@ -126,6 +126,27 @@ P* malloc_host_P( size_t n )
   return result;
 }
 
+/*---------------------------------------------------------------------------*/
+/*---Alignment must be a power of 2; free with free_host_aligned_P---*/
+
+P* malloc_host_aligned_P( size_t n, size_t alignment )
+{
+  Assert( n+1 >= 1 );
+  Assert( alignment >= sizeof(void*) && ( alignment & (alignment-1) ) == 0 );
+
+  /*---Keep the address returned by malloc just below the aligned block---*/
+
+  char* const base = (char*)malloc( n * sizeof(P) + alignment + sizeof(void*) );
+  Assert( base );
+
+  const size_t offset = (size_t)( base + sizeof(void*) ) % alignment;
+  char* const result = base + sizeof(void*) +
+                       ( offset == 0 ? 0 : alignment - offset );
+  ( (void**)result )[-1] = (void*)base;
+
+  return (P*)result;
+}
+
 /*---------------------------------------------------------------------------*/
 
 P* malloc_host_pinned_P( size_t n )
@@ -180,6 +201,14 @@ void free_host_P( P* p )
 
 /*---------------------------------------------------------------------------*/
 
+void free_host_aligned_P( P* p )
+{
+  Assert( p );
+  free( ( (void**)p )[-1] );
+}
+
+/*---------------------------------------------------------------------------*/
+
 void free_host_pinned_P( P* p )
 {
   Assert( p );
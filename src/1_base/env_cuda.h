@@ -64,6 +64,10 @@ P* malloc_host_P( size_t n );
 
 /*---------------------------------------------------------------------------*/
 
+P* malloc_host_aligned_P( size_t n, size_t alignment );
+
+/*---------------------------------------------------------------------------*/
+
 P* malloc_host_pinned_P( size_t n );
 
 /*---------------------------------------------------------------------------*/
@@ -80,6 +84,10 @@ void free_host_P( P* p );
 
 /*---------------------------------------------------------------------------*/
 
+void free_host_aligned_P( P* p );
+
+/*---------------------------------------------------------------------------*/
+
 void free_host_pinned_P( P* p );
 
 /*---------------------------------------------------------------------------*/
@@ -16,6 +16,7 @@
 #include "env_openmp_kernels.h"
 #include "env_cuda_kernels.h"
 #include "env_mic_kernels.h"
+#include "env_simd_kernels.h"
 
 #endif /*---_env_kernels_h_---*/
 
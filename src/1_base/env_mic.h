@@ -41,6 +41,16 @@ static P* malloc_host_P( size_t n )
 
 /*---------------------------------------------------------------------------*/
 
+static P* malloc_host_aligned_P( size_t n, size_t alignment )
+{
+  Assert( n+1 >= 1 );
+  P* result = _mm_malloc( n * sizeof(P), alignment );
+  Assert( result );
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
 static P* malloc_host_pinned_P( size_t n )
 {
   return malloc_host_P( n );
@@ -73,6 +83,13 @@ static void free_host_P( P* p )
 
 /*---------------------------------------------------------------------------*/
 
+static void free_host_aligned_P( P* p )
+{
+  free_host_P( p );
+}
+
+/*---------------------------------------------------------------------------*/
+
 static void free_host_pinned_P( P* p )
 {
   free_host_P( p );
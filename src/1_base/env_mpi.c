@@ -8,6 +8,7 @@
  */
 /*---------------------------------------------------------------------------*/
 
+#include <stdlib.h>
 #include <string.h>
 
 #ifdef USE_MPI
@@ -33,8 +34,14 @@ void Env_mpi_nullify_values_( Env *env )
   /*---Initialize MPI-related variables in env struct to null---*/
   env->nproc_x_ = 0;
   env->nproc_y_ = 0;
+  env->nproc_z_ = 0;
+  env->nproc_e_ = 0;
+  env->nproc_a_ = 0;
   env->tag_ = 0;
   env->active_comm_ = 0;
+  env->space_comm_ = 0;
+  env->angle_comm_ = 0;
+  env->node_comm_ = 0;
   env->is_proc_active_ = 0;
 #endif
 }
@@ -45,8 +52,19 @@ void Env_mpi_initialize_( Env *env, int argc, char** argv )
 {
 #ifdef USE_MPI
   /*---Initialize for MPI execution---*/
+#ifdef USE_OPENMP
+  /*---The main thread may make MPI calls from inside a threaded region,
+       e.g., to progress communication during the sweep---*/
+  int provided = 0;
+  const int mpi_code = MPI_Init_thread( &argc, &argv, MPI_THREAD_FUNNELED,
+                                        &provided );
+  Assert( mpi_code == MPI_SUCCESS );
+  Insist( provided >= MPI_THREAD_FUNNELED ?
+          "MPI library does not support the required thread level." : 0 );
+#else
   const int mpi_code = MPI_Init( &argc, &argv );
   Assert( mpi_code == MPI_SUCCESS );
+#endif
 #endif
   Env_mpi_nullify_values_( env );
 }
@@ -72,6 +90,21 @@ void Env_mpi_finalize_values_( Env* env )
 #ifdef USE_MPI
   if( Env_mpi_are_values_set_( env ) )
   {
+    if( env->node_comm_ != MPI_COMM_WORLD )
+    {
+      const int mpi_code = MPI_Comm_free( &env->node_comm_ );
+      Assert( mpi_code == MPI_SUCCESS );
+    }
+    if( env->angle_comm_ != MPI_COMM_WORLD )
+    {
+      const int mpi_code = MPI_Comm_free( &env->angle_comm_ );
+      Assert( mpi_code == MPI_SUCCESS );
+    }
+    if( env->space_comm_ != MPI_COMM_WORLD )
+    {
+      const int mpi_code = MPI_Comm_free( &env->space_comm_ );
+      Assert( mpi_code == MPI_SUCCESS );
+    }
     if( env->active_comm_ != MPI_COMM_WORLD )
     {
       const int mpi_code = MPI_Comm_free( &env->active_comm_ );
@@ -94,6 +127,122 @@ void Env_mpi_finalize_( Env* env )
 #endif
 }
 
+/*===========================================================================*/
+/*---Renumber the procs of space_comm so each node holds a compact tile of
+     the process grid---*/
+/*---pseudo-private member function---*/
+
+/*---Requires the same number of procs of space_comm on every node.  The
+     tile shape is the one dividing the grid with the fewest grid links
+     leaving the tile.  Nodes take tiles in order of their lowest proc;
+     procs of a node fill its tile in order.  If no tile fits, the
+     numbering is left unchanged.
+---*/
+
+#ifdef USE_MPI
+static void Env_mpi_tile_space_comm_( Env* env )
+{
+  const int nproc_x = env->nproc_x_;
+  const int nproc_y = env->nproc_y_;
+  const int nproc_z = env->nproc_z_;
+
+  int mpi_code = 0;
+  Comm_t node_comm;
+  int proc = 0;
+  int proc_node = 0;
+  int nproc_node = 0;
+  int nproc_node_min = 0;
+  int nproc_node_max = 0;
+  int is_node_first = 0;
+  int node = 0;
+
+  mpi_code = MPI_Comm_rank( env->space_comm_, &proc );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Comm_split_type( env->space_comm_, MPI_COMM_TYPE_SHARED,
+                                  proc, MPI_INFO_NULL, &node_comm );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Comm_rank( node_comm, &proc_node );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Comm_size( node_comm, &nproc_node );
+  Assert( mpi_code == MPI_SUCCESS );
+
+  mpi_code = MPI_Allreduce( &nproc_node, &nproc_node_min, 1, MPI_INT,
+                            MPI_MIN, env->space_comm_ );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Allreduce( &nproc_node, &nproc_node_max, 1, MPI_INT,
+                            MPI_MAX, env->space_comm_ );
+  Assert( mpi_code == MPI_SUCCESS );
+
+  /*---Node number: count of nodes whose first proc precedes this one's---*/
+
+  is_node_first = proc_node == 0;
+  mpi_code = MPI_Exscan( &is_node_first, &node, 1, MPI_INT, MPI_SUM,
+                         env->space_comm_ );
+  Assert( mpi_code == MPI_SUCCESS );
+  node = proc == 0 ? 0 : node;
+  mpi_code = MPI_Bcast( &node, 1, MPI_INT, 0, node_comm );
+  Assert( mpi_code == MPI_SUCCESS );
+
+  mpi_code = MPI_Comm_free( &node_comm );
+  Assert( mpi_code == MPI_SUCCESS );
+
+  /*---Choose the tile shape---*/
+
+  int tile_x = 0;
+  int tile_y = 0;
+  int tile_z = 0;
+  int nlink_best = -1;
+  int tx = 0;
+  int ty = 0;
+
+  for( tx=1; tx<=nproc_x; ++tx )
+  for( ty=1; ty<=nproc_y; ++ty )
+  {
+    const int tz = nproc_node / ( tx * ty );
+
+    if( nproc_node_min == nproc_node_max && tz >= 1 &&
+        tx * ty * tz == nproc_node && nproc_x % tx == 0 &&
+        nproc_y % ty == 0 && nproc_z % tz == 0 )
+    {
+      const int nlink = ty * tz + tx * tz + tx * ty;
+      if( nlink_best < 0 || nlink < nlink_best )
+      {
+        nlink_best = nlink;
+        tile_x = tx;
+        tile_y = ty;
+        tile_z = tz;
+      }
+    }
+  }
+
+  if( nlink_best < 0 )
+  {
+    return;
+  }
+
+  /*---Position of this proc in the grid---*/
+
+  const int ntile_x = nproc_x / tile_x;
+  const int ntile_y = nproc_y / tile_y;
+
+  const int proc_x = tile_x * (   node % ntile_x )
+                   + proc_node % tile_x;
+  const int proc_y = tile_y * ( ( node / ntile_x ) % ntile_y )
+                   + ( proc_node / tile_x ) % tile_y;
+  const int proc_z = tile_z * (   node / ( ntile_x * ntile_y ) )
+                   + proc_node / ( tile_x * tile_y );
+
+  Comm_t space_comm;
+  mpi_code = MPI_Comm_split( env->space_comm_, 0,
+                             Env_proc( env, proc_x, proc_y, proc_z ),
+                             &space_comm );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Comm_free( &env->space_comm_ );
+  Assert( mpi_code == MPI_SUCCESS );
+  env->space_comm_ = space_comm;
+}
+#endif
+
 /*===========================================================================*/
 /*---Set values from args---*/
 
@@ -113,10 +262,20 @@ void Env_mpi_set_values_( Env *env, Arguments* args )
 
   env->nproc_x_ = Arguments_consume_int_or_default( args, "--nproc_x", 1 );
   env->nproc_y_ = Arguments_consume_int_or_default( args, "--nproc_y", 1 );
+  env->nproc_z_ = Arguments_consume_int_or_default( args, "--nproc_z", 1 );
+  env->nproc_e_ = Arguments_consume_int_or_default( args, "--nproc_e", 1 );
+  env->nproc_a_ = Arguments_consume_int_or_default( args, "--nproc_a", 1 );
   Insist( env->nproc_x_ > 0 ? "Invalid nproc_x supplied." : 0 );
   Insist( env->nproc_y_ > 0 ? "Invalid nproc_y supplied." : 0 );
+  Insist( env->nproc_z_ > 0 ? "Invalid nproc_z supplied." : 0 );
+  Insist( env->nproc_e_ > 0 ? "Invalid nproc_e supplied." : 0 );
+  Insist( env->nproc_a_ > 0 ? "Invalid nproc_a supplied." : 0 );
 
-  const int nproc_requested = env->nproc_x_ * env->nproc_y_;
+  const Bool_t is_proc_grid_node_aware = Arguments_consume_int_or_default(
+                          args, "--is_proc_grid_node_aware", Bool_false );
+
+  const int nproc_space = env->nproc_x_ * env->nproc_y_ * env->nproc_z_;
+  const int nproc_requested = nproc_space * env->nproc_a_ * env->nproc_e_;
   int nproc_world = 0;
   mpi_code = MPI_Comm_size( MPI_COMM_WORLD, &nproc_world );
   Assert( mpi_code == MPI_SUCCESS );
@@ -135,6 +294,35 @@ void Env_mpi_set_values_( Env *env, Arguments* args )
                                                    rank, &env->active_comm_ );
   Assert( mpi_code == MPI_SUCCESS );
 
+  /*---Each energy slice is swept by its own set of procs, which
+       communicate faces only among themselves; collective operations
+       such as norms use the active communicator and so span all slices.
+       Likewise for each angle group within a slice.
+       Proc numbering: space + nproc_space * ( proc_a + nproc_a * proc_e )---*/
+  mpi_code = MPI_Comm_split( env->active_comm_, rank / nproc_space,
+                                                    rank, &env->space_comm_ );
+  Assert( mpi_code == MPI_SUCCESS );
+
+  if( is_proc_grid_node_aware && env->is_proc_active_ )
+  {
+    Env_mpi_tile_space_comm_( env );
+  }
+
+  /*---The angle groups of a subdomain combine their results---*/
+  int proc_space = 0;
+  mpi_code = MPI_Comm_rank( env->space_comm_, &proc_space );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Comm_split( env->active_comm_, proc_space +
+                   nproc_space * ( rank / ( nproc_space * env->nproc_a_ ) ),
+                                                    rank, &env->angle_comm_ );
+  Assert( mpi_code == MPI_SUCCESS );
+
+  /*---Procs of the slice and group that can share memory, for
+       intra-node face communication---*/
+  mpi_code = MPI_Comm_split_type( env->space_comm_, MPI_COMM_TYPE_SHARED,
+                                  rank, MPI_INFO_NULL, &env->node_comm_ );
+  Assert( mpi_code == MPI_SUCCESS );
+
   env->tag_ = 0;
 #endif
 }
@@ -152,6 +340,45 @@ Comm_t Env_mpi_active_comm_( const Env* env )
 #endif
 }
 
+/*---------------------------------------------------------------------------*/
+/*---Get communicator for the procs sweeping this proc's energy slice---*/
+
+Comm_t Env_mpi_space_comm_( const Env* env )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+#ifdef USE_MPI
+  return env->space_comm_;
+#else
+  return 0;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Get communicator for the angle groups of this proc's subdomain---*/
+
+Comm_t Env_mpi_angle_comm_( const Env* env )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+#ifdef USE_MPI
+  return env->angle_comm_;
+#else
+  return 0;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Get communicator for the procs of space_comm on this proc's node---*/
+
+Comm_t Env_mpi_node_comm_( const Env* env )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+#ifdef USE_MPI
+  return env->node_comm_;
+#else
+  return 0;
+#endif
+}
+
 /*===========================================================================*/
 /*---Number of procs---*/
 
@@ -181,10 +408,50 @@ int Env_nproc_y( const Env* env )
 
 /*---------------------------------------------------------------------------*/
 
+int Env_nproc_z( const Env* env )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  int result = 1;
+#ifdef USE_MPI
+  result = env->nproc_z_;
+#endif
+  Assert( result > 0 );
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int Env_nproc_e( const Env* env )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  int result = 1;
+#ifdef USE_MPI
+  result = env->nproc_e_;
+#endif
+  Assert( result > 0 );
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int Env_nproc_a( const Env* env )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  int result = 1;
+#ifdef USE_MPI
+  result = env->nproc_a_;
+#endif
+  Assert( result > 0 );
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
 int Env_nproc( const Env* env )
 {
   Assert( Env_mpi_are_values_set_( env ) );
-  return Env_nproc_x( env ) * Env_nproc_y( env );
+  return Env_nproc_x( env ) * Env_nproc_y( env ) * Env_nproc_z( env )
+                            * Env_nproc_a( env ) * Env_nproc_e( env );
 }
 
 /*===========================================================================*/
@@ -229,13 +496,15 @@ void Env_increment_tag( Env* env, int value )
 /*===========================================================================*/
 /*---Proc number info---*/
 
-int Env_proc( const Env* env, int proc_x, int proc_y )
+int Env_proc( const Env* env, int proc_x, int proc_y, int proc_z )
 {
   Assert( Env_mpi_are_values_set_( env ) );
   Assert( proc_x >= 0 && proc_x < Env_nproc_x( env ) );
   Assert( proc_y >= 0 && proc_y < Env_nproc_y( env ) );
-  int result = proc_x + Env_nproc_x( env ) * proc_y;
-  Assert( result >= 0 && result < Env_nproc_x( env ) * Env_nproc_y( env ) );
+  Assert( proc_z >= 0 && proc_z < Env_nproc_z( env ) );
+  int result = proc_x + Env_nproc_x( env ) * (
+               proc_y + Env_nproc_y( env ) * proc_z );
+  Assert( result >= 0 && result < Env_nproc( env ) );
   return result;
 }
 
@@ -256,20 +525,34 @@ int Env_proc_y( const Env* env, int proc )
 {
   Assert( Env_mpi_are_values_set_( env ) );
   Assert( proc >= 0 && proc < Env_nproc( env ) );
-  int result = proc / Env_nproc_x( env );
+  int result = ( proc / Env_nproc_x( env ) ) % Env_nproc_y( env );
   Assert( result >= 0 && result < Env_nproc_y( env ) );
   return result;
 }
 
+/*---------------------------------------------------------------------------*/
+
+int Env_proc_z( const Env* env, int proc )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  Assert( proc >= 0 && proc < Env_nproc( env ) );
+  int result = proc / ( Env_nproc_x( env ) * Env_nproc_y( env ) );
+  Assert( result >= 0 && result < Env_nproc_z( env ) );
+  return result;
+}
+
 /*===========================================================================*/
 /*---Proc number info for this proc---*/
 
+/*---Proc number within the procs sharing this proc's energy slice and
+     angle group---*/
+
 int Env_proc_this( const Env* env )
 {
   Assert( Env_mpi_are_values_set_( env ) );
   int result = 0;
 #ifdef USE_MPI
-  const int mpi_code = MPI_Comm_rank( Env_mpi_active_comm_( env ), &result );
+  const int mpi_code = MPI_Comm_rank( Env_mpi_space_comm_( env ), &result );
   Assert( mpi_code == MPI_SUCCESS );
 #endif
   Assert( result >= 0 && result < Env_nproc( env ) );
@@ -292,6 +575,44 @@ int Env_proc_y_this( const Env* env )
   return Env_proc_y( env, Env_proc_this( env ) );
 }
 
+/*---------------------------------------------------------------------------*/
+
+int Env_proc_z_this( const Env* env )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  return Env_proc_z( env, Env_proc_this( env ) );
+}
+
+/*---------------------------------------------------------------------------*/
+
+int Env_proc_e_this( const Env* env )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  int result = 0;
+#ifdef USE_MPI
+  const int mpi_code = MPI_Comm_rank( Env_mpi_active_comm_( env ), &result );
+  Assert( mpi_code == MPI_SUCCESS );
+  result /= Env_nproc_x( env ) * Env_nproc_y( env ) * Env_nproc_z( env )
+                               * Env_nproc_a( env );
+#endif
+  Assert( result >= 0 && result < Env_nproc_e( env ) );
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int Env_proc_a_this( const Env* env )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  int result = 0;
+#ifdef USE_MPI
+  const int mpi_code = MPI_Comm_rank( Env_mpi_angle_comm_( env ), &result );
+  Assert( mpi_code == MPI_SUCCESS );
+#endif
+  Assert( result >= 0 && result < Env_nproc_a( env ) );
+  return result;
+}
+
 /*===========================================================================*/
 /*---MPI functions: global MPI operations---*/
 
@@ -322,6 +643,22 @@ double Env_sum_d( Env* env, double value )
 
 /*---------------------------------------------------------------------------*/
 
+int Env_max_i( Env* env, int value )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  int result = 0;
+#ifdef USE_MPI
+  const int mpi_code = MPI_Allreduce( &value, &result, 1, MPI_INT, MPI_MAX,
+                                                Env_mpi_active_comm_( env ) );
+  Assert( mpi_code == MPI_SUCCESS );
+#else
+  result = value;
+#endif
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
 P Env_sum_P( Env* env, P value )
 {
   Assert( Env_mpi_are_values_set_( env ) );
@@ -329,6 +666,25 @@ P Env_sum_P( Env* env, P value )
   return Env_sum_d( env, value );
 }
 
+/*---------------------------------------------------------------------------*/
+/*---Sum a vector in place over the angle groups of this subdomain---*/
+
+void Env_sum_angle_groups_P( Env* env, P* data, size_t n )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  Static_Assert( P_IS_DOUBLE );
+  Assert( data != NULL );
+  Assert( n+1 >= 1 );
+#ifdef USE_MPI
+  if( Env_nproc_a( env ) > 1 )
+  {
+    const int mpi_code = MPI_Allreduce( MPI_IN_PLACE, data, n, MPI_DOUBLE,
+                                    MPI_SUM, Env_mpi_angle_comm_( env ) );
+    Assert( mpi_code == MPI_SUCCESS );
+  }
+#endif
+}
+
 /*---------------------------------------------------------------------------*/
 
 void Env_bcast_int( Env* env, int* data, int root )
@@ -366,7 +722,7 @@ void Env_send_i( Env* env, const int* data, size_t n, int proc, int tag )
 
 #ifdef USE_MPI
   const int mpi_code = MPI_Send( (void*)data, n, MPI_INT, proc, tag,
-                                                Env_mpi_active_comm_( env ) );
+                                                Env_mpi_space_comm_( env ) );
   Assert( mpi_code == MPI_SUCCESS );
 #endif
 }
@@ -384,7 +740,7 @@ void Env_recv_i( Env* env, int* data, size_t n, int proc, int tag )
 #ifdef USE_MPI
   MPI_Status status;
   const int mpi_code = MPI_Recv( (void*)data, n, MPI_INT, proc, tag,
-                                       Env_mpi_active_comm_( env ), &status );
+                                       Env_mpi_space_comm_( env ), &status );
   Assert( mpi_code == MPI_SUCCESS );
 #endif
 }
@@ -402,7 +758,7 @@ void Env_send_P( Env* env, const P* data, size_t n, int proc, int tag )
 
 #ifdef USE_MPI
   const int mpi_code = MPI_Send( (void*)data, n, MPI_DOUBLE, proc, tag,
-                                                Env_mpi_active_comm_( env ) );
+                                                Env_mpi_space_comm_( env ) );
   Assert( mpi_code == MPI_SUCCESS );
 #endif
 }
@@ -421,7 +777,30 @@ void Env_recv_P( Env* env, P* data, size_t n, int proc, int tag )
 #ifdef USE_MPI
   MPI_Status status;
   const int mpi_code = MPI_Recv( (void*)data, n, MPI_DOUBLE, proc, tag,
-                                       Env_mpi_active_comm_( env ), &status );
+                                       Env_mpi_space_comm_( env ), &status );
+  Assert( mpi_code == MPI_SUCCESS );
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Send the buffer, then overwrite it with the received values---*/
+
+void Env_sendrecv_replace_P( Env* env, P* data, size_t n,
+                             int proc_send, int proc_recv, int tag )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  Static_Assert( P_IS_DOUBLE );
+  Assert( data != NULL );
+  Assert( n+1 >= 1 );
+  Assert( proc_send>=0 && proc_send<Env_nproc( env ) );
+  Assert( proc_recv>=0 && proc_recv<Env_nproc( env ) );
+  Assert( tag>=0 );
+
+#ifdef USE_MPI
+  MPI_Status status;
+  const int mpi_code = MPI_Sendrecv_replace( (void*)data, n, MPI_DOUBLE,
+                                       proc_send, tag, proc_recv, tag,
+                                       Env_mpi_space_comm_( env ), &status );
   Assert( mpi_code == MPI_SUCCESS );
 #endif
 }
@@ -442,7 +821,7 @@ void Env_asend_P( Env* env, const P* data, size_t n, int proc, int tag,
 
 #ifdef USE_MPI
   const int mpi_code = MPI_Isend( (void*)data, n, MPI_DOUBLE, proc, tag,
-                                       Env_mpi_active_comm_( env ), request );
+                                       Env_mpi_space_comm_( env ), request );
   Assert( mpi_code == MPI_SUCCESS );
 #endif
 }
@@ -462,7 +841,7 @@ void Env_arecv_P( Env* env, const P* data, size_t n, int proc, int tag,
 
 #ifdef USE_MPI
   const int mpi_code = MPI_Irecv( (void*)data, n, MPI_DOUBLE, proc, tag,
-                                       Env_mpi_active_comm_( env ), request );
+                                       Env_mpi_space_comm_( env ), request );
   Assert( mpi_code == MPI_SUCCESS );
 #endif
 }
@@ -478,6 +857,252 @@ void Env_wait( Env* env, Request_t* request )
 #endif
 }
 
+/*---------------------------------------------------------------------------*/
+/*---Test without blocking whether all the requests are complete; the
+     call also lets the MPI library progress the outstanding communication---*/
+
+Bool_t Env_testall( Env* env, Request_t* requests, int n )
+{
+  Assert( requests != NULL );
+  Assert( n >= 0 );
+
+  int flag = Bool_true;
+#ifdef USE_MPI
+  const int mpi_code = MPI_Testall( n, requests, &flag, MPI_STATUSES_IGNORE );
+  Assert( mpi_code == MPI_SUCCESS );
+#endif
+  return flag ? Bool_true : Bool_false;
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Mark a request as having no communication associated with it---*/
+
+void Env_request_nullify( Env* env, Request_t* request )
+{
+  Assert( request != NULL );
+
+#ifdef USE_MPI
+  *request = MPI_REQUEST_NULL;
+#else
+  *request = 0;
+#endif
+}
+
+/*===========================================================================*/
+/*---MPI functions: point-to-point communication: persistent---*/
+
+/*---The request is set up once, then started and waited on repeatedly---*/
+
+void Env_asend_init_P( Env* env, const P* data, size_t n, int proc, int tag,
+                                                          Request_t* request )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  Static_Assert( P_IS_DOUBLE );
+  Assert( data != NULL );
+  Assert( n+1 >= 1 );
+  Assert( proc>=0 && proc<Env_nproc( env ) );
+  Assert( tag>=0 );
+  Assert( request != NULL );
+
+#ifdef USE_MPI
+  const int mpi_code = MPI_Send_init( (void*)data, n, MPI_DOUBLE, proc, tag,
+                                       Env_mpi_space_comm_( env ), request );
+  Assert( mpi_code == MPI_SUCCESS );
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+void Env_arecv_init_P( Env* env, const P* data, size_t n, int proc, int tag,
+                                                          Request_t* request )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  Static_Assert( P_IS_DOUBLE );
+  Assert( data != NULL );
+  Assert( n+1 >= 1 );
+  Assert( proc>=0 && proc<Env_nproc( env ) );
+  Assert( tag>=0 );
+  Assert( request != NULL );
+
+#ifdef USE_MPI
+  const int mpi_code = MPI_Recv_init( (void*)data, n, MPI_DOUBLE, proc, tag,
+                                       Env_mpi_space_comm_( env ), request );
+  Assert( mpi_code == MPI_SUCCESS );
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+void Env_start( Env* env, Request_t* request )
+{
+  Assert( request != NULL );
+
+#ifdef USE_MPI
+  const int mpi_code = MPI_Start( request );
+  Assert( mpi_code == MPI_SUCCESS );
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+void Env_request_free( Env* env, Request_t* request )
+{
+  Assert( request != NULL );
+
+#ifdef USE_MPI
+  const int mpi_code = MPI_Request_free( request );
+  Assert( mpi_code == MPI_SUCCESS );
+#endif
+}
+
+/*===========================================================================*/
+/*---MPI functions: shared memory among the procs of a node---*/
+
+/*---Proc number within the node of a proc of space_comm, or -1 if the
+     proc does not share memory with this proc---*/
+
+int Env_proc_node( const Env* env, int proc )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  Assert( proc>=0 && proc<Env_nproc( env ) );
+
+  int result = proc == 0 ? 0 : -1;
+#ifdef USE_MPI
+  MPI_Group group_space;
+  MPI_Group group_node;
+  int mpi_code = 0;
+  mpi_code = MPI_Comm_group( Env_mpi_space_comm_( env ), &group_space );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Comm_group( Env_mpi_node_comm_( env ), &group_node );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Group_translate_ranks( group_space, 1, &proc,
+                                        group_node, &result );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Group_free( &group_node );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Group_free( &group_space );
+  Assert( mpi_code == MPI_SUCCESS );
+  result = result == MPI_UNDEFINED ? -1 : result;
+#endif
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Allocate n bytes of zeroed memory that the other procs of the node can
+     access directly; collective over the procs of the node.  Returns this
+     proc's part---*/
+
+/*---Access is by plain loads and stores, ordered by the flags below, so
+     the unified memory model is required.  The window stays in a passive
+     target epoch for its whole life.
+---*/
+
+void* Env_shm_allocate( Env* env, size_t n, Win_t* win )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  Assert( n+1 >= 1 );
+  Assert( win != NULL );
+
+  void* result = NULL;
+#ifdef USE_MPI
+  int* model = NULL;
+  int flag = 0;
+  int mpi_code = 0;
+  mpi_code = MPI_Win_allocate_shared( n, 1, MPI_INFO_NULL,
+                           Env_mpi_node_comm_( env ), &result, win );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Win_get_attr( *win, MPI_WIN_MODEL, &model, &flag );
+  Assert( mpi_code == MPI_SUCCESS );
+  Insist( flag && *model == MPI_WIN_UNIFIED ?
+          "Shared memory windows not supported for this MPI library" : 0 );
+  mpi_code = MPI_Win_lock_all( MPI_MODE_NOCHECK, *win );
+  Assert( mpi_code == MPI_SUCCESS );
+  memset( result, 0, n );
+  /*---Make the zeroed memory visible before any proc uses it---*/
+  mpi_code = MPI_Win_sync( *win );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Barrier( Env_mpi_node_comm_( env ) );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Win_sync( *win );
+  Assert( mpi_code == MPI_SUCCESS );
+#else
+  result = calloc( n, 1 );
+  *win = result;
+#endif
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Part of the shared memory belonging to a proc of the node---*/
+
+void* Env_shm_ptr( Env* env, Win_t* win, int proc )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  Assert( win != NULL );
+  Assert( Env_proc_node( env, proc ) >= 0 );
+
+  void* result = NULL;
+#ifdef USE_MPI
+  MPI_Aint size = 0;
+  int disp_unit = 0;
+  const int mpi_code = MPI_Win_shared_query( *win, Env_proc_node( env, proc ),
+                                             &size, &disp_unit, &result );
+  Assert( mpi_code == MPI_SUCCESS );
+#else
+  result = *win;
+#endif
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
+void Env_shm_free( Env* env, Win_t* win )
+{
+  Assert( Env_mpi_are_values_set_( env ) );
+  Assert( win != NULL );
+
+#ifdef USE_MPI
+  int mpi_code = 0;
+  mpi_code = MPI_Win_unlock_all( *win );
+  Assert( mpi_code == MPI_SUCCESS );
+  mpi_code = MPI_Win_free( win );
+  Assert( mpi_code == MPI_SUCCESS );
+#else
+  free( *win );
+  *win = NULL;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Flags in shared memory: the release store makes the data written
+     before it visible to the proc that sees the new value---*/
+
+void Env_shm_flag_set( int* flag, int value )
+{
+  Assert( flag != NULL );
+  __atomic_store_n( flag, value, __ATOMIC_RELEASE );
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Wait until a flag in shared memory has the value.  While waiting, MPI
+     is polled so that this proc's messages to other nodes keep moving---*/
+
+void Env_shm_flag_wait( Env* env, int* flag, int value )
+{
+  Assert( flag != NULL );
+
+  while( __atomic_load_n( flag, __ATOMIC_ACQUIRE ) != value )
+  {
+#ifdef USE_MPI
+    int is_message = 0;
+    const int mpi_code = MPI_Iprobe( MPI_ANY_SOURCE, MPI_ANY_TAG,
+                                     Env_mpi_space_comm_( env ), &is_message,
+                                     MPI_STATUS_IGNORE );
+    Assert( mpi_code == MPI_SUCCESS );
+#endif
+  }
+}
+
 /*===========================================================================*/
 
 #ifdef __cplusplus
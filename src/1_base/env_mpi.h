@@ -59,6 +59,18 @@ void Env_mpi_set_values_( Env *env, Arguments* args );
 
 Comm_t Env_mpi_active_comm_( const Env* env );
 
+/*---------------------------------------------------------------------------*/
+
+Comm_t Env_mpi_space_comm_( const Env* env );
+
+/*---------------------------------------------------------------------------*/
+
+Comm_t Env_mpi_angle_comm_( const Env* env );
+
+/*---------------------------------------------------------------------------*/
+
+Comm_t Env_mpi_node_comm_( const Env* env );
+
 /*===========================================================================*/
 /*---Number of procs---*/
 
@@ -70,6 +82,18 @@ int Env_nproc_y( const Env* env );
 
 /*---------------------------------------------------------------------------*/
 
+int Env_nproc_z( const Env* env );
+
+/*---------------------------------------------------------------------------*/
+
+int Env_nproc_e( const Env* env );
+
+/*---------------------------------------------------------------------------*/
+
+int Env_nproc_a( const Env* env );
+
+/*---------------------------------------------------------------------------*/
+
 int Env_nproc( const Env* env );
 
 /*===========================================================================*/
@@ -89,7 +113,7 @@ void Env_increment_tag( Env* env, int value );
 /*===========================================================================*/
 /*---Proc number info---*/
 
-int Env_proc( const Env* env, int proc_x, int proc_y );
+int Env_proc( const Env* env, int proc_x, int proc_y, int proc_z );
 
 /*---------------------------------------------------------------------------*/
 
@@ -99,6 +123,10 @@ int Env_proc_x( const Env* env, int proc );
 
 int Env_proc_y( const Env* env, int proc );
 
+/*---------------------------------------------------------------------------*/
+
+int Env_proc_z( const Env* env, int proc );
+
 /*===========================================================================*/
 /*---Proc number info for this proc---*/
 
@@ -112,6 +140,18 @@ int Env_proc_x_this( const Env* env );
 
 int Env_proc_y_this( const Env* env );
 
+/*---------------------------------------------------------------------------*/
+
+int Env_proc_z_this( const Env* env );
+
+/*---------------------------------------------------------------------------*/
+
+int Env_proc_e_this( const Env* env );
+
+/*---------------------------------------------------------------------------*/
+
+int Env_proc_a_this( const Env* env );
+
 /*===========================================================================*/
 /*---MPI functions: global MPI operations---*/
 
@@ -123,10 +163,18 @@ double Env_sum_d( Env* env, double value );
 
 /*---------------------------------------------------------------------------*/
 
+int Env_max_i( Env* env, int value );
+
+/*---------------------------------------------------------------------------*/
+
 P Env_sum_P( Env* env, P value );
 
 /*---------------------------------------------------------------------------*/
 
+void Env_sum_angle_groups_P( Env* env, P* data, size_t n );
+
+/*---------------------------------------------------------------------------*/
+
 void Env_bcast_int( Env* env, int* data, int root );
 
 /*---------------------------------------------------------------------------*/
@@ -150,6 +198,11 @@ void Env_send_P( Env* env, const P* data, size_t n, int proc, int tag );
 
 void Env_recv_P( Env* env, P* data, size_t n, int proc, int tag );
 
+/*---------------------------------------------------------------------------*/
+
+void Env_sendrecv_replace_P( Env* env, P* data, size_t n,
+                             int proc_send, int proc_recv, int tag );
+
 /*===========================================================================*/
 /*---MPI functions: point-to-point communication: asynchronous---*/
 
@@ -165,6 +218,62 @@ void Env_arecv_P( Env* env, const P* data, size_t n, int proc, int tag,
 
 void Env_wait( Env* env, Request_t* request );
 
+/*---------------------------------------------------------------------------*/
+
+Bool_t Env_testall( Env* env, Request_t* requests, int n );
+
+/*---------------------------------------------------------------------------*/
+
+void Env_request_nullify( Env* env, Request_t* request );
+
+/*===========================================================================*/
+/*---MPI functions: point-to-point communication: persistent---*/
+
+void Env_asend_init_P( Env* env, const P* data, size_t n, int proc, int tag,
+                                                          Request_t* request );
+
+/*---------------------------------------------------------------------------*/
+
+void Env_arecv_init_P( Env* env, const P* data, size_t n, int proc, int tag,
+                                                          Request_t* request );
+
+/*---------------------------------------------------------------------------*/
+
+void Env_start( Env* env, Request_t* request );
+
+/*---------------------------------------------------------------------------*/
+
+void Env_request_free( Env* env, Request_t* request );
+
+/*===========================================================================*/
+/*---MPI functions: shared memory among the procs of a node---*/
+
+enum{ ENV_SHM_FLAG_STRIDE = 64 / sizeof(int) };
+
+/*---------------------------------------------------------------------------*/
+
+int Env_proc_node( const Env* env, int proc );
+
+/*---------------------------------------------------------------------------*/
+
+void* Env_shm_allocate( Env* env, size_t n, Win_t* win );
+
+/*---------------------------------------------------------------------------*/
+
+void* Env_shm_ptr( Env* env, Win_t* win, int proc );
+
+/*---------------------------------------------------------------------------*/
+
+void Env_shm_free( Env* env, Win_t* win );
+
+/*---------------------------------------------------------------------------*/
+
+void Env_shm_flag_set( int* flag, int value );
+
+/*---------------------------------------------------------------------------*/
+
+void Env_shm_flag_wait( Env* env, int* flag, int value );
+
 /*===========================================================================*/
 
 #ifdef __cplusplus
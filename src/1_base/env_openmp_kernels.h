@@ -15,6 +15,10 @@
 #include "omp.h"
 #endif
 
+#ifdef USE_OPENMP
+#include <sched.h>
+#endif
+
 #include "types_kernels.h"
 #include "env_assert_kernels.h"
 
@@ -44,6 +48,18 @@ TARGET_HD static inline int Env_omp_thread()
   return result;
 }
 
+/*===========================================================================*/
+/*---Get number of threads available for an openmp parallel region---*/
+
+TARGET_HD static inline int Env_omp_nthread_max()
+{
+  int result = 1;
+#ifdef USE_OPENMP
+  result = omp_get_max_threads();
+#endif
+  return result;
+}
+
 /*===========================================================================*/
 /*---Are we in an openmp threaded region---*/
 
@@ -56,6 +72,61 @@ TARGET_HD static inline Bool_t Env_omp_in_parallel()
   return result;
 }
 
+/*===========================================================================*/
+/*---Point-to-point synchronization between openmp threads via counters---*/
+
+/*---A thread announces progress by advancing its own counter; other
+     threads wait only for the counters they depend on.  Counters should
+     be padded apart to avoid false sharing.  Host code only.
+---*/
+
+enum{ ENV_OMP_COUNTER_STRIDE = 64 / sizeof(int) };
+
+enum{ ENV_OMP_NSPIN = 1000 };
+
+/*---------------------------------------------------------------------------*/
+
+static inline void Env_omp_counter_set( int* counter, int value )
+{
+#ifdef USE_OPENMP
+  __atomic_store_n( counter, value, __ATOMIC_RELEASE );
+#else
+  *counter = value;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static inline int Env_omp_counter_get( int* counter )
+{
+#ifdef USE_OPENMP
+  return __atomic_load_n( counter, __ATOMIC_ACQUIRE );
+#else
+  return *counter;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Wait until counter reaches value: spin, then yield the core---*/
+
+static inline void Env_omp_counter_wait( int* counter, int value )
+{
+  int ispin = 0;
+  while( Env_omp_counter_get( counter ) < value )
+  {
+    if( ispin < ENV_OMP_NSPIN )
+    {
+      ++ispin;
+    }
+    else
+    {
+#ifdef USE_OPENMP
+      sched_yield();
+#endif
+    }
+  }
+}
+
 /*===========================================================================*/
 
 #ifdef __cplusplus
@@ -0,0 +1,148 @@
+/*---------------------------------------------------------------------------*/
+/*!
+ * \file   env_simd_kernels.h
+ * \brief  Environment settings for CPU SIMD, code for comp. kernel.
+ * \note   Copyright (C) 2014 Oak Ridge National Laboratory, UT-Battelle, LLC.
+ */
+/*---------------------------------------------------------------------------*/
+
+#ifndef _env_simd_kernels_h_
+#define _env_simd_kernels_h_
+
+#include "types_kernels.h"
+#include "env_assert_kernels.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*===========================================================================*/
+/*---Selection of explicitly vectorized CPU kernels---*/
+
+/*---The SIMD kernels are used for host code on CPUs; the CUDA device code
+     and the MIC code keep their own kernels.  Define NO_SIMD to fall back
+     to the generic kernels.
+---*/
+
+#if ! defined(__CUDA_ARCH__) && ! defined(__MIC__) && ! defined(NO_SIMD)
+#define USE_SIMD
+#endif
+
+#ifdef USE_SIMD
+enum{ IS_USING_SIMD = Bool_true };
+#else
+enum{ IS_USING_SIMD = Bool_false };
+#endif
+
+/*---Vector width is chosen from the instruction set the compiler targets,
+     e.g., as given by -march.  Portable GCC/Clang vector extensions are
+     used; other compilers get the scalar fallback.
+---*/
+
+#if defined(USE_SIMD) && defined(__GNUC__) && ! defined(__CUDACC__) && \
+    ! defined(__INTEL_COMPILER)
+#if defined(__AVX512F__)
+#define SIMD_LEN_BYTES 64
+#elif defined(__AVX__)
+#define SIMD_LEN_BYTES 32
+#elif defined(__SSE2__) || defined(__ARM_NEON) || defined(__ALTIVEC__)
+#define SIMD_LEN_BYTES 16
+#endif
+#endif
+
+#ifdef SIMD_LEN_BYTES
+enum{ IS_USING_SIMD_VECTORS = Bool_true };
+enum{ SIMD_LEN = SIMD_LEN_BYTES / sizeof(P) };
+#else
+enum{ IS_USING_SIMD_VECTORS = Bool_false };
+enum{ SIMD_LEN = 1 };
+#endif
+
+/*===========================================================================*/
+/*---Vector type---*/
+
+#ifdef SIMD_LEN_BYTES
+typedef P VecP __attribute__(( vector_size( SIMD_LEN_BYTES ) ));
+#else
+typedef P VecP;
+#endif
+
+/*---NOTE: all operations on VecP are elementwise with no reassociation,
+     so each vector lane gives bitwise the same result as the
+     corresponding scalar code.
+---*/
+
+/*===========================================================================*/
+/*---Vector with all elements zero---*/
+
+static inline VecP VecP_zero()
+{
+  VecP result;
+#ifdef SIMD_LEN_BYTES
+  int i = 0;
+  for( i=0; i<SIMD_LEN; ++i )
+  {
+    result[i] = (P)0;
+  }
+#else
+  result = (P)0;
+#endif
+  return result;
+}
+
+/*===========================================================================*/
+/*---Vector with all elements set to a scalar---*/
+
+static inline VecP VecP_broadcast( const P value )
+{
+  VecP result;
+#ifdef SIMD_LEN_BYTES
+  int i = 0;
+  for( i=0; i<SIMD_LEN; ++i )
+  {
+    result[i] = value;
+  }
+#else
+  result = value;
+#endif
+  return result;
+}
+
+/*===========================================================================*/
+/*---Load vector from memory, no alignment required---*/
+
+static inline VecP VecP_load( const P* const __restrict__ p )
+{
+  VecP result;
+  Assert( p );
+#ifdef SIMD_LEN_BYTES
+  __builtin_memcpy( &result, p, sizeof(VecP) );
+#else
+  result = *p;
+#endif
+  return result;
+}
+
+/*===========================================================================*/
+/*---Store vector to memory, no alignment required---*/
+
+static inline void VecP_store( P* const __restrict__ p, const VecP value )
+{
+  Assert( p );
+#ifdef SIMD_LEN_BYTES
+  __builtin_memcpy( p, &value, sizeof(VecP) );
+#else
+  *p = value;
+#endif
+}
+
+/*===========================================================================*/
+
+#ifdef __cplusplus
+} /*---extern "C"---*/
+#endif
+
+#endif /*---_env_simd_kernels_h_---*/
+
+/*---------------------------------------------------------------------------*/
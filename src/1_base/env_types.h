@@ -37,9 +37,11 @@ extern "C"
 #ifdef USE_MPI
 typedef MPI_Comm    Comm_t;
 typedef MPI_Request Request_t;
+typedef MPI_Win     Win_t;
 #else
 typedef int Comm_t;
 typedef int Request_t;
+typedef void* Win_t;
 #endif
 
 #ifdef USE_CUDA
@@ -56,8 +58,14 @@ typedef struct
 #ifdef USE_MPI
   int    nproc_x_;    /*---Number of procs along x axis---*/
   int    nproc_y_;    /*---Number of procs along y axis---*/
+  int    nproc_z_;    /*---Number of procs along z axis---*/
+  int    nproc_e_;    /*---Number of energy slices---*/
+  int    nproc_a_;    /*---Number of angle groups---*/
   int    tag_;        /*---Next free message tag---*/
   Comm_t active_comm_;
+  Comm_t space_comm_; /*---Procs sharing this proc's slice and group---*/
+  Comm_t angle_comm_; /*---Procs holding the same subdomain and slice---*/
+  Comm_t node_comm_;  /*---Procs of space_comm_ sharing memory with this---*/
   Bool_t is_proc_active_;
 #endif
 #ifdef USE_CUDA
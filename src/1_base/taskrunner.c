@@ -0,0 +1,664 @@
+/*---------------------------------------------------------------------------*/
+/*!
+ * \file   taskrunner.c
+ * \brief  Pseudo-class for work-stealing execution of a task graph.
+ * \note   Copyright (C) 2014 Oak Ridge National Laboratory, UT-Battelle, LLC.
+ */
+/*---------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef USE_OPENMP_WORKSTEAL
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "types.h"
+#include "env.h"
+#include "taskrunner.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*===========================================================================*/
+/*---Atomic operations on ints---*/
+
+/*---Without the work-stealing build there is only one worker,
+     so plain memory operations suffice.
+---*/
+
+static int TaskRunner_load_acquire_( int* p )
+{
+#ifdef USE_OPENMP_WORKSTEAL
+  return __atomic_load_n( p, __ATOMIC_ACQUIRE );
+#else
+  return *p;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void TaskRunner_store_release_( int* p, int value )
+{
+#ifdef USE_OPENMP_WORKSTEAL
+  __atomic_store_n( p, value, __ATOMIC_RELEASE );
+#else
+  *p = value;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int TaskRunner_decrement_( int* p )
+{
+#ifdef USE_OPENMP_WORKSTEAL
+  return __atomic_sub_fetch( p, 1, __ATOMIC_ACQ_REL );
+#else
+  return --(*p);
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void TaskRunner_lock_( int* p )
+{
+#ifdef USE_OPENMP_WORKSTEAL
+  while( __atomic_exchange_n( p, 1, __ATOMIC_ACQUIRE ) )
+  {
+    while( __atomic_load_n( p, __ATOMIC_RELAXED ) )
+    {
+    }
+  }
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void TaskRunner_unlock_( int* p )
+{
+#ifdef USE_OPENMP_WORKSTEAL
+  __atomic_store_n( p, 0, __ATOMIC_RELEASE );
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void TaskRunner_yield_()
+{
+#ifdef USE_OPENMP_WORKSTEAL
+  sched_yield();
+#endif
+}
+
+/*===========================================================================*/
+/*---Null objects---*/
+
+TaskGraph TaskGraph_null()
+{
+  TaskGraph result;
+  memset( (void*)&result, 0, sizeof(TaskGraph) );
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
+TaskRunner TaskRunner_null()
+{
+  TaskRunner result;
+  memset( (void*)&result, 0, sizeof(TaskRunner) );
+  return result;
+}
+
+/*===========================================================================*/
+/*---Pseudo-constructor for TaskGraph: tasks with no edges---*/
+
+void TaskGraph_create( TaskGraph* graph,
+                       int        ntask )
+{
+  Assert( graph );
+  Insist( ntask >= 0 ? "Invalid task count." : 0 );
+
+  *graph = TaskGraph_null();
+
+  graph->ntask = ntask;
+  graph->nedge_capacity_ = ntask + 1;
+
+  graph->npred      = malloc_host_int( ntask );
+  graph->succ_start = malloc_host_int( ntask + 1 );
+  graph->edge_from_ = malloc_host_int( graph->nedge_capacity_ );
+  graph->edge_to_   = malloc_host_int( graph->nedge_capacity_ );
+}
+
+/*===========================================================================*/
+/*---Add dependency: task_to may not start until task_from completes---*/
+
+void TaskGraph_add_edge( TaskGraph* graph,
+                         int        task_from,
+                         int        task_to )
+{
+  Assert( graph );
+  Assert( graph->edge_from_ ? "Task graph already finalized" : 0 );
+  Assert( task_from >= 0 && task_from < graph->ntask );
+  Assert( task_to   >= 0 && task_to   < graph->ntask );
+  Assert( task_from != task_to );
+
+  if( graph->nedge == graph->nedge_capacity_ )
+  {
+    graph->nedge_capacity_ *= 2;
+    graph->edge_from_ = (int*)realloc( (void*)graph->edge_from_,
+                                   graph->nedge_capacity_ * sizeof(int) );
+    graph->edge_to_   = (int*)realloc( (void*)graph->edge_to_,
+                                   graph->nedge_capacity_ * sizeof(int) );
+    Insist( graph->edge_from_ && graph->edge_to_ ?
+            "Memory allocation failure" : 0 );
+  }
+
+  graph->edge_from_[ graph->nedge ] = task_from;
+  graph->edge_to_[   graph->nedge ] = task_to;
+  graph->nedge++;
+}
+
+/*===========================================================================*/
+/*---Build successor lists; no edges may be added afterwards---*/
+
+void TaskGraph_finalize( TaskGraph* graph )
+{
+  int task = 0;
+  int edge = 0;
+
+  Assert( graph );
+  Assert( graph->edge_from_ ? "Task graph already finalized" : 0 );
+
+  graph->succ = malloc_host_int( graph->nedge );
+
+  /*---Counting sort of edges by source task---*/
+
+  for( task=0; task<graph->ntask+1; ++task )
+  {
+    graph->succ_start[task] = 0;
+  }
+  for( task=0; task<graph->ntask; ++task )
+  {
+    graph->npred[task] = 0;
+  }
+  for( edge=0; edge<graph->nedge; ++edge )
+  {
+    graph->succ_start[ graph->edge_from_[edge] + 1 ]++;
+    graph->npred[ graph->edge_to_[edge] ]++;
+  }
+  for( task=0; task<graph->ntask; ++task )
+  {
+    graph->succ_start[task+1] += graph->succ_start[task];
+  }
+  for( edge=0; edge<graph->nedge; ++edge )
+  {
+    const int task_from = graph->edge_from_[edge];
+    /*---Use succ_start as an insertion cursor, shifted back below---*/
+    graph->succ[ graph->succ_start[ task_from ]++ ] = graph->edge_to_[edge];
+  }
+  for( task=graph->ntask; task>0; --task )
+  {
+    graph->succ_start[task] = graph->succ_start[task-1];
+  }
+  graph->succ_start[0] = 0;
+
+  free_host_int( graph->edge_from_ );
+  free_host_int( graph->edge_to_ );
+  graph->edge_from_ = NULL;
+  graph->edge_to_   = NULL;
+}
+
+/*===========================================================================*/
+/*---Pseudo-destructor for TaskGraph---*/
+
+void TaskGraph_destroy( TaskGraph* graph )
+{
+  Assert( graph );
+
+  if( graph->npred )
+  {
+    free_host_int( graph->npred );
+  }
+  if( graph->succ_start )
+  {
+    free_host_int( graph->succ_start );
+  }
+  if( graph->succ )
+  {
+    free_host_int( graph->succ );
+  }
+  if( graph->edge_from_ )
+  {
+    free_host_int( graph->edge_from_ );
+  }
+  if( graph->edge_to_ )
+  {
+    free_host_int( graph->edge_to_ );
+  }
+
+  *graph = TaskGraph_null();
+}
+
+/*===========================================================================*/
+/*---Internal state of worker team---*/
+
+/*---Each worker owns a deque of ready tasks.  The owner pushes and pops
+     at the bottom, so it proceeds depth-first along the tasks it has
+     just enabled; idle workers steal from the top.  Each deque has its
+     own lock, so contention is only between an owner and its thieves.
+---*/
+
+enum{ TASKRUNNER_PAD = 64 };
+
+typedef struct
+{
+  int* tasks;
+  int  top;
+  int  bottom;
+  int  lock;
+  char pad[TASKRUNNER_PAD];
+} TaskRunnerDeque;
+
+/*---------------------------------------------------------------------------*/
+
+typedef struct
+{
+  int               nworker;
+  TaskRunnerDeque*  deques;
+  int               deque_capacity;
+
+  /*---Current graph execution---*/
+  const TaskGraph*  graph;
+  TaskRunner_fn     fn;
+  void*             context;
+  int*              npred_remaining;
+  int               ntask_remaining;
+  int               nworker_done;
+
+  /*---Team control---*/
+  int               generation;
+  int               is_shutdown;
+#ifdef USE_OPENMP_WORKSTEAL
+  pthread_t*        threads;
+  pthread_t         thread_caller;
+  pthread_mutex_t   mutex;
+  pthread_cond_t    cond;
+#endif
+} TaskRunnerState;
+
+/*---------------------------------------------------------------------------*/
+
+typedef struct
+{
+  TaskRunnerState* state;
+  int              worker;
+} TaskRunnerWorkerArg;
+
+/*===========================================================================*/
+/*---Deque operations---*/
+
+static void TaskRunner_push_( TaskRunnerDeque* deque,
+                              int              task )
+{
+  TaskRunner_lock_( &deque->lock );
+  deque->tasks[ deque->bottom ] = task;
+  TaskRunner_store_release_( &deque->bottom, deque->bottom + 1 );
+  TaskRunner_unlock_( &deque->lock );
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int TaskRunner_pop_( TaskRunnerDeque* deque,
+                            Bool_t           is_owner )
+{
+  int task = -1;
+
+  /*---Quick unlocked check, confirmed below under the lock;
+       top and bottom are written atomically for this reason---*/
+  if( TaskRunner_load_acquire_( &deque->bottom ) <=
+      TaskRunner_load_acquire_( &deque->top ) )
+  {
+    return task;
+  }
+
+  TaskRunner_lock_( &deque->lock );
+  if( deque->bottom > deque->top )
+  {
+    if( is_owner )
+    {
+      task = deque->tasks[ deque->bottom - 1 ];
+      TaskRunner_store_release_( &deque->bottom, deque->bottom - 1 );
+    }
+    else
+    {
+      task = deque->tasks[ deque->top ];
+      TaskRunner_store_release_( &deque->top, deque->top + 1 );
+    }
+  }
+  TaskRunner_unlock_( &deque->lock );
+
+  return task;
+}
+
+/*===========================================================================*/
+/*---Work loop of one worker for one graph execution---*/
+
+static void TaskRunner_work_( TaskRunnerState* state,
+                              int              worker )
+{
+  const TaskGraph* const graph = state->graph;
+  TaskRunnerDeque* const deque = &state->deques[ worker ];
+
+  while( TaskRunner_load_acquire_( &state->ntask_remaining ) > 0 )
+  {
+    int task = TaskRunner_pop_( deque, Bool_true );
+    int i = 0;
+
+    /*---Steal if own deque empty---*/
+
+    for( i=1; i<state->nworker && task < 0; ++i )
+    {
+      task = TaskRunner_pop_( &state->deques[ ( worker + i ) %
+                                              state->nworker ], Bool_false );
+    }
+
+    if( task < 0 )
+    {
+      TaskRunner_yield_();
+      continue;
+    }
+
+    /*---Run task, then release successors---*/
+
+    state->fn( state->context, task );
+
+    for( i=graph->succ_start[task]; i<graph->succ_start[task+1]; ++i )
+    {
+      const int succ = graph->succ[i];
+      if( TaskRunner_decrement_( &state->npred_remaining[ succ ] ) == 0 )
+      {
+        TaskRunner_push_( deque, succ );
+      }
+    }
+
+    TaskRunner_decrement_( &state->ntask_remaining );
+  }
+}
+
+/*===========================================================================*/
+/*---Thread main function for workers other than worker 0---*/
+
+#ifdef USE_OPENMP_WORKSTEAL
+
+enum{ TASKRUNNER_NSPIN = 1000 };
+
+static void* TaskRunner_thread_main_( void* arg_ )
+{
+  TaskRunnerWorkerArg* arg = (TaskRunnerWorkerArg*)arg_;
+  TaskRunnerState* const state = arg->state;
+  const int worker = arg->worker;
+  int generation_seen = 0;
+
+  free( (void*)arg );
+
+  while( Bool_true )
+  {
+    int ispin = 0;
+
+    /*---Wait for next execution or shutdown: spin, then yield, then block---*/
+
+    while( TaskRunner_load_acquire_( &state->generation ) == generation_seen &&
+           ! TaskRunner_load_acquire_( &state->is_shutdown ) &&
+           ispin < TASKRUNNER_NSPIN )
+    {
+      TaskRunner_yield_();
+      ++ispin;
+    }
+
+    pthread_mutex_lock( &state->mutex );
+    while( state->generation == generation_seen && ! state->is_shutdown )
+    {
+      pthread_cond_wait( &state->cond, &state->mutex );
+    }
+    pthread_mutex_unlock( &state->mutex );
+
+    if( TaskRunner_load_acquire_( &state->is_shutdown ) )
+    {
+      break;
+    }
+
+    generation_seen = TaskRunner_load_acquire_( &state->generation );
+
+    TaskRunner_work_( state, worker );
+
+    TaskRunner_decrement_( &state->nworker_done );
+  }
+
+  return NULL;
+}
+
+#endif
+
+/*===========================================================================*/
+/*---Pseudo-constructor for TaskRunner: start the worker team---*/
+
+void TaskRunner_create( TaskRunner* runner,
+                        int         nworker )
+{
+  TaskRunnerState* state = NULL;
+
+  Assert( runner );
+  Insist( nworker > 0 ? "Invalid worker count." : 0 );
+  Insist( nworker == 1 || IS_USING_OPENMP_WORKSTEAL ?
+          "Multiple workers not allowed for this case." : 0 );
+
+  state = (TaskRunnerState*)malloc( sizeof(TaskRunnerState) );
+  Insist( state ? "Memory allocation failure" : 0 );
+  memset( (void*)state, 0, sizeof(TaskRunnerState) );
+
+  state->nworker = nworker;
+  state->deques = (TaskRunnerDeque*)malloc( nworker *
+                                            sizeof(TaskRunnerDeque) );
+  Insist( state->deques ? "Memory allocation failure" : 0 );
+  memset( (void*)state->deques, 0, nworker * sizeof(TaskRunnerDeque) );
+
+  runner->nworker = nworker;
+  runner->state_  = (void*)state;
+
+#ifdef USE_OPENMP_WORKSTEAL
+  int worker = 0;
+
+  state->thread_caller = pthread_self();
+
+  pthread_mutex_init( &state->mutex, NULL );
+  pthread_cond_init( &state->cond, NULL );
+
+  state->threads = (pthread_t*)malloc( nworker * sizeof(pthread_t) );
+  Insist( state->threads ? "Memory allocation failure" : 0 );
+
+  for( worker=1; worker<nworker; ++worker )
+  {
+    TaskRunnerWorkerArg* arg = (TaskRunnerWorkerArg*)
+                                       malloc( sizeof(TaskRunnerWorkerArg) );
+    int error = 0;
+    Insist( arg ? "Memory allocation failure" : 0 );
+    arg->state  = state;
+    arg->worker = worker;
+    error = pthread_create( &state->threads[worker], NULL,
+                            TaskRunner_thread_main_, (void*)arg );
+    Insist( error == 0 ? "Failure to create worker thread." : 0 );
+  }
+#endif
+}
+
+/*===========================================================================*/
+/*---Pseudo-destructor for TaskRunner: stop the worker team---*/
+
+void TaskRunner_destroy( TaskRunner* runner )
+{
+  TaskRunnerState* state = NULL;
+  int worker = 0;
+
+  Assert( runner );
+
+  state = (TaskRunnerState*)runner->state_;
+
+  if( ! state )
+  {
+    return;
+  }
+
+#ifdef USE_OPENMP_WORKSTEAL
+  pthread_mutex_lock( &state->mutex );
+  TaskRunner_store_release_( &state->is_shutdown, Bool_true );
+  pthread_cond_broadcast( &state->cond );
+  pthread_mutex_unlock( &state->mutex );
+
+  for( worker=1; worker<state->nworker; ++worker )
+  {
+    pthread_join( state->threads[worker], NULL );
+  }
+
+  free( (void*)state->threads );
+  pthread_cond_destroy( &state->cond );
+  pthread_mutex_destroy( &state->mutex );
+#endif
+
+  for( worker=0; worker<state->nworker; ++worker )
+  {
+    if( state->deques[worker].tasks )
+    {
+      free_host_int( state->deques[worker].tasks );
+    }
+  }
+  free( (void*)state->deques );
+  if( state->npred_remaining )
+  {
+    free_host_int( state->npred_remaining );
+  }
+  free( (void*)state );
+
+  *runner = TaskRunner_null();
+}
+
+/*===========================================================================*/
+/*---Execute all tasks of a graph, returning when all are complete---*/
+
+void TaskRunner_execute( TaskRunner*      runner,
+                         const TaskGraph* graph,
+                         TaskRunner_fn    fn,
+                         void*            context )
+{
+  TaskRunnerState* state = NULL;
+  int worker = 0;
+  int task = 0;
+  int nready = 0;
+
+  Assert( runner );
+  Assert( graph );
+  Assert( fn );
+  Assert( ! graph->edge_from_ ? "Task graph not finalized" : 0 );
+
+  state = (TaskRunnerState*)runner->state_;
+  Assert( state );
+
+  /*---Size work arrays; other workers are idle here---*/
+
+  if( state->deque_capacity < graph->ntask )
+  {
+    for( worker=0; worker<state->nworker; ++worker )
+    {
+      if( state->deques[worker].tasks )
+      {
+        free_host_int( state->deques[worker].tasks );
+      }
+      state->deques[worker].tasks = malloc_host_int( graph->ntask );
+    }
+    if( state->npred_remaining )
+    {
+      free_host_int( state->npred_remaining );
+    }
+    state->npred_remaining = malloc_host_int( graph->ntask );
+    state->deque_capacity = graph->ntask;
+  }
+
+  /*---Set up this execution---*/
+
+  state->graph   = graph;
+  state->fn      = fn;
+  state->context = context;
+  state->ntask_remaining = graph->ntask;
+  state->nworker_done    = state->nworker - 1;
+
+  for( worker=0; worker<state->nworker; ++worker )
+  {
+    state->deques[worker].top    = 0;
+    state->deques[worker].bottom = 0;
+  }
+
+  /*---Deal out initially ready tasks round robin---*/
+
+  for( task=0; task<graph->ntask; ++task )
+  {
+    state->npred_remaining[task] = graph->npred[task];
+    if( graph->npred[task] == 0 )
+    {
+      TaskRunnerDeque* deque = &state->deques[ nready % state->nworker ];
+      deque->tasks[ deque->bottom++ ] = task;
+      ++nready;
+    }
+  }
+  Insist( nready > 0 || graph->ntask == 0 ? "Task graph has a cycle." : 0 );
+
+  /*---Release the team; the calling thread is worker 0---*/
+
+#ifdef USE_OPENMP_WORKSTEAL
+  state->thread_caller = pthread_self();
+
+  pthread_mutex_lock( &state->mutex );
+  TaskRunner_store_release_( &state->generation, state->generation + 1 );
+  pthread_cond_broadcast( &state->cond );
+  pthread_mutex_unlock( &state->mutex );
+#endif
+
+  TaskRunner_work_( state, 0 );
+
+  /*---Wait for all workers to leave the work loop before next reuse---*/
+
+  while( TaskRunner_load_acquire_( &state->nworker_done ) > 0 )
+  {
+    TaskRunner_yield_();
+  }
+
+  state->graph   = NULL;
+  state->fn      = NULL;
+  state->context = NULL;
+}
+
+/*===========================================================================*/
+/*---Determine whether this thread is the one that executes the graph---*/
+
+Bool_t TaskRunner_is_calling_thread( const TaskRunner* runner )
+{
+  Bool_t result = Bool_true;
+#ifdef USE_OPENMP_WORKSTEAL
+  const TaskRunnerState* state = (const TaskRunnerState*)runner->state_;
+
+  Assert( state );
+
+  result = pthread_equal( pthread_self(), state->thread_caller ) ?
+           Bool_true : Bool_false;
+#endif
+  return result;
+}
+
+/*===========================================================================*/
+
+#ifdef __cplusplus
+} /*---extern "C"---*/
+#endif
+
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1 @@
+taskrunner.c
\ No newline at end of file
@@ -0,0 +1,132 @@
+/*---------------------------------------------------------------------------*/
+/*!
+ * \file   taskrunner.h
+ * \brief  Pseudo-class for work-stealing execution of a task graph, header.
+ * \note   Copyright (C) 2014 Oak Ridge National Laboratory, UT-Battelle, LLC.
+ */
+/*---------------------------------------------------------------------------*/
+
+#ifndef _taskrunner_h_
+#define _taskrunner_h_
+
+#include "types.h"
+#include "env.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*===========================================================================*/
+/*---Enums---*/
+
+#ifdef USE_OPENMP_WORKSTEAL
+enum{ IS_USING_OPENMP_WORKSTEAL = Bool_true };
+#else
+enum{ IS_USING_OPENMP_WORKSTEAL = Bool_false };
+#endif
+
+/*===========================================================================*/
+/*---Struct for a static task dependency graph---*/
+
+/*---A task may run once all its predecessors have completed.
+     Successors are stored in compressed row form.
+---*/
+
+typedef struct
+{
+  int  ntask;
+  int  nedge;
+  int  nedge_capacity_;
+  int* npred;        /*---[ntask]---*/
+  int* succ_start;   /*---[ntask+1]---*/
+  int* succ;         /*---[nedge]---*/
+  int* edge_from_;   /*---[nedge], only until finalized---*/
+  int* edge_to_;     /*---[nedge], only until finalized---*/
+} TaskGraph;
+
+/*===========================================================================*/
+/*---Struct for persistent worker team---*/
+
+typedef struct
+{
+  int   nworker;
+  void* state_;
+} TaskRunner;
+
+/*===========================================================================*/
+/*---Function executed for each task---*/
+
+typedef void (*TaskRunner_fn)( void* context, int task );
+
+/*===========================================================================*/
+/*---Null objects---*/
+
+TaskGraph TaskGraph_null(void);
+
+TaskRunner TaskRunner_null(void);
+
+/*===========================================================================*/
+/*---Pseudo-constructor for TaskGraph: tasks with no edges---*/
+
+void TaskGraph_create( TaskGraph* graph,
+                       int        ntask );
+
+/*===========================================================================*/
+/*---Add dependency: task_to may not start until task_from completes---*/
+
+void TaskGraph_add_edge( TaskGraph* graph,
+                         int        task_from,
+                         int        task_to );
+
+/*===========================================================================*/
+/*---Build successor lists; no edges may be added afterwards---*/
+
+void TaskGraph_finalize( TaskGraph* graph );
+
+/*===========================================================================*/
+/*---Pseudo-destructor for TaskGraph---*/
+
+void TaskGraph_destroy( TaskGraph* graph );
+
+/*===========================================================================*/
+/*---Pseudo-constructor for TaskRunner: start the worker team---*/
+
+/*---The calling thread acts as worker 0 in TaskRunner_execute;
+     nworker-1 further threads are started here and persist,
+     idling between calls, until TaskRunner_destroy.
+---*/
+
+void TaskRunner_create( TaskRunner* runner,
+                        int         nworker );
+
+/*===========================================================================*/
+/*---Pseudo-destructor for TaskRunner: stop the worker team---*/
+
+void TaskRunner_destroy( TaskRunner* runner );
+
+/*===========================================================================*/
+/*---Execute all tasks of a graph, returning when all are complete---*/
+
+void TaskRunner_execute( TaskRunner*      runner,
+                         const TaskGraph* graph,
+                         TaskRunner_fn    fn,
+                         void*            context );
+
+/*===========================================================================*/
+/*---Determine whether this thread is the one that executes the graph---*/
+
+/*---That is, worker 0: the thread that called TaskRunner_execute last, or
+     else the one that created the runner---*/
+
+Bool_t TaskRunner_is_calling_thread( const TaskRunner* runner );
+
+/*===========================================================================*/
+
+#ifdef __cplusplus
+} /*---extern "C"---*/
+#endif
+
+#endif /*---_taskrunner_h_---*/
+
+/*---------------------------------------------------------------------------*/
@@ -20,6 +20,18 @@ extern "C"
 {
 #endif
 
+/*===========================================================================*/
+/*---Work decomposition for the threaded loops---*/
+
+/*---Flat loops are cut into chunks of fixed size, independent of the
+     number of threads, so that reductions are reproducible.  Partial sums
+     within a chunk are kept in several lanes to allow vectorization.
+---*/
+
+enum{ ARRAY_OPERATIONS_NELT_PER_CHUNK = 4096 };
+
+enum{ ARRAY_OPERATIONS_NLANE = 8 };
+
 /*===========================================================================*/
 /*---Initialize state vector to required input value---*/
 
@@ -28,22 +40,146 @@ void initialize_state( P* const __restrict__   v,
                        const int               nu,
                        const Quantities* const quan )
 {
-  int ix = 0;
-  int iy = 0;
-  int iz = 0;
-  int ie = 0;
-  int im = 0;
-  int iu = 0;
-
-  for( iz=0; iz<dims.ncell_z; ++iz )
-  for( iy=0; iy<dims.ncell_y; ++iy )
-  for( ix=0; ix<dims.ncell_x; ++ix )
-  for( ie=0; ie<dims.ne; ++ie )
-  for( im=0; im<dims.nm; ++im )
-  for( iu=0; iu<nu; ++iu )
+  initialize_state_rhs( v, dims, nu, quan, 0, 1 );
+}
+
+/*===========================================================================*/
+/*---Initialize state vector of one right hand side to its input value---*/
+
+/*---Energy group ie of right hand side irhs is group irhs + nrhs * ie of
+     the problem swept, which has nrhs times as many groups---*/
+
+void initialize_state_rhs( P* const __restrict__   v,
+                           const Dimensions        dims,
+                           const int               nu,
+                           const Quantities* const quan,
+                           const int               irhs,
+                           const int               nrhs )
+{
+  Assert( irhs >= 0 && irhs < nrhs );
+
+  Dimensions dims_sweep = dims;
+  dims_sweep.ne = dims.ne * nrhs;
+
+  /*---Walk the vector in memory order; one row per (iz, ie, iy)---*/
+
+  const int nrow = dims.ncell_z * dims.ne * dims.ncell_y;
+  const size_t nelt_per_row = dims.ncell_x * (size_t)nu * dims.nm;
+  int irow = 0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for( irow=0; irow<nrow; ++irow )
+  {
+    const int iy = irow % dims.ncell_y;
+    const int ie = ( irow / dims.ncell_y ) % dims.ne;
+    const int iz = irow / ( dims.ncell_y * dims.ne );
+    P* const __restrict__ v_row = ref_state( v, dims, nu, 0, iy, iz, ie, 0, 0 );
+    size_t i = 0;
+    int ix = 0;
+    int iu = 0;
+    int im = 0;
+
+    for( ix=0; ix<dims.ncell_x; ++ix )
+    for( iu=0; iu<nu; ++iu )
+    for( im=0; im<dims.nm; ++im )
+    {
+      v_row[i++] = Quantities_init_state( quan, ix, iy, iz,
+                                          irhs + nrhs * ie, im, iu,
+                                          dims_sweep );
+    }
+    Assert( i == nelt_per_row );
+  }
+}
+
+/*===========================================================================*/
+/*---Pack the state vectors of several right hand sides into one---*/
+
+/*---The right hand sides are interleaved along the energy axis of v, as
+     the faster varying index: group ie of right hand side irhs is group
+     irhs + nrhs * ie of v.  dims are those of a single right hand side---*/
+
+void pack_state_rhs(       P* const __restrict__        v,
+                     const P* const* const __restrict__ v_rhs,
+                     const Dimensions                   dims,
+                     const int                          nu,
+                     const int                          nrhs )
+{
+  Dimensions dims_sweep = dims;
+  dims_sweep.ne = dims.ne * nrhs;
+
+  /*---One row per (iz, ie, iy) of each right hand side---*/
+
+  const int nrow = dims.ncell_z * dims.ne * dims.ncell_y;
+  const size_t nelt_per_row = dims.ncell_x * (size_t)nu * dims.nm;
+  int irow = 0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for( irow=0; irow<nrow; ++irow )
+  {
+    const int iy = irow % dims.ncell_y;
+    const int ie = ( irow / dims.ncell_y ) % dims.ne;
+    const int iz = irow / ( dims.ncell_y * dims.ne );
+    int irhs = 0;
+
+    for( irhs=0; irhs<nrhs; ++irhs )
+    {
+      P* const __restrict__ v_row = ref_state( v, dims_sweep, nu,
+                                        0, iy, iz, irhs + nrhs * ie, 0, 0 );
+      const P* const __restrict__ v_rhs_row = const_ref_state( v_rhs[irhs],
+                                        dims, nu, 0, iy, iz, ie, 0, 0 );
+      size_t i = 0;
+
+      for( i=0; i<nelt_per_row; ++i )
+      {
+        v_row[i] = v_rhs_row[i];
+      }
+    }
+  }
+}
+
+/*===========================================================================*/
+/*---Unpack the state vectors of several right hand sides from one---*/
+
+void unpack_state_rhs( P* const* const __restrict__ v_rhs,
+                       const P* const __restrict__  v,
+                       const Dimensions             dims,
+                       const int                    nu,
+                       const int                    nrhs )
+{
+  Dimensions dims_sweep = dims;
+  dims_sweep.ne = dims.ne * nrhs;
+
+  const int nrow = dims.ncell_z * dims.ne * dims.ncell_y;
+  const size_t nelt_per_row = dims.ncell_x * (size_t)nu * dims.nm;
+  int irow = 0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for( irow=0; irow<nrow; ++irow )
   {
-    *ref_state( v, dims, nu, ix, iy, iz, ie, im, iu )
-                = Quantities_init_state( quan, ix, iy, iz, ie, im, iu, dims );
+    const int iy = irow % dims.ncell_y;
+    const int ie = ( irow / dims.ncell_y ) % dims.ne;
+    const int iz = irow / ( dims.ncell_y * dims.ne );
+    int irhs = 0;
+
+    for( irhs=0; irhs<nrhs; ++irhs )
+    {
+      const P* const __restrict__ v_row = const_ref_state( v, dims_sweep, nu,
+                                        0, iy, iz, irhs + nrhs * ie, 0, 0 );
+      P* const __restrict__ v_rhs_row = ref_state( v_rhs[irhs],
+                                        dims, nu, 0, iy, iz, ie, 0, 0 );
+      size_t i = 0;
+
+      for( i=0; i<nelt_per_row; ++i )
+      {
+        v_rhs_row[i] = v_row[i];
+      }
+    }
   }
 }
 
@@ -54,13 +190,46 @@ void initialize_state_zero( P* const __restrict__ v,
                             const Dimensions      dims,
                             const int             nu )
 {
+  const size_t n = Dimensions_size_state( dims, nu );
+  const size_t nchunk = ( n + ARRAY_OPERATIONS_NELT_PER_CHUNK - 1 ) /
+                                             ARRAY_OPERATIONS_NELT_PER_CHUNK;
+  long int ichunk = 0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for( ichunk=0; ichunk<(long int)nchunk; ++ichunk )
+  {
+    const size_t imin = ichunk * (size_t)ARRAY_OPERATIONS_NELT_PER_CHUNK;
+    const size_t imax = imin + ARRAY_OPERATIONS_NELT_PER_CHUNK < n ?
+                        imin + ARRAY_OPERATIONS_NELT_PER_CHUNK : n;
+    size_t i = 0;
+
+    for( i=imin; i<imax; ++i )
+    {
+      v[i] = P_zero();
+    }
+  }
+}
+
+/*===========================================================================*/
+/*---Sum an array in place by a pairwise tree in a fixed order---*/
+
+static P sum_pairwise_( P* const __restrict__ s,
+                        const size_t          n )
+{
+  size_t stride = 0;
   size_t i = 0;
-  size_t n = Dimensions_size_state( dims, nu );
 
-  for( i=0; i<n; ++i )
+  for( stride=1; stride<n; stride*=2 )
   {
-    v[i] = P_zero();
+    for( i=0; i+stride<n; i+=2*stride )
+    {
+      s[i] += s[i+stride];
+    }
   }
+
+  return n > 0 ? s[0] : P_zero();
 }
 
 /*===========================================================================*/
@@ -77,31 +246,80 @@ void get_state_norms( const P* const __restrict__ vi,
   Assert( normsqp     != NULL ? "Null pointer encountered" : 0 );
   Assert( normsqdiffp != NULL ? "Null pointer encountered" : 0 );
 
-  int ix = 0;
-  int iy = 0;
-  int iz = 0;
-  int ie = 0;
-  int im = 0;
-  int iu = 0;
-
-  P normsq     = P_zero();
-  P normsqdiff = P_zero();
-
-  for( iz=0; iz<dims.ncell_z; ++iz )
-  for( iy=0; iy<dims.ncell_y; ++iy )
-  for( ix=0; ix<dims.ncell_x; ++ix )
-  for( ie=0; ie<dims.ne; ++ie )
-  for( im=0; im<dims.nm; ++im )
-  for( iu=0; iu<nu; ++iu )
+  /*---The vectors are summed by chunks, then the chunk sums are
+       combined in a fixed order, so the result is independent of the
+       number of threads---*/
+
+  const size_t n = Dimensions_size_state( dims, nu );
+  const size_t nchunk = ( n + ARRAY_OPERATIONS_NELT_PER_CHUNK - 1 ) /
+                                             ARRAY_OPERATIONS_NELT_PER_CHUNK;
+
+  P* const __restrict__ normsq_chunk     = malloc_host_P( nchunk + 1 );
+  P* const __restrict__ normsqdiff_chunk = malloc_host_P( nchunk + 1 );
+  long int ichunk = 0;
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for( ichunk=0; ichunk<(long int)nchunk; ++ichunk )
   {
-    const P val_vi = *const_ref_state( vi, dims, nu, ix, iy, iz, ie, im, iu );
-    const P val_vo = *const_ref_state( vo, dims, nu, ix, iy, iz, ie, im, iu );
-    const P diff   = val_vi - val_vo;
-    normsq        += val_vo * val_vo;
-    normsqdiff    += diff   * diff;
+    const size_t imin = ichunk * (size_t)ARRAY_OPERATIONS_NELT_PER_CHUNK;
+    const size_t imax = imin + ARRAY_OPERATIONS_NELT_PER_CHUNK < n ?
+                        imin + ARRAY_OPERATIONS_NELT_PER_CHUNK : n;
+    P normsq_lane[ARRAY_OPERATIONS_NLANE];
+    P normsqdiff_lane[ARRAY_OPERATIONS_NLANE];
+    size_t i = 0;
+    int ilane = 0;
+
+    for( ilane=0; ilane<ARRAY_OPERATIONS_NLANE; ++ilane )
+    {
+      normsq_lane[ilane]     = P_zero();
+      normsqdiff_lane[ilane] = P_zero();
+    }
+
+    for( i=imin; i+ARRAY_OPERATIONS_NLANE<=imax; i+=ARRAY_OPERATIONS_NLANE )
+    {
+      for( ilane=0; ilane<ARRAY_OPERATIONS_NLANE; ++ilane )
+      {
+        const P val_vi = vi[i+ilane];
+        const P val_vo = vo[i+ilane];
+        const P diff   = val_vi - val_vo;
+        normsq_lane[ilane]     += val_vo * val_vo;
+        normsqdiff_lane[ilane] += diff   * diff;
+      }
+    }
+    for( ilane=0; i<imax; ++i, ++ilane )
+    {
+      const P val_vi = vi[i];
+      const P val_vo = vo[i];
+      const P diff   = val_vi - val_vo;
+      normsq_lane[ilane]     += val_vo * val_vo;
+      normsqdiff_lane[ilane] += diff   * diff;
+    }
+
+    normsq_chunk[ichunk]     = sum_pairwise_( normsq_lane,
+                                              ARRAY_OPERATIONS_NLANE );
+    normsqdiff_chunk[ichunk] = sum_pairwise_( normsqdiff_lane,
+                                              ARRAY_OPERATIONS_NLANE );
   }
+
+  P normsq     = sum_pairwise_( normsq_chunk, nchunk );
+  P normsqdiff = sum_pairwise_( normsqdiff_chunk, nchunk );
+
+  free_host_P( normsq_chunk );
+  free_host_P( normsqdiff_chunk );
+
   Assert( normsq     >= P_zero() );
   Assert( normsqdiff >= P_zero() );
+
+  /*---The angle groups hold copies of the same result; count one---*/
+
+  if( Env_proc_a_this( env ) != 0 )
+  {
+    normsq     = P_zero();
+    normsqdiff = P_zero();
+  }
+
   normsq     = Env_sum_P( env, normsq );
   normsqdiff = Env_sum_P( env, normsqdiff );
 
@@ -117,11 +335,24 @@ void copy_vector(       P* const __restrict__ vo,
                   const size_t                n )
 {
   Assert( n+1 >= 1 );
-  size_t i = 0;
+  const size_t nchunk = ( n + ARRAY_OPERATIONS_NELT_PER_CHUNK - 1 ) /
+                                             ARRAY_OPERATIONS_NELT_PER_CHUNK;
+  long int ichunk = 0;
 
-  for( i=0; i<n; ++i )
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if( nchunk > 1 )
+#endif
+  for( ichunk=0; ichunk<(long int)nchunk; ++ichunk )
   {
-    vo[i] = vi[i];
+    const size_t imin = ichunk * (size_t)ARRAY_OPERATIONS_NELT_PER_CHUNK;
+    const size_t imax = imin + ARRAY_OPERATIONS_NELT_PER_CHUNK < n ?
+                        imin + ARRAY_OPERATIONS_NELT_PER_CHUNK : n;
+    size_t i = 0;
+
+    for( i=imin; i<imax; ++i )
+    {
+      vo[i] = vi[i];
+    }
   }
 }
 
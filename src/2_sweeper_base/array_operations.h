@@ -29,6 +29,16 @@ void initialize_state( P* const __restrict__   v,
                        const int               nu,
                        const Quantities* const quan );
 
+/*===========================================================================*/
+/*---Initialize state vector of one right hand side to its input value---*/
+
+void initialize_state_rhs( P* const __restrict__   v,
+                           const Dimensions        dims,
+                           const int               nu,
+                           const Quantities* const quan,
+                           const int               irhs,
+                           const int               nrhs );
+
 /*===========================================================================*/
 /*---Initialize state vector to zero---*/
 
@@ -47,6 +57,23 @@ void get_state_norms( const P* const __restrict__ vi,
                       P* const __restrict__       normsqdiffp,
                       Env* const                  env );
 
+/*===========================================================================*/
+/*---Pack/unpack the state vectors of several right hand sides---*/
+
+void pack_state_rhs(       P* const __restrict__        v,
+                     const P* const* const __restrict__ v_rhs,
+                     const Dimensions                   dims,
+                     const int                          nu,
+                     const int                          nrhs );
+
+/*---------------------------------------------------------------------------*/
+
+void unpack_state_rhs( P* const* const __restrict__ v_rhs,
+                       const P* const __restrict__  v,
+                       const Dimensions             dims,
+                       const int                    nu,
+                       const int                    nrhs );
+
 /*===========================================================================*/
 /*---Copy vector---*/
 
@@ -17,19 +17,712 @@ extern "C"
 {
 #endif
 
+/*===========================================================================*/
+/*---Size of the face for one octant, for communication along an axis---*/
+/*---pseudo-private member function---*/
+
+static size_t Faces_size_face_per_octant_( Faces*      faces,
+                                           Dimensions  dims_b,
+                                           int         axis )
+{
+  return axis == 0 ?
+    Dimensions_size_faceyz( dims_b, NU, faces->noctant_per_block ) /
+                                                  faces->noctant_per_block :
+         axis == 1 ?
+    Dimensions_size_facexz( dims_b, NU, faces->noctant_per_block ) /
+                                                  faces->noctant_per_block :
+    Dimensions_size_facexy( dims_b, NU, faces->noctant_per_block ) /
+                                                  faces->noctant_per_block;
+}
+
+/*===========================================================================*/
+/*---Host face values for one octant of a face buffer---*/
+/*---pseudo-private member function---*/
+
+/*---The xy face has a single buffer, so ibuf is ignored for it---*/
+
+static P* Faces_face_per_octant_( Faces*      faces,
+                                  Dimensions  dims_b,
+                                  int         ibuf,
+                                  int         axis,
+                                  int         octant_in_block )
+{
+  return axis == 0 ?
+    ref_faceyz( Pointer_h( Faces_faceyz( faces, ibuf ) ),
+                dims_b, NU, faces->noctant_per_block,
+                0, 0, 0, 0, 0, octant_in_block ) :
+         axis == 1 ?
+    ref_facexz( Pointer_h( Faces_facexz( faces, ibuf ) ),
+                dims_b, NU, faces->noctant_per_block,
+                0, 0, 0, 0, 0, octant_in_block ) :
+    ref_facexy( Pointer_h( Faces_facexy( faces, 0 ) ),
+                dims_b, NU, faces->noctant_per_block,
+                0, 0, 0, 0, 0, octant_in_block );
+}
+
+/*===========================================================================*/
+/*---Size of the part of an octant face holding an energy chunk---*/
+/*---pseudo-private member function---*/
+
+static size_t Faces_size_face_per_octant_chunk_( Faces*      faces,
+                                                 Dimensions  dims_b,
+                                                 int         axis,
+                                                 int         ichunk )
+{
+  /*---Energy is the slowest axis of the face for an octant---*/
+
+  return ( Faces_size_face_per_octant_( faces, dims_b, axis ) / dims_b.ne ) *
+         ( Faces_iemin_chunk( faces, dims_b.ne, ichunk+1 ) -
+           Faces_iemin_chunk( faces, dims_b.ne, ichunk ) );
+}
+
+/*===========================================================================*/
+/*---Host face values for one energy chunk of one octant---*/
+/*---pseudo-private member function---*/
+
+static P* Faces_face_per_octant_chunk_( Faces*      faces,
+                                        Dimensions  dims_b,
+                                        int         ibuf,
+                                        int         axis,
+                                        int         octant_in_block,
+                                        int         ichunk )
+{
+  return Faces_face_per_octant_( faces, dims_b, ibuf, axis, octant_in_block )
+       + ( Faces_size_face_per_octant_( faces, dims_b, axis ) / dims_b.ne ) *
+         Faces_iemin_chunk( faces, dims_b.ne, ichunk );
+}
+
+/*===========================================================================*/
+/*---Size of a work unit of an octant face, when stored contiguously---*/
+/*---pseudo-private member function---*/
+
+static size_t Faces_size_face_per_octant_unit_( Faces*      faces,
+                                                Dimensions  dims_b,
+                                                int         axis,
+                                                int         iunit )
+{
+  const int ichunk     = Faces_ichunk_unit( faces, iunit );
+  const int iangle_set = Faces_iangle_set_unit( faces, iunit );
+
+  /*---Angle is the fastest axis of the face---*/
+
+  return ( Faces_size_face_per_octant_chunk_( faces, dims_b, axis, ichunk ) /
+                                                                 dims_b.na ) *
+         ( Faces_iamin_set( faces, dims_b.na, iangle_set+1 ) -
+           Faces_iamin_set( faces, dims_b.na, iangle_set ) );
+}
+
+/*===========================================================================*/
+/*---Offset of a work unit in an array holding one octant face per unit---*/
+/*---pseudo-private member function---*/
+
+/*---The units of an energy chunk are stored one after the other in the
+     part of the array holding the chunk, so with one angle set this is
+     the layout of the face itself.
+---*/
+
+static size_t Faces_offset_unit_( Faces*      faces,
+                                  Dimensions  dims_b,
+                                  int         axis,
+                                  int         iunit )
+{
+  const int ichunk     = Faces_ichunk_unit( faces, iunit );
+  const int iangle_set = Faces_iangle_set_unit( faces, iunit );
+
+  return ( Faces_size_face_per_octant_( faces, dims_b, axis ) / dims_b.ne ) *
+         Faces_iemin_chunk( faces, dims_b.ne, ichunk ) +
+         ( Faces_size_face_per_octant_chunk_( faces, dims_b, axis, ichunk ) /
+                                                                 dims_b.na ) *
+         Faces_iamin_set( faces, dims_b.na, iangle_set );
+}
+
+/*===========================================================================*/
+/*---Copy a work unit between an octant face and contiguous storage---*/
+/*---pseudo-private member function---*/
+
+/*---An angle set is a strided part of each energy chunk, since angle is
+     the fastest axis of the face; it is gathered into, or scattered from,
+     the unit's place in an array of contiguous units.
+---*/
+
+static void Faces_copy_unit_( Faces*      faces,
+                              Dimensions  dims_b,
+                              P*          face_per_octant,
+                              P*          face_per_octant_units,
+                              int         axis,
+                              int         iunit,
+                              Bool_t      is_pack )
+{
+  const int ichunk     = Faces_ichunk_unit( faces, iunit );
+  const int iangle_set = Faces_iangle_set_unit( faces, iunit );
+
+  const int na     = dims_b.na;
+  const int iamin  = Faces_iamin_set( faces, na, iangle_set );
+  const int na_set = Faces_iamin_set( faces, na, iangle_set+1 ) - iamin;
+
+  const size_t nrun = Faces_size_face_per_octant_chunk_( faces, dims_b, axis,
+                                                         ichunk ) / na;
+
+  P* const face = face_per_octant + iamin +
+                  ( Faces_size_face_per_octant_( faces, dims_b, axis ) /
+                                                                 dims_b.ne ) *
+                  Faces_iemin_chunk( faces, dims_b.ne, ichunk );
+  P* const unit = face_per_octant_units +
+                  Faces_offset_unit_( faces, dims_b, axis, iunit );
+
+  size_t irun = 0;
+  int ia = 0;
+
+  if( na_set == na )
+  {
+    if( is_pack )
+    {
+      copy_vector( unit, face, nrun * na );
+    }
+    else
+    {
+      copy_vector( face, unit, nrun * na );
+    }
+    return;
+  }
+
+  for( irun=0; irun<nrun; ++irun )
+  {
+    for( ia=0; ia<na_set; ++ia )
+    {
+      if( is_pack )
+      {
+        unit[ ia + na_set * irun ] = face[ ia + na * irun ];
+      }
+      else
+      {
+        face[ ia + na * irun ] = unit[ ia + na_set * irun ];
+      }
+    }
+  }
+}
+
+/*===========================================================================*/
+/*---Staging buffer for one octant of a face buffer---*/
+/*---pseudo-private member function---*/
+
+static P* Faces_buf_unit_per_octant_( Faces*      faces,
+                                      Dimensions  dims_b,
+                                      int         ibuf,
+                                      int         axis,
+                                      int         octant_in_block )
+{
+  Assert( faces->buf_unit[axis] != NULL );
+
+  return faces->buf_unit[axis] +
+         Faces_size_face_per_octant_( faces, dims_b, axis ) *
+         ( octant_in_block + faces->noctant_per_block *
+                             ( axis == 2 ? 0 : ibuf ) );
+}
+
+/*===========================================================================*/
+/*---Host storage holding the work units of an octant contiguously---*/
+/*---pseudo-private member function---*/
+
+static P* Faces_units_per_octant_( Faces*      faces,
+                                   Dimensions  dims_b,
+                                   int         ibuf,
+                                   int         axis,
+                                   int         octant_in_block )
+{
+  return faces->nangle_set == 1 ?
+    Faces_face_per_octant_( faces, dims_b, ibuf, axis, octant_in_block ) :
+    Faces_buf_unit_per_octant_( faces, dims_b, ibuf, axis, octant_in_block );
+}
+
+/*===========================================================================*/
+/*---Host storage from which a work unit is communicated---*/
+/*---pseudo-private member function---*/
+
+/*---With one angle set every unit is contiguous in the face and is
+     communicated in place; otherwise it goes through the staging buffer.
+---*/
+
+static P* Faces_data_unit_( Faces*      faces,
+                            Dimensions  dims_b,
+                            int         ibuf,
+                            int         axis,
+                            int         octant_in_block,
+                            int         iunit )
+{
+  return Faces_units_per_octant_( faces, dims_b, ibuf, axis, octant_in_block )
+       + Faces_offset_unit_( faces, dims_b, axis, iunit );
+}
+
+/*===========================================================================*/
+/*---Pack a unit into, or unpack it from, its staging buffer if needed---*/
+/*---pseudo-private member function---*/
+
+static void Faces_stage_unit_( Faces*      faces,
+                               Dimensions  dims_b,
+                               int         ibuf,
+                               int         axis,
+                               int         octant_in_block,
+                               int         iunit,
+                               Bool_t      is_pack )
+{
+  if( faces->nangle_set == 1 )
+  {
+    return;
+  }
+
+  Faces_copy_unit_( faces, dims_b,
+    Faces_face_per_octant_( faces, dims_b, ibuf, axis, octant_in_block ),
+    Faces_buf_unit_per_octant_( faces, dims_b, ibuf, axis, octant_in_block ),
+    axis, iunit, is_pack );
+}
+
+/*===========================================================================*/
+/*---Index of a persistent request---*/
+/*---pseudo-private member function---*/
+
+static int Faces_ind_request_( Faces* faces,
+                               int    ibuf,
+                               int    axis,
+                               int    dir_ind,
+                               int    octant_in_block,
+                               int    iunit )
+{
+  Assert( ibuf >= 0 && ibuf < NDIM );
+  Assert( axis >= 0 && axis < 2 );
+  Assert( dir_ind >= 0 && dir_ind < 2 );
+  Assert( octant_in_block >= 0 && octant_in_block < NOCTANT );
+  Assert( iunit >= 0 && iunit < Faces_nunit( faces ) );
+
+  return octant_in_block + NOCTANT * (
+         dir_ind         + 2       * (
+         axis            + 2       * (
+         ibuf            + NDIM    * (
+         iunit ))));
+}
+
+/*===========================================================================*/
+/*---Index of an aggregated message request---*/
+/*---pseudo-private member function---*/
+
+static int Faces_ind_request_agg_( Faces* faces,
+                                   int    axis,
+                                   int    dir_ind,
+                                   int    iunit )
+{
+  Assert( axis >= 0 && axis < 2 );
+  Assert( dir_ind >= 0 && dir_ind < 2 );
+  Assert( iunit >= 0 && iunit < Faces_nunit( faces ) );
+
+  return dir_ind + 2 * ( axis + 2 * iunit );
+}
+
+/*===========================================================================*/
+/*---Message tag for an octant and work unit---*/
+/*---pseudo-private member function---*/
+
+/*---With over-decomposition the subdomain receiving the message is part
+     of the tag, since a proc may send the same octant and unit to several
+     subdomains of a neighbor.
+---*/
+
+static int Faces_tag_( Faces* faces,
+                       int    tag_base,
+                       int    octant_in_block,
+                       int    iunit,
+                       int    subdomain )
+{
+  return tag_base + octant_in_block + faces->noctant_per_block *
+                    ( iunit + Faces_nunit( faces ) * subdomain );
+}
+
+/*===========================================================================*/
+/*---Place of this subdomain in the grid of subdomains over all procs---*/
+/*---pseudo-private member functions---*/
+
+static int Faces_proc_x_( Faces* faces, Env* env )
+{
+  return Env_proc_x_this( env ) * faces->nsubdomain_x + faces->subdomain_x;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int Faces_proc_y_( Faces* faces, Env* env )
+{
+  return Env_proc_y_this( env ) * faces->nsubdomain_y + faces->subdomain_y;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int Faces_nproc_x_( Faces* faces, Env* env )
+{
+  return Env_nproc_x( env ) * faces->nsubdomain_x;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int Faces_nproc_y_( Faces* faces, Env* env )
+{
+  return Env_nproc_y( env ) * faces->nsubdomain_y;
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Proc holding a subdomain---*/
+
+static int Faces_proc_( Faces* faces, Env* env, int proc_x, int proc_y,
+                                                int proc_z )
+{
+  return Env_proc( env, proc_x / faces->nsubdomain_x,
+                        proc_y / faces->nsubdomain_y, proc_z );
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Index of a subdomain among the subdomains of its proc---*/
+
+static int Faces_subdomain_( Faces* faces, int proc_x, int proc_y )
+{
+  return proc_x % faces->nsubdomain_x +
+         faces->nsubdomain_x * ( proc_y % faces->nsubdomain_y );
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Is there a subdomain at an offset from this one, and is it local---*/
+
+static Bool_t Faces_has_neighbor_( Faces* faces, Env* env, int inc_x,
+                                                           int inc_y )
+{
+  const int proc_x = Faces_proc_x_( faces, env );
+  const int proc_y = Faces_proc_y_( faces, env );
+
+  return proc_x+inc_x >= 0 && proc_x+inc_x < Faces_nproc_x_( faces, env ) &&
+         proc_y+inc_y >= 0 && proc_y+inc_y < Faces_nproc_y_( faces, env );
+}
+
+/*---------------------------------------------------------------------------*/
+
+static Bool_t Faces_is_neighbor_on_proc_( Faces* faces, Env* env, int inc_x,
+                                                                  int inc_y )
+{
+  const int proc_x = Faces_proc_x_( faces, env );
+  const int proc_y = Faces_proc_y_( faces, env );
+
+  return Faces_has_neighbor_( faces, env, inc_x, inc_y ) &&
+         ( proc_x+inc_x ) / faces->nsubdomain_x == Env_proc_x_this( env ) &&
+         ( proc_y+inc_y ) / faces->nsubdomain_y == Env_proc_y_this( env );
+}
+
+/*===========================================================================*/
+/*---Shared memory mailboxes for the faces of one axis---*/
+/*---pseudo-private member functions---*/
+
+/*---A proc's mailboxes for an axis hold the faces coming from its two
+     neighbors along the axis: one face per direction and per face buffer
+     of the sender, laid out as the staging buffers are.  They are preceded
+     by one padded flag per direction, face buffer, octant and work unit,
+     set when the part of the face is written and cleared when it has been
+     read.  The neighbors along an axis have the same face sizes for that
+     axis, so sender and receiver agree on the layout.
+---*/
+
+static int Faces_shm_nflag_( Faces* faces )
+{
+  return 2 * NDIM * NOCTANT * Faces_nunit( faces );
+}
+
+/*---------------------------------------------------------------------------*/
+
+static size_t Faces_shm_size_( Faces*      faces,
+                               Dimensions  dims_b,
+                               int         axis )
+{
+  return Faces_shm_nflag_( faces ) * ENV_SHM_FLAG_STRIDE * sizeof(int) +
+         2 * NDIM * faces->noctant_per_block *
+         Faces_size_face_per_octant_( faces, dims_b, axis ) * sizeof(P);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int* Faces_shm_flag_( Faces* faces,
+                             char*  shm,
+                             int    ibuf,
+                             int    dir_ind,
+                             int    octant_in_block,
+                             int    iunit )
+{
+  Assert( shm != NULL );
+  Assert( ibuf >= 0 && ibuf < NDIM );
+  Assert( dir_ind >= 0 && dir_ind < 2 );
+  Assert( octant_in_block >= 0 && octant_in_block < NOCTANT );
+  Assert( iunit >= 0 && iunit < Faces_nunit( faces ) );
+
+  return ( (int*) shm ) + ENV_SHM_FLAG_STRIDE * (
+         octant_in_block + NOCTANT * (
+         ibuf            + NDIM    * (
+         dir_ind         + 2       * (
+         iunit ))));
+}
+
+/*---------------------------------------------------------------------------*/
+
+static P* Faces_shm_face_per_octant_( Faces*      faces,
+                                      Dimensions  dims_b,
+                                      char*       shm,
+                                      int         ibuf,
+                                      int         axis,
+                                      int         dir_ind,
+                                      int         octant_in_block )
+{
+  Assert( shm != NULL );
+
+  const size_t size_face_per_octant = Faces_size_face_per_octant_( faces,
+                                                             dims_b, axis );
+  P* const faces_shm = (P*) ( shm + Faces_shm_nflag_( faces ) *
+                                    ENV_SHM_FLAG_STRIDE * sizeof(int) );
+
+  return faces_shm
+       + size_face_per_octant * ( octant_in_block + faces->noctant_per_block *
+                                ( ibuf + NDIM * dir_ind ) );
+}
+
+/*===========================================================================*/
+/*---Set up shared memory mailboxes for neighbors on this node---*/
+/*---pseudo-private member function---*/
+
+static void Faces_create_shm_( Faces*      faces,
+                               Dimensions  dims_b,
+                               Env*        env )
+{
+  const int proc_x = Env_proc_x_this( env );
+  const int proc_y = Env_proc_y_this( env );
+  const int proc_z = Env_proc_z_this( env );
+
+  int axis = 0;
+  int dir_ind = 0;
+
+  for( axis=0; axis<2; ++axis )
+  {
+    faces->shm_this[axis] = (char*)Env_shm_allocate( env,
+                                    Faces_shm_size_( faces, dims_b, axis ),
+                                    & faces->shm_win[axis] );
+
+    for( dir_ind=0; dir_ind<2; ++dir_ind )
+    {
+      const int dir = dir_ind==0 ? DIR_UP*1 : DIR_DN*1;
+      const int inc_x = axis==0 ? Dir_inc( dir ) : 0;
+      const int inc_y = axis==1 ? Dir_inc( dir ) : 0;
+
+      const Bool_t has_proc_send =
+                   proc_x+inc_x >= 0 && proc_x+inc_x < Env_nproc_x( env ) &&
+                   proc_y+inc_y >= 0 && proc_y+inc_y < Env_nproc_y( env );
+      const Bool_t has_proc_recv =
+                   proc_x-inc_x >= 0 && proc_x-inc_x < Env_nproc_x( env ) &&
+                   proc_y-inc_y >= 0 && proc_y-inc_y < Env_nproc_y( env );
+
+      const int proc_send = has_proc_send ?
+                   Env_proc( env, proc_x+inc_x, proc_y+inc_y, proc_z ) : 0;
+      const int proc_recv = has_proc_recv ?
+                   Env_proc( env, proc_x-inc_x, proc_y-inc_y, proc_z ) : 0;
+
+      faces->shm_send[axis][dir_ind] =
+        has_proc_send && Env_proc_node( env, proc_send ) >= 0 ?
+        (char*)Env_shm_ptr( env, & faces->shm_win[axis], proc_send ) : NULL;
+
+      faces->is_shm_recv[axis][dir_ind] =
+        has_proc_recv && Env_proc_node( env, proc_recv ) >= 0;
+    }
+  }
+}
+
+/*===========================================================================*/
+/*---Send/recv a face through shared memory---*/
+/*---pseudo-private member functions---*/
+
+/*---The face is written directly into the neighbor's mailbox.  The
+     mailbox used is the one for the sender's face buffer, which both sides
+     know from the step.
+---*/
+
+static void Faces_shm_send_( Faces*      faces,
+                             Dimensions  dims_b,
+                             int         ibuf,
+                             int         axis,
+                             int         dir_ind,
+                             int         octant_in_block,
+                             int         iunit,
+                             Env*        env )
+{
+  char* const shm = faces->shm_send[axis][dir_ind];
+  int* const flag = Faces_shm_flag_( faces, shm, ibuf, dir_ind,
+                                     octant_in_block, iunit );
+
+  /*---Wait until the previous face in the mailbox has been read---*/
+
+  Env_shm_flag_wait( env, flag, 0 );
+
+  Faces_copy_unit_( faces, dims_b,
+    Faces_face_per_octant_( faces, dims_b, ibuf, axis, octant_in_block ),
+    Faces_shm_face_per_octant_( faces, dims_b, shm, ibuf, axis, dir_ind,
+                                octant_in_block ),
+    axis, iunit, Bool_true );
+
+  Env_shm_flag_set( flag, 1 );
+}
+
+/*---------------------------------------------------------------------------*/
+
+static void Faces_shm_recv_( Faces*      faces,
+                             Dimensions  dims_b,
+                             int         ibuf_send,
+                             int         ibuf,
+                             int         axis,
+                             int         dir_ind,
+                             int         octant_in_block,
+                             int         iunit,
+                             Env*        env )
+{
+  char* const shm = faces->shm_this[axis];
+  int* const flag = Faces_shm_flag_( faces, shm, ibuf_send, dir_ind,
+                                     octant_in_block, iunit );
+
+  Env_shm_flag_wait( env, flag, 1 );
+
+  Faces_copy_unit_( faces, dims_b,
+    Faces_face_per_octant_( faces, dims_b, ibuf, axis, octant_in_block ),
+    Faces_shm_face_per_octant_( faces, dims_b, shm, ibuf_send, axis, dir_ind,
+                                octant_in_block ),
+    axis, iunit, Bool_false );
+
+  Env_shm_flag_set( flag, 0 );
+}
+
+/*===========================================================================*/
+/*---Set up persistent send/recv requests for asynchronous comm---*/
+/*---pseudo-private member function---*/
+
+/*---One request per work unit, face buffer, axis, direction and octant,
+     for each neighbor that exists.  Tags are fixed for the life of the
+     requests; since all messages of a sweep complete within the sweep, the
+     MPI message ordering guarantee matches them correctly across sweeps.
+     Neighbors reached through shared memory, and subdomains of this proc,
+     get no request.
+---*/
+
+static void Faces_create_requests_( Faces*      faces,
+                                    Dimensions  dims_b,
+                                    Env*        env )
+{
+  const int proc_x = Faces_proc_x_( faces, env );
+  const int proc_y = Faces_proc_y_( faces, env );
+  const int proc_z = Env_proc_z_this( env );
+  const int tag = Env_tag( env );
+
+  int iunit = 0;
+  int ibuf = 0;
+  int axis = 0;
+  int dir_ind = 0;
+  int octant_in_block = 0;
+
+  for( iunit=0; iunit<Faces_nunit( faces ); ++iunit )
+  for( ibuf=0; ibuf<NDIM; ++ibuf )
+  for( axis=0; axis<2; ++axis )
+  for( dir_ind=0; dir_ind<2; ++dir_ind )
+  for( octant_in_block=0; octant_in_block<faces->noctant_per_block;
+                                                            ++octant_in_block )
+  {
+    const Bool_t axis_x = axis==0;
+    const Bool_t axis_y = axis==1;
+    const int dir = dir_ind==0 ? DIR_UP*1 : DIR_DN*1;
+    const int inc_x = axis_x ? Dir_inc( dir ) : 0;
+    const int inc_y = axis_y ? Dir_inc( dir ) : 0;
+
+    const int ind = Faces_ind_request_( faces, ibuf, axis, dir_ind,
+                                        octant_in_block, iunit );
+
+    const size_t size_face_per_octant = Faces_size_face_per_octant_unit_(
+                                              faces, dims_b, axis, iunit );
+    P* const face_per_octant = Faces_data_unit_( faces, dims_b,
+                                     ibuf, axis, octant_in_block, iunit );
+
+    /*---Send downstream, receive from upstream---*/
+
+    const Bool_t has_proc_send =
+                 Faces_has_neighbor_( faces, env, inc_x, inc_y ) &&
+                 faces->shm_send[axis][dir_ind] == NULL &&
+                 ! faces->is_sub_send[axis][dir_ind];
+    const Bool_t has_proc_recv =
+                 Faces_has_neighbor_( faces, env, -inc_x, -inc_y ) &&
+                 ! faces->is_shm_recv[axis][dir_ind] &&
+                 ! faces->is_sub_recv[axis][dir_ind];
+
+    faces->is_request_send_set[ind] = has_proc_send;
+    faces->is_request_recv_set[ind] = has_proc_recv;
+
+    if( has_proc_send )
+    {
+      Env_asend_init_P( env, face_per_octant, size_face_per_octant,
+        Faces_proc_( faces, env, proc_x+inc_x, proc_y+inc_y, proc_z ),
+        Faces_tag_( faces, tag, octant_in_block, iunit,
+                    Faces_subdomain_( faces, proc_x+inc_x, proc_y+inc_y ) ),
+        & faces->request_send[ind] );
+    }
+
+    if( has_proc_recv )
+    {
+      Env_arecv_init_P( env, face_per_octant, size_face_per_octant,
+        Faces_proc_( faces, env, proc_x-inc_x, proc_y-inc_y, proc_z ),
+        Faces_tag_( faces, tag, octant_in_block, iunit,
+                    Faces_subdomain_( faces, proc_x, proc_y ) ),
+        & faces->request_recv[ind] );
+    }
+  }
+}
+
 /*===========================================================================*/
 /*---Pseudo-constructor for Faces struct---*/
 
 void Faces_create( Faces*      faces,
                    Dimensions  dims_b,
                    int         noctant_per_block,
+                   int         nechunk,
+                   int         nangle_set,
                    Bool_t      is_face_comm_async,
+                   Bool_t      is_face_comm_aggregated,
+                   Bool_t      is_face_comm_progress,
+                   Bool_t      is_face_comm_shm,
+                   int         nsubdomain_x,
+                   int         nsubdomain_y,
+                   int         subdomain_x,
+                   int         subdomain_y,
                    Env*        env )
 {
   int i = 0;
-
-  faces->noctant_per_block  = noctant_per_block;
-  faces->is_face_comm_async = is_face_comm_async;
+  int axis = 0;
+  int dir_ind = 0;
+
+  Assert( is_face_comm_async || ! is_face_comm_aggregated );
+  Assert( is_face_comm_async || ! is_face_comm_progress );
+  Assert( ( is_face_comm_async && ! is_face_comm_aggregated ) ||
+          ! is_face_comm_shm );
+  Assert( nechunk > 0 && nechunk <= dims_b.ne );
+  Assert( nangle_set > 0 && nangle_set <= dims_b.na );
+  Assert( nangle_set == 1 || ! is_face_comm_aggregated );
+  Assert( nsubdomain_x * nsubdomain_y == 1 ||
+          ( is_face_comm_async && ! is_face_comm_aggregated &&
+            ! is_face_comm_shm ) );
+  Assert( subdomain_x >= 0 && subdomain_x < nsubdomain_x );
+  Assert( subdomain_y >= 0 && subdomain_y < nsubdomain_y );
+
+  faces->noctant_per_block       = noctant_per_block;
+  faces->nechunk                 = nechunk;
+  faces->nangle_set              = nangle_set;
+  faces->is_face_comm_async      = is_face_comm_async;
+  faces->is_face_comm_aggregated = is_face_comm_aggregated;
+  faces->is_face_comm_progress   = is_face_comm_progress;
+  faces->is_face_comm_shm        = is_face_comm_shm;
+  faces->nsubdomain_x            = nsubdomain_x;
+  faces->nsubdomain_y            = nsubdomain_y;
+  faces->subdomain_x             = subdomain_x;
+  faces->subdomain_y             = subdomain_y;
 
   /*====================*/
   /*---Allocate faces---*/
@@ -59,15 +752,211 @@ void Faces_create( Faces*      faces,
     Pointer_allocate( Faces_facexz( faces, i ) );
     Pointer_allocate( Faces_faceyz( faces, i ) );
   }
+
+  /*====================*/
+  /*---Allocate staging buffers for units not contiguous in the faces---*/
+  /*====================*/
+
+  for( axis=0; axis<NDIM; ++axis )
+  {
+    const int nbuf = axis == 2 || ! Faces_is_face_comm_async( faces ) ?
+                     1 : NDIM;
+
+    faces->buf_unit[axis] = nangle_set == 1 ? ( (P*) NULL ) :
+      malloc_host_P( nbuf * noctant_per_block *
+                     Faces_size_face_per_octant_( faces, dims_b, axis ) );
+  }
+
+  /*====================*/
+  /*---Set up shared memory mailboxes---*/
+  /*====================*/
+
+  for( axis=0; axis<2; ++axis )
+  {
+    faces->shm_this[axis] = NULL;
+    for( dir_ind=0; dir_ind<2; ++dir_ind )
+    {
+      faces->shm_send[axis][dir_ind]    = NULL;
+      faces->is_shm_recv[axis][dir_ind] = Bool_false;
+    }
+  }
+
+  if( Faces_is_face_comm_shm( faces ) )
+  {
+    Faces_create_shm_( faces, dims_b, env );
+  }
+
+  /*====================*/
+  /*---Find the neighbors that are subdomains of this proc---*/
+  /*====================*/
+
+  /*---Their face buffers are supplied by Faces_connect_subdomain---*/
+
+  for( axis=0; axis<2; ++axis )
+  for( dir_ind=0; dir_ind<2; ++dir_ind )
+  {
+    const int dir = dir_ind==0 ? DIR_UP*1 : DIR_DN*1;
+    const int inc_x = axis==0 ? Dir_inc( dir ) : 0;
+    const int inc_y = axis==1 ? Dir_inc( dir ) : 0;
+
+    faces->is_sub_send[axis][dir_ind] =
+                   Faces_is_neighbor_on_proc_( faces, env, inc_x, inc_y );
+    faces->is_sub_recv[axis][dir_ind] =
+                   Faces_is_neighbor_on_proc_( faces, env, -inc_x, -inc_y );
+
+    for( i=0; i<NDIM; ++i )
+    {
+      faces->sub_send[axis][dir_ind][i] = NULL;
+    }
+  }
+
+  /*====================*/
+  /*---Set up persistent requests or aggregation buffers---*/
+  /*====================*/
+
+  faces->request_send        = NULL;
+  faces->request_recv        = NULL;
+  faces->is_request_send_set = NULL;
+  faces->is_request_recv_set = NULL;
+  faces->request_send_agg    = NULL;
+  faces->request_recv_agg    = NULL;
+
+  if( Faces_is_face_comm_async( faces ) &&
+    ! Faces_is_face_comm_aggregated( faces ) )
+  {
+    const int nrequest = NDIM * 2 * 2 * NOCTANT * Faces_nunit( faces );
+
+    faces->request_send = (Request_t*)malloc( nrequest * sizeof(Request_t) );
+    faces->request_recv = (Request_t*)malloc( nrequest * sizeof(Request_t) );
+    faces->is_request_send_set = (Bool_t*)malloc( nrequest * sizeof(Bool_t) );
+    faces->is_request_recv_set = (Bool_t*)malloc( nrequest * sizeof(Bool_t) );
+
+    /*---Unused entries stay null so the arrays can be tested as a whole---*/
+
+    for( i=0; i<nrequest; ++i )
+    {
+      Env_request_nullify( env, & faces->request_send[i] );
+      Env_request_nullify( env, & faces->request_recv[i] );
+    }
+
+    Faces_create_requests_( faces, dims_b, env );
+  }
+
+  if( Faces_is_face_comm_aggregated( faces ) )
+  {
+    const int nrequest = 2 * 2 * Faces_nunit( faces );
+
+    faces->request_send_agg = (Request_t*)malloc( nrequest *
+                                                  sizeof(Request_t) );
+    faces->request_recv_agg = (Request_t*)malloc( nrequest *
+                                                  sizeof(Request_t) );
+
+    for( i=0; i<nrequest; ++i )
+    {
+      Env_request_nullify( env, & faces->request_send_agg[i] );
+      Env_request_nullify( env, & faces->request_recv_agg[i] );
+    }
+
+    for( axis=0; axis<2; ++axis )
+    for( dir_ind=0; dir_ind<2; ++dir_ind )
+    {
+      const size_t size_face = noctant_per_block *
+                         Faces_size_face_per_octant_( faces, dims_b, axis );
+      faces->buf_send_agg[axis][dir_ind] = malloc_host_P( size_face );
+      faces->buf_recv_agg[axis][dir_ind] = malloc_host_P( size_face );
+    }
+  }
 }
 
 /*===========================================================================*/
 /*---Pseudo-destructor for Faces struct---*/
 
-void Faces_destroy( Faces* faces )
+void Faces_destroy( Faces* faces,
+                    Env*   env )
 {
   int i = 0;
 
+  /*====================*/
+  /*---Free persistent requests or aggregation buffers---*/
+  /*====================*/
+
+  if( Faces_is_face_comm_aggregated( faces ) )
+  {
+    int axis = 0;
+    int dir_ind = 0;
+
+    for( axis=0; axis<2; ++axis )
+    for( dir_ind=0; dir_ind<2; ++dir_ind )
+    {
+      free_host_P( faces->buf_send_agg[axis][dir_ind] );
+      free_host_P( faces->buf_recv_agg[axis][dir_ind] );
+      faces->buf_send_agg[axis][dir_ind] = NULL;
+      faces->buf_recv_agg[axis][dir_ind] = NULL;
+    }
+
+    free( (void*) faces->request_send_agg );
+    free( (void*) faces->request_recv_agg );
+    faces->request_send_agg = NULL;
+    faces->request_recv_agg = NULL;
+  }
+  else if( Faces_is_face_comm_async( faces ) )
+  {
+    const int nrequest = NDIM * 2 * 2 * NOCTANT * Faces_nunit( faces );
+
+    for( i=0; i<nrequest; ++i )
+    {
+      const int octant_in_block = i % NOCTANT;
+
+      if( octant_in_block < faces->noctant_per_block &&
+          faces->is_request_send_set[i] )
+      {
+        Env_request_free( env, & faces->request_send[i] );
+      }
+      if( octant_in_block < faces->noctant_per_block &&
+          faces->is_request_recv_set[i] )
+      {
+        Env_request_free( env, & faces->request_recv[i] );
+      }
+    }
+
+    free( (void*) faces->request_send );
+    free( (void*) faces->request_recv );
+    free( (void*) faces->is_request_send_set );
+    free( (void*) faces->is_request_recv_set );
+    faces->request_send        = NULL;
+    faces->request_recv        = NULL;
+    faces->is_request_send_set = NULL;
+    faces->is_request_recv_set = NULL;
+  }
+
+  /*====================*/
+  /*---Free staging buffers---*/
+  /*====================*/
+
+  for( i=0; i<NDIM; ++i )
+  {
+    if( faces->buf_unit[i] != NULL )
+    {
+      free_host_P( faces->buf_unit[i] );
+      faces->buf_unit[i] = NULL;
+    }
+  }
+
+  /*====================*/
+  /*---Free shared memory mailboxes---*/
+  /*====================*/
+
+  if( Faces_is_face_comm_shm( faces ) )
+  {
+    int axis = 0;
+
+    for( axis=0; axis<2; ++axis )
+    {
+      Env_shm_free( env, & faces->shm_win[axis] );
+      faces->shm_this[axis] = NULL;
+    }
+  }
+
   /*====================*/
   /*---Deallocate faces---*/
   /*====================*/
@@ -80,30 +969,116 @@ void Faces_destroy( Faces* faces )
     Pointer_destroy( Faces_faceyz( faces, i ) );
   }
 }
+
+/*===========================================================================*/
+/*---Connect to the downstream neighbor subdomain on this proc---*/
+
+void Faces_connect_subdomain( Faces* faces,
+                              Faces* faces_downstream,
+                              int    axis,
+                              int    dir_ind )
+{
+  Assert( axis >= 0 && axis < 2 );
+  Assert( dir_ind >= 0 && dir_ind < 2 );
+  Assert( faces->is_sub_send[axis][dir_ind] );
+  Assert( faces_downstream->is_sub_recv[axis][dir_ind] );
+  Assert( Faces_is_face_comm_async( faces ) );
+
+  int i = 0;
+
+  for( i=0; i<NDIM; ++i )
+  {
+    faces->sub_send[axis][dir_ind][i] = Pointer_h( axis == 0 ?
+                                      Faces_faceyz( faces_downstream, i ) :
+                                      Faces_facexz( faces_downstream, i ) );
+  }
+}
+
+/*===========================================================================*/
+/*---Send a face to a subdomain of this proc---*/
+/*---pseudo-private member function---*/
+
+/*---The unit is copied into the face buffer the neighbor sweeps at the
+     next step.  That buffer was last used by the neighbor two steps
+     before, and only this sender writes the octant's part of it.
+---*/
+
+static void Faces_sub_send_( Faces*      faces,
+                             Dimensions  dims_b,
+                             int         step,
+                             int         axis,
+                             int         dir_ind,
+                             int         octant_in_block,
+                             int         iunit )
+{
+  const int ibuf = Faces_ibuf_step( faces, step );
+  P* const face_per_octant_send =
+              faces->sub_send[axis][dir_ind][Faces_ibuf_step( faces, step+1 )]
+              + Faces_size_face_per_octant_( faces, dims_b, axis ) *
+                octant_in_block;
+
+  Assert( faces->sub_send[axis][dir_ind][0] != NULL );
+
+  Faces_stage_unit_( faces, dims_b, ibuf, axis, octant_in_block,
+                     iunit, Bool_true );
+
+  Faces_copy_unit_( faces, dims_b, face_per_octant_send,
+    Faces_units_per_octant_( faces, dims_b, ibuf, axis, octant_in_block ),
+    axis, iunit, Bool_false );
+}
+
+/*===========================================================================*/
+/*---Does the sweep of a step send any face to another proc---*/
+
+Bool_t Faces_is_send_off_proc(
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  int              step )
+{
+  int octant_in_block = 0;
+  int axis = 0;
+  int dir_ind = 0;
+
+  for( octant_in_block=0; octant_in_block<faces->noctant_per_block;
+                                                            ++octant_in_block )
+  for( axis=0; axis<2; ++axis )
+  for( dir_ind=0; dir_ind<2; ++dir_ind )
+  {
+    if( SweepPlan_must_do_send( sweepplan, step, axis, dir_ind,
+                                octant_in_block ) &&
+        ! faces->is_sub_send[axis][dir_ind] )
+    {
+      return Bool_true;
+    }
+  }
+
+  return Bool_false;
+}
+
 /*===========================================================================*/
 /*---Communicate faces computed at step, used at step+1---*/
 
+/*---Each face is exchanged in place: the values computed here are sent
+     downstream and replaced by the values received from upstream.  Every
+     chain of ranks along an axis ends at the boundary, so the blocking
+     calls cannot deadlock.
+---*/
+
 void Faces_communicate_faces(
-  Faces*          faces,
-  StepScheduler*  stepscheduler,
-  Dimensions      dims_b,
-  int             step,
-  Env*            env )
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env )
 {
   Assert( ! Faces_is_face_comm_async( faces ) );
 
   const int proc_x = Env_proc_x_this( env );
   const int proc_y = Env_proc_y_this( env );
+  const int proc_z = Env_proc_z_this( env );
 
-  const size_t size_facexz_per_octant = Dimensions_size_facexz( dims_b,
-                 NU, faces->noctant_per_block ) / faces->noctant_per_block;
-  const size_t size_faceyz_per_octant = Dimensions_size_faceyz( dims_b,
-                 NU, faces->noctant_per_block ) / faces->noctant_per_block;
-
-  /*---Allocate temporary face buffers---*/
-
-  P* __restrict__ buf_xz  = malloc_host_P( size_facexz_per_octant );
-  P* __restrict__ buf_yz  = malloc_host_P( size_faceyz_per_octant );
+  const int ibuf = Faces_ibuf_step( faces, step );
 
   /*---Loop over octants---*/
 
@@ -121,19 +1096,10 @@ void Faces_communicate_faces(
       const Bool_t axis_x = axis==0;
       const Bool_t axis_y = axis==1;
 
-      const int proc_axis = axis_x ? proc_x : proc_y;
-
-      const size_t    size_face_per_octant    = axis_x ? size_faceyz_per_octant
-                                                       : size_facexz_per_octant;
-      P* __restrict__ buf                     = axis_x ? buf_yz
-                                                       : buf_xz;
-      P* __restrict__ face_per_octant = axis_x ?
-        ref_faceyz( Pointer_h( Faces_faceyz_step( faces, step ) ),
-                    dims_b, NU, faces->noctant_per_block,
-                    0, 0, 0, 0, 0, octant_in_block ) :
-        ref_facexz( Pointer_h( Faces_facexz_step( faces, step ) ),
-                    dims_b, NU, faces->noctant_per_block,
-                     0, 0, 0, 0, 0, octant_in_block );
+      const size_t size_face_per_octant = Faces_size_face_per_octant_unit_(
+                                              faces, dims_b, axis, iunit );
+      P* __restrict__ face_per_octant = Faces_data_unit_( faces,
+                               dims_b, ibuf, axis, octant_in_block, iunit );
 
       int dir_ind = 0;
 
@@ -145,100 +1111,323 @@ void Faces_communicate_faces(
 
         /*---Determine whether to communicate---*/
 
-        Bool_t const do_send = StepScheduler_must_do_send(
-                   stepscheduler, step, axis, dir_ind, octant_in_block, env );
+        Bool_t const do_send = SweepPlan_must_do_send(
+                   sweepplan, step, axis, dir_ind, octant_in_block );
+
+        Bool_t const do_recv = SweepPlan_must_do_recv(
+                   sweepplan, step, axis, dir_ind, octant_in_block );
+
+        if( do_send )
+        {
+          Faces_stage_unit_( faces, dims_b, ibuf, axis, octant_in_block,
+                             iunit, Bool_true );
+        }
+
+        if( do_send && do_recv )
+        {
+          Env_sendrecv_replace_P( env, face_per_octant, size_face_per_octant,
+                        Env_proc( env, proc_x+inc_x, proc_y+inc_y, proc_z ),
+                        Env_proc( env, proc_x-inc_x, proc_y-inc_y, proc_z ),
+                                  Faces_tag_( faces, Env_tag( env ),
+                                              octant_in_block, iunit, 0 ) );
+        }
+        else if( do_send )
+        {
+          Env_send_P( env, face_per_octant, size_face_per_octant,
+                      Env_proc( env, proc_x+inc_x, proc_y+inc_y, proc_z ),
+                      Faces_tag_( faces, Env_tag( env ),
+                                  octant_in_block, iunit, 0 ) );
+        }
+        else if( do_recv )
+        {
+          Env_recv_P( env, face_per_octant, size_face_per_octant,
+                      Env_proc( env, proc_x-inc_x, proc_y-inc_y, proc_z ),
+                      Faces_tag_( faces, Env_tag( env ),
+                                  octant_in_block, iunit, 0 ) );
+        }
+
+        if( do_recv )
+        {
+          Faces_stage_unit_( faces, dims_b, ibuf, axis, octant_in_block,
+                             iunit, Bool_false );
+        }
+      } /*---dir_ind---*/
+    } /*---axis---*/
+  } /*---octant_in_block---*/
+}
+
+/*===========================================================================*/
+/*---Communicate xy faces computed at step, used at step+1---*/
+
+/*---Needed only when z is decomposed across procs.  The xy face is single
+     buffered and is exchanged in place, in the same manner as the
+     synchronous exchange of the other faces.
+---*/
+
+void Faces_communicate_facexy(
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env )
+{
+  const int proc_x = Env_proc_x_this( env );
+  const int proc_y = Env_proc_y_this( env );
+  const int proc_z = Env_proc_z_this( env );
+
+  const int axis = 2;
+
+  const size_t size_face_per_octant = Faces_size_face_per_octant_unit_(
+                                              faces, dims_b, axis, iunit );
+
+  /*---Loop over octants---*/
+
+  int octant_in_block = 0;
+
+  if( Env_nproc_z( env ) == 1 )
+  {
+    return;
+  }
+
+  for( octant_in_block=0; octant_in_block<faces->noctant_per_block;
+                                                            ++octant_in_block )
+  {
+    P* __restrict__ face_per_octant = Faces_data_unit_( faces,
+                                  dims_b, 0, axis, octant_in_block, iunit );
+
+    int dir_ind = 0;
+
+    for( dir_ind=0; dir_ind<2; ++dir_ind ) /*---Loop: up, down---*/
+    {
+      const int dir = dir_ind==0 ? DIR_UP*1 : DIR_DN*1;
+      const int inc_z = Dir_inc( dir );
+
+      /*---Determine whether to communicate---*/
 
-        Bool_t const do_recv = StepScheduler_must_do_recv(
-                   stepscheduler, step, axis, dir_ind, octant_in_block, env );
+      Bool_t const do_send = SweepPlan_must_do_send(
+                 sweepplan, step, axis, dir_ind, octant_in_block );
 
-        /*---Communicate as needed - red/black coloring to avoid deadlock---*/
+      Bool_t const do_recv = SweepPlan_must_do_recv(
+                 sweepplan, step, axis, dir_ind, octant_in_block );
 
-        int color = 0;
+      if( do_send )
+      {
+        Faces_stage_unit_( faces, dims_b, 0, axis, octant_in_block,
+                           iunit, Bool_true );
+      }
 
-        Bool_t use_buf = Bool_false;
+      if( do_send && do_recv )
+      {
+        Env_sendrecv_replace_P( env, face_per_octant, size_face_per_octant,
+                                Env_proc( env, proc_x, proc_y, proc_z+inc_z ),
+                                Env_proc( env, proc_x, proc_y, proc_z-inc_z ),
+                                Faces_tag_( faces, Env_tag( env ),
+                                            octant_in_block, iunit, 0 ) );
+      }
+      else if( do_send )
+      {
+        Env_send_P( env, face_per_octant, size_face_per_octant,
+                    Env_proc( env, proc_x, proc_y, proc_z+inc_z ),
+                    Faces_tag_( faces, Env_tag( env ),
+                                octant_in_block, iunit, 0 ) );
+      }
+      else if( do_recv )
+      {
+        Env_recv_P( env, face_per_octant, size_face_per_octant,
+                    Env_proc( env, proc_x, proc_y, proc_z-inc_z ),
+                    Faces_tag_( faces, Env_tag( env ),
+                                octant_in_block, iunit, 0 ) );
+      }
 
-        for( color=0; color<2; ++color )
+      if( do_recv )
+      {
+        Faces_stage_unit_( faces, dims_b, 0, axis, octant_in_block,
+                           iunit, Bool_false );
+      }
+    } /*---dir_ind---*/
+  } /*---octant_in_block---*/
+}
+
+/*===========================================================================*/
+/*---Octants whose faces go to, or come from, one neighbor at a step---*/
+/*---pseudo-private member function---*/
+
+static int Faces_octants_agg_( Faces*           faces,
+                               const SweepPlan* sweepplan,
+                               int              step,
+                               int              axis,
+                               int              dir_ind,
+                               Bool_t           is_send,
+                               int*             octants )
+{
+  int noctant = 0;
+  int octant_in_block = 0;
+
+  for( octant_in_block=0; octant_in_block<faces->noctant_per_block;
+                                                            ++octant_in_block )
+  {
+    const Bool_t do_comm = is_send ?
+      SweepPlan_must_do_send( sweepplan, step, axis, dir_ind, octant_in_block ):
+      SweepPlan_must_do_recv( sweepplan, step, axis, dir_ind, octant_in_block );
+
+    if( do_comm )
+    {
+      octants[noctant++] = octant_in_block;
+    }
+  }
+
+  return noctant;
+}
+
+/*===========================================================================*/
+/*---Aggregated send/recv of faces: one message per neighbor per step---*/
+/*---pseudo-private member functions---*/
+
+/*---The octants of a face are stored one after the other.  If the parts
+     to be communicated are adjacent, the message is sent from or received
+     into the face directly; otherwise it is packed into, or unpacked from,
+     a buffer.  Both sides derive the same octant list from the plan.
+---*/
+
+static void Faces_comm_faces_agg_( Faces*           faces,
+                                   const SweepPlan* sweepplan,
+                                   Dimensions       dims_b,
+                                   int              step,
+                                   int              iunit,
+                                   Bool_t           is_send,
+                                   Bool_t           is_start,
+                                   Env*             env )
+{
+  Assert( Faces_is_face_comm_aggregated( faces ) );
+  Assert( faces->nangle_set == 1 );
+
+  /*---With one angle set each work unit is an energy chunk---*/
+
+  const int ichunk = Faces_ichunk_unit( faces, iunit );
+
+  const int proc_x = Env_proc_x_this( env );
+  const int proc_y = Env_proc_y_this( env );
+  const int proc_z = Env_proc_z_this( env );
+
+  /*---Sends use the faces computed on this step, receives fill the
+       faces used on the next step---*/
+
+  const int ibuf = Faces_ibuf_step( faces, is_send ? step : step+1 );
+
+  int axis = 0;
+
+  for( axis=0; axis<2; ++axis )
+  {
+    const Bool_t axis_x = axis==0;
+    const Bool_t axis_y = axis==1;
+
+    const size_t size_face_per_octant = Faces_size_face_per_octant_chunk_(
+                                              faces, dims_b, axis, ichunk );
+    const Bool_t is_chunk_whole_face = size_face_per_octant ==
+                         Faces_size_face_per_octant_( faces, dims_b, axis );
+
+    /*---Each energy chunk has its own part of the buffers---*/
+
+    const size_t offset_buf = faces->noctant_per_block *
+                        ( Faces_size_face_per_octant_( faces, dims_b, axis ) /
+                                                                 dims_b.ne ) *
+                        Faces_iemin_chunk( faces, dims_b.ne, ichunk );
+
+    int dir_ind = 0;
+
+    for( dir_ind=0; dir_ind<2; ++dir_ind )
+    {
+      const int dir = dir_ind==0 ? DIR_UP*1 : DIR_DN*1;
+      const int inc_x = axis_x ? Dir_inc( dir ) : 0;
+      const int inc_y = axis_y ? Dir_inc( dir ) : 0;
+
+      int octants[NOCTANT];
+      const int noctant = Faces_octants_agg_( faces, sweepplan, step, axis,
+                                              dir_ind, is_send, octants );
+
+      if( noctant > 0 )
+      {
+        const Bool_t is_contiguous = noctant == 1 || ( is_chunk_whole_face &&
+                         octants[noctant-1] - octants[0] == noctant - 1 );
+        P* const buf = offset_buf + ( is_send ?
+                                      faces->buf_send_agg[axis][dir_ind] :
+                                      faces->buf_recv_agg[axis][dir_ind] );
+        P* const data = is_contiguous ?
+          Faces_face_per_octant_chunk_( faces, dims_b, ibuf, axis,
+                                        octants[0], ichunk ) : buf;
+        const int ind = Faces_ind_request_agg_( faces, axis, dir_ind, iunit );
+        Request_t* request = is_send ? & faces->request_send_agg[ind]
+                                     : & faces->request_recv_agg[ind];
+        int ioctant = 0;
+
+        if( is_send && is_start )
         {
-          if( color == 0 )
+          if( ! is_contiguous )
           {
-            if( proc_axis % 2 == 0 )
-            {
-              if( do_send )
-              {
-                const int proc_other
-                                 = Env_proc( env, proc_x+inc_x, proc_y+inc_y );
-                Env_send_P( env, face_per_octant, size_face_per_octant,
-                            proc_other, Env_tag( env )+octant_in_block );
-              }
-            }
-            else
+            for( ioctant=0; ioctant<noctant; ++ioctant )
             {
-              if( do_recv )
-              {
-                const int proc_other
-                                 = Env_proc( env, proc_x-inc_x, proc_y-inc_y );
-                /*---save copy else color 0 recv will destroy color 1 send---*/
-                copy_vector( buf, face_per_octant, size_face_per_octant );
-                use_buf = Bool_true;
-                Env_recv_P( env, face_per_octant, size_face_per_octant,
-                            proc_other, Env_tag( env )+octant_in_block );
-              }
+              copy_vector( buf + ioctant * size_face_per_octant,
+                           Faces_face_per_octant_chunk_( faces, dims_b, ibuf,
+                                               axis, octants[ioctant], ichunk ),
+                           size_face_per_octant );
             }
           }
-          else /*---if color---*/
+          Env_asend_P( env, data, noctant * size_face_per_octant,
+                       Env_proc( env, proc_x+inc_x, proc_y+inc_y, proc_z ),
+                       Faces_tag_( faces, Env_tag( env ), 0, iunit, 0 ),
+                       request );
+        }
+        else if( is_start )
+        {
+          Env_arecv_P( env, data, noctant * size_face_per_octant,
+                       Env_proc( env, proc_x-inc_x, proc_y-inc_y, proc_z ),
+                       Faces_tag_( faces, Env_tag( env ), 0, iunit, 0 ),
+                       request );
+        }
+        else
+        {
+          Env_wait( env, request );
+
+          if( ! is_send && ! is_contiguous )
           {
-            if( proc_axis % 2 == 0 )
+            for( ioctant=0; ioctant<noctant; ++ioctant )
             {
-              if( do_recv )
-              {
-                const int proc_other
-                                 = Env_proc( env, proc_x-inc_x, proc_y-inc_y );
-                Env_recv_P( env, face_per_octant, size_face_per_octant,
-                            proc_other, Env_tag( env )+octant_in_block );
-              }
+              copy_vector( Faces_face_per_octant_chunk_( faces, dims_b, ibuf,
+                                               axis, octants[ioctant], ichunk ),
+                           buf + ioctant * size_face_per_octant,
+                           size_face_per_octant );
             }
-            else
-            {
-              if( do_send )
-              {
-                const int proc_other
-                                 = Env_proc( env, proc_x+inc_x, proc_y+inc_y );
-                Env_send_P( env, use_buf ? buf : face_per_octant,
-                  size_face_per_octant, proc_other,
-                  Env_tag( env )+octant_in_block );
-              }
-            }
-          } /*---if color---*/
-        } /*---color---*/
-      } /*---dir_ind---*/
-    } /*---axis---*/
-  } /*---octant_in_block---*/
-
-  /*---Deallocations---*/
-
-  free_host_P( buf_xz );
-  free_host_P( buf_yz );
+          }
+        }
+      }
+    } /*---dir_ind---*/
+  } /*---axis---*/
 }
 
 /*===========================================================================*/
 /*---Asynchronously send faces computed at step, used at step+1: start---*/
 
 void Faces_send_faces_start(
-  Faces*          faces,
-  StepScheduler*  stepscheduler,
-  Dimensions      dims_b,
-  int             step,
-  Env*            env )
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env )
 {
   Assert( Faces_is_face_comm_async( faces ) );
 
-  const int proc_x = Env_proc_x_this( env );
-  const int proc_y = Env_proc_y_this( env );
+  if( Faces_is_face_comm_aggregated( faces ) )
+  {
+    Faces_comm_faces_agg_( faces, sweepplan, dims_b, step, iunit,
+                           Bool_true, Bool_true, env );
+    return;
+  }
+
+  /*---Send values computed on this step---*/
 
-  const size_t size_facexz_per_octant = Dimensions_size_facexz( dims_b,
-                 NU, faces->noctant_per_block ) / faces->noctant_per_block;
-  const size_t size_faceyz_per_octant = Dimensions_size_faceyz( dims_b,
-                 NU, faces->noctant_per_block ) / faces->noctant_per_block;
+  const int ibuf = Faces_ibuf_step( faces, step );
 
   /*---Loop over octants---*/
 
@@ -253,42 +1442,33 @@ void Faces_send_faces_start(
 
     for( axis=0; axis<2; ++axis )
     {
-      const Bool_t axis_x = axis==0;
-      const Bool_t axis_y = axis==1;
-
-      /*---Send values computed on this step---*/
-
-      const size_t    size_face_per_octant    = axis_x ? size_faceyz_per_octant
-                                                       : size_facexz_per_octant;
-      P* __restrict__ face_per_octant = axis_x ?
-        ref_faceyz( Pointer_h( Faces_faceyz_step( faces, step ) ),
-                    dims_b, NU, faces->noctant_per_block,
-                    0, 0, 0, 0, 0, octant_in_block ) :
-        ref_facexz( Pointer_h( Faces_facexz_step( faces, step ) ),
-                    dims_b, NU, faces->noctant_per_block,
-                    0, 0, 0, 0, 0, octant_in_block );
-
       int dir_ind = 0;
 
       for( dir_ind=0; dir_ind<2; ++dir_ind )
       {
-        const int dir = dir_ind==0 ? DIR_UP*1 : DIR_DN*1;
-        const int inc_x = axis_x ? Dir_inc( dir ) : 0;
-        const int inc_y = axis_y ? Dir_inc( dir ) : 0;
-
         /*---Determine whether to communicate---*/
 
-        Bool_t const do_send = StepScheduler_must_do_send(
-                   stepscheduler, step, axis, dir_ind, octant_in_block, env );
+        Bool_t const do_send = SweepPlan_must_do_send(
+                   sweepplan, step, axis, dir_ind, octant_in_block );
 
-        if( do_send )
+        if( do_send && faces->is_sub_send[axis][dir_ind] )
+        {
+          Faces_sub_send_( faces, dims_b, step, axis, dir_ind,
+                           octant_in_block, iunit );
+        }
+        else if( do_send && faces->shm_send[axis][dir_ind] != NULL )
+        {
+          Faces_shm_send_( faces, dims_b, ibuf, axis, dir_ind,
+                           octant_in_block, iunit, env );
+        }
+        else if( do_send )
         {
-          const int proc_other = Env_proc( env, proc_x+inc_x, proc_y+inc_y );
-          Request_t* request = axis_x ?
-                                   & faces->request_send_xz[octant_in_block]
-                                 : & faces->request_send_yz[octant_in_block];
-          Env_asend_P( env, face_per_octant, size_face_per_octant,
-                    proc_other, Env_tag( env )+octant_in_block, request );
+          const int ind = Faces_ind_request_( faces, ibuf, axis, dir_ind,
+                                              octant_in_block, iunit );
+          Assert( faces->is_request_send_set[ind] );
+          Faces_stage_unit_( faces, dims_b, ibuf, axis, octant_in_block,
+                             iunit, Bool_true );
+          Env_start( env, & faces->request_send[ind] );
         }
       } /*---dir_ind---*/
     } /*---axis---*/
@@ -299,16 +1479,25 @@ void Faces_send_faces_start(
 /*---Asynchronously send faces computed at step, used at step+1: end---*/
 
 void Faces_send_faces_end(
-  Faces*          faces,
-  StepScheduler*  stepscheduler,
-  Dimensions      dims_b,
-  int             step,
-  Env*            env )
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env )
 {
   Assert( Faces_is_face_comm_async( faces ) );
 
-  const int proc_x = Env_proc_x_this( env );
-  const int proc_y = Env_proc_y_this( env );
+  if( Faces_is_face_comm_aggregated( faces ) )
+  {
+    Faces_comm_faces_agg_( faces, sweepplan, dims_b, step, iunit,
+                           Bool_true, Bool_false, env );
+    return;
+  }
+
+  /*---Send values computed on this step---*/
+
+  const int ibuf = Faces_ibuf_step( faces, step );
 
   /*---Loop over octants---*/
 
@@ -323,24 +1512,25 @@ void Faces_send_faces_end(
 
     for( axis=0; axis<2; ++axis )
     {
-      const Bool_t axis_x = axis==0;
-
       int dir_ind = 0;
 
       for( dir_ind=0; dir_ind<2; ++dir_ind )
       {
-
         /*---Determine whether to communicate---*/
 
-        Bool_t const do_send = StepScheduler_must_do_send(
-                   stepscheduler, step, axis, dir_ind, octant_in_block, env );
+        Bool_t const do_send = SweepPlan_must_do_send(
+                   sweepplan, step, axis, dir_ind, octant_in_block );
 
-        if( do_send )
+        /*---A send through shared memory or to a subdomain of this
+             proc is complete once started---*/
+
+        if( do_send && faces->shm_send[axis][dir_ind] == NULL &&
+                     ! faces->is_sub_send[axis][dir_ind] )
         {
-          Request_t* request = axis_x ?
-                                   & faces->request_send_xz[octant_in_block]
-                                 : & faces->request_send_yz[octant_in_block];
-          Env_wait( env, request );
+          const int ind = Faces_ind_request_( faces, ibuf, axis, dir_ind,
+                                              octant_in_block, iunit );
+          Assert( faces->is_request_send_set[ind] );
+          Env_wait( env, & faces->request_send[ind] );
         }
       } /*---dir_ind---*/
     } /*---axis---*/
@@ -351,21 +1541,25 @@ void Faces_send_faces_end(
 /*---Asynchronously recv faces computed at step, used at step+1: start---*/
 
 void Faces_recv_faces_start(
-  Faces*          faces,
-  StepScheduler*  stepscheduler,
-  Dimensions      dims_b,
-  int             step,
-  Env*            env )
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env )
 {
   Assert( Faces_is_face_comm_async( faces ) );
 
-  const int proc_x = Env_proc_x_this( env );
-  const int proc_y = Env_proc_y_this( env );
+  if( Faces_is_face_comm_aggregated( faces ) )
+  {
+    Faces_comm_faces_agg_( faces, sweepplan, dims_b, step, iunit,
+                           Bool_false, Bool_true, env );
+    return;
+  }
 
-  const size_t size_facexz_per_octant = Dimensions_size_facexz( dims_b,
-                 NU, faces->noctant_per_block ) / faces->noctant_per_block;
-  const size_t size_faceyz_per_octant = Dimensions_size_faceyz( dims_b,
-                 NU, faces->noctant_per_block ) / faces->noctant_per_block;
+  /*---Receive values computed on the next step---*/
+
+  const int ibuf = Faces_ibuf_step( faces, step+1 );
 
   /*---Loop over octants---*/
 
@@ -380,42 +1574,25 @@ void Faces_recv_faces_start(
 
     for( axis=0; axis<2; ++axis )
     {
-      const Bool_t axis_x = axis==0;
-      const Bool_t axis_y = axis==1;
-
-      /*---Receive values computed on the next step---*/
-
-      const size_t    size_face_per_octant    = axis_x ? size_faceyz_per_octant
-                                                       : size_facexz_per_octant;
-      P* __restrict__ face_per_octant = axis_x ?
-        ref_faceyz( Pointer_h( Faces_faceyz_step( faces, step+1 ) ),
-                    dims_b, NU, faces->noctant_per_block,
-                    0, 0, 0, 0, 0, octant_in_block ) :
-        ref_facexz( Pointer_h( Faces_facexz_step( faces, step+1 ) ),
-                    dims_b, NU, faces->noctant_per_block,
-                    0, 0, 0, 0, 0, octant_in_block );
-
       int dir_ind = 0;
 
       for( dir_ind=0; dir_ind<2; ++dir_ind )
       {
-        const int dir = dir_ind==0 ? DIR_UP*1 : DIR_DN*1;
-        const int inc_x = axis_x ? Dir_inc( dir ) : 0;
-        const int inc_y = axis_y ? Dir_inc( dir ) : 0;
-
         /*---Determine whether to communicate---*/
 
-        Bool_t const do_recv = StepScheduler_must_do_recv(
-                   stepscheduler, step, axis, dir_ind, octant_in_block, env );
+        Bool_t const do_recv = SweepPlan_must_do_recv(
+                   sweepplan, step, axis, dir_ind, octant_in_block );
 
-        if( do_recv )
+        /*---A recv through shared memory is all done at the end; one
+             from a subdomain of this proc needs nothing---*/
+
+        if( do_recv && ! faces->is_shm_recv[axis][dir_ind] &&
+                       ! faces->is_sub_recv[axis][dir_ind] )
         {
-          const int proc_other = Env_proc( env, proc_x-inc_x, proc_y-inc_y );
-          Request_t* request = axis_x ?
-                                   & faces->request_recv_xz[octant_in_block]
-                                 : & faces->request_recv_yz[octant_in_block];
-          Env_arecv_P( env, face_per_octant, size_face_per_octant,
-                    proc_other, Env_tag( env )+octant_in_block, request );
+          const int ind = Faces_ind_request_( faces, ibuf, axis, dir_ind,
+                                              octant_in_block, iunit );
+          Assert( faces->is_request_recv_set[ind] );
+          Env_start( env, & faces->request_recv[ind] );
         }
       } /*---dir_ind---*/
     } /*---axis---*/
@@ -426,21 +1603,25 @@ void Faces_recv_faces_start(
 /*---Asynchronously recv faces computed at step, used at step+1: end---*/
 
 void Faces_recv_faces_end(
-  Faces*          faces,
-  StepScheduler*  stepscheduler,
-  Dimensions      dims_b,
-  int             step,
-  Env*            env )
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env )
 {
   Assert( Faces_is_face_comm_async( faces ) );
 
-  const int proc_x = Env_proc_x_this( env );
-  const int proc_y = Env_proc_y_this( env );
+  if( Faces_is_face_comm_aggregated( faces ) )
+  {
+    Faces_comm_faces_agg_( faces, sweepplan, dims_b, step, iunit,
+                           Bool_false, Bool_false, env );
+    return;
+  }
+
+  /*---Receive values computed on the next step---*/
 
-  const size_t size_facexz_per_octant = Dimensions_size_facexz( dims_b,
-                 NU, faces->noctant_per_block ) / faces->noctant_per_block;
-  const size_t size_faceyz_per_octant = Dimensions_size_faceyz( dims_b,
-                 NU, faces->noctant_per_block ) / faces->noctant_per_block;
+  const int ibuf = Faces_ibuf_step( faces, step+1 );
 
   /*---Loop over octants---*/
 
@@ -455,29 +1636,67 @@ void Faces_recv_faces_end(
 
     for( axis=0; axis<2; ++axis )
     {
-      const Bool_t axis_x = axis==0;
-
       int dir_ind = 0;
 
       for( dir_ind=0; dir_ind<2; ++dir_ind )
       {
         /*---Determine whether to communicate---*/
 
-        Bool_t const do_recv = StepScheduler_must_do_recv(
-                   stepscheduler, step, axis, dir_ind, octant_in_block, env );
+        Bool_t const do_recv = SweepPlan_must_do_recv(
+                   sweepplan, step, axis, dir_ind, octant_in_block );
 
-        if( do_recv )
+        if( do_recv && faces->is_sub_recv[axis][dir_ind] )
         {
-          Request_t* request = axis_x ?
-                                   & faces->request_recv_xz[octant_in_block]
-                                 : & faces->request_recv_yz[octant_in_block];
-          Env_wait( env, request );
+          /*---Already in place---*/
+        }
+        else if( do_recv && faces->is_shm_recv[axis][dir_ind] )
+        {
+          Faces_shm_recv_( faces, dims_b, Faces_ibuf_step( faces, step ),
+                           ibuf, axis, dir_ind, octant_in_block, iunit, env );
+        }
+        else if( do_recv )
+        {
+          const int ind = Faces_ind_request_( faces, ibuf, axis, dir_ind,
+                                              octant_in_block, iunit );
+          Assert( faces->is_request_recv_set[ind] );
+          Env_wait( env, & faces->request_recv[ind] );
+          Faces_stage_unit_( faces, dims_b, ibuf, axis, octant_in_block,
+                             iunit, Bool_false );
         }
       } /*---dir_ind---*/
     } /*---axis---*/
   } /*---octant_in_block---*/
 }
 
+/*===========================================================================*/
+/*---Progress outstanding asynchronous face communication: nonblocking---*/
+
+/*---The whole request arrays are tested; requests not in flight are null
+     or inactive and are ignored.  Completed requests are left for the
+     matching end function to retire.
+---*/
+
+void Faces_progress( Faces* faces,
+                     Env*   env )
+{
+  Assert( Faces_is_face_comm_async( faces ) );
+
+  if( Faces_is_face_comm_aggregated( faces ) )
+  {
+    const int nrequest = 2 * 2 * Faces_nunit( faces );
+
+    Env_testall( env, faces->request_send_agg, nrequest );
+    Env_testall( env, faces->request_recv_agg, nrequest );
+  }
+  else
+  {
+    const int nrequest = NDIM * 2 * 2 * NOCTANT * Faces_nunit( faces );
+
+    Env_testall( env, faces->request_send, nrequest );
+    Env_testall( env, faces->request_recv, nrequest );
+  }
+}
+
 /*===========================================================================*/
 
 #ifdef __cplusplus
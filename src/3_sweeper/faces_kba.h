@@ -16,7 +16,7 @@
 #include "definitions.h"
 #include "dimensions.h"
 #include "quantities.h"
-#include "stepscheduler_kba.h"
+#include "sweepplan_kba.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -38,14 +38,56 @@ typedef struct
   Pointer          faceyz1;
   Pointer          faceyz2;
 
-  Request_t        request_send_xz[NOCTANT];
-  Request_t        request_send_yz[NOCTANT];
-  Request_t        request_recv_xz[NOCTANT];
-  Request_t        request_recv_yz[NOCTANT];
+  /*---Persistent requests, per work unit, face buffer, axis, direction
+       and octant---*/
+
+  Request_t*       request_send;
+  Request_t*       request_recv;
+  Bool_t*          is_request_send_set;
+  Bool_t*          is_request_recv_set;
+
+  /*---Aggregated messages, per work unit, axis and direction---*/
+
+  P*               buf_send_agg[2][2];
+  P*               buf_recv_agg[2][2];
+  Request_t*       request_send_agg;
+  Request_t*       request_recv_agg;
+
+  /*---Intra-node transport: per axis, a window holding this proc's
+       mailboxes, and the mailboxes of the downstream neighbors on this
+       node, per direction---*/
+
+  Win_t            shm_win[2];
+  char*            shm_this[2];
+  char*            shm_send[2][2];
+  Bool_t           is_shm_recv[2][2];
+
+  /*---Staging buffers, per axis, laid out as the face buffers, through
+       which work units not contiguous in the faces are communicated---*/
+
+  P*               buf_unit[NDIM];
+
+  /*---Over-decomposition: the place of this subdomain among the subdomains
+       of the proc, and, per axis and direction, whether the neighbor is a
+       subdomain of this proc; faces sent to such a neighbor are copied
+       straight into its face buffers, one pointer per face buffer---*/
+
+  int              nsubdomain_x;
+  int              nsubdomain_y;
+  int              subdomain_x;
+  int              subdomain_y;
+  Bool_t           is_sub_send[2][2];
+  Bool_t           is_sub_recv[2][2];
+  P*               sub_send[2][2][NDIM];
 
   int              noctant_per_block;
+  int              nechunk;
+  int              nangle_set;
 
   Bool_t           is_face_comm_async;
+  Bool_t           is_face_comm_aggregated;
+  Bool_t           is_face_comm_progress;
+  Bool_t           is_face_comm_shm;
 } Faces;
 
 /*===========================================================================*/
@@ -54,13 +96,23 @@ typedef struct
 void Faces_create( Faces*      faces,
                    Dimensions  dims_b,
                    int         noctant_per_block,
+                   int         nechunk,
+                   int         nangle_set,
                    Bool_t      is_face_comm_async,
+                   Bool_t      is_face_comm_aggregated,
+                   Bool_t      is_face_comm_progress,
+                   Bool_t      is_face_comm_shm,
+                   int         nsubdomain_x,
+                   int         nsubdomain_y,
+                   int         subdomain_x,
+                   int         subdomain_y,
                    Env*        env );
 
 /*===========================================================================*/
 /*---Pseudo-destructor for Faces struct---*/
 
-void Faces_destroy( Faces* faces );
+void Faces_destroy( Faces* faces,
+                    Env*   env );
 
 /*===========================================================================*/
 /*---Is face communication done asynchronously---*/
@@ -70,6 +122,83 @@ static int Faces_is_face_comm_async( Faces* faces )
   return faces->is_face_comm_async;
 }
 
+/*===========================================================================*/
+/*---Are the faces sent to a neighbor in a step packed in one message---*/
+
+static int Faces_is_face_comm_aggregated( Faces* faces )
+{
+  return faces->is_face_comm_aggregated;
+}
+
+/*===========================================================================*/
+/*---Is face communication progressed by polling during the sweep---*/
+
+static int Faces_is_face_comm_progress( Faces* faces )
+{
+  return faces->is_face_comm_progress;
+}
+
+/*===========================================================================*/
+/*---Are faces for neighbors on this node passed through shared memory---*/
+
+static int Faces_is_face_comm_shm( Faces* faces )
+{
+  return faces->is_face_comm_shm;
+}
+
+/*===========================================================================*/
+/*---Work units: energy chunks and angle sets---*/
+
+/*---Faces are communicated separately for each work unit, a pair of an
+     energy chunk and a set of angles, so that a unit can be sent as soon
+     as it has been swept.  The angle sets of an energy chunk are
+     consecutive units.
+---*/
+
+static int Faces_nunit( Faces* faces )
+{
+  Assert( faces != NULL );
+  return faces->nechunk * faces->nangle_set;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int Faces_ichunk_unit( Faces* faces, int iunit )
+{
+  Assert( faces != NULL );
+  Assert( iunit >= 0 && iunit < Faces_nunit( faces ) );
+  return iunit / faces->nangle_set;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static int Faces_iangle_set_unit( Faces* faces, int iunit )
+{
+  Assert( faces != NULL );
+  Assert( iunit >= 0 && iunit < Faces_nunit( faces ) );
+  return iunit % faces->nangle_set;
+}
+
+/*---------------------------------------------------------------------------*/
+/*---First energy group of an energy chunk---*/
+
+static int Faces_iemin_chunk( Faces* faces, int ne, int ichunk )
+{
+  Assert( faces != NULL );
+  Assert( ichunk >= 0 && ichunk <= faces->nechunk );
+  return ( ne * ichunk ) / faces->nechunk;
+}
+
+/*---------------------------------------------------------------------------*/
+/*---First angle of an angle set---*/
+
+static int Faces_iamin_set( Faces* faces, int na, int iangle_set )
+{
+  Assert( faces != NULL );
+  Assert( iangle_set >= 0 && iangle_set <= faces->nangle_set );
+  return ( na * iangle_set ) / faces->nangle_set;
+}
+
 /*===========================================================================*/
 /*---Selectors for faces---*/
 
@@ -110,7 +239,17 @@ static Pointer* Faces_faceyz( Faces* faces, int i )
 }
 
 /*---------------------------------------------------------------------------*/
+/*---Index into the circular buffer of xz and yz faces for a step---*/
 
+static int Faces_ibuf_step( Faces* faces, int step )
+{
+  Assert( faces != NULL );
+  Assert( step >= -1 );
+
+  return Faces_is_face_comm_async( faces ) ? (step+3)%3 : 0;
+}
+
+/*---------------------------------------------------------------------------*/
 
 static Pointer* Faces_facexy_step( Faces* faces, int step )
 {
@@ -126,8 +265,7 @@ static Pointer* Faces_facexz_step( Faces* faces, int step )
   Assert( faces != NULL );
   Assert( step >= -1 );
 
-  return Faces_facexz( faces,
-                       Faces_is_face_comm_async( faces ) ? (step+3)%3 : 0 );
+  return Faces_facexz( faces, Faces_ibuf_step( faces, step ) );
 }
 
 /*---------------------------------------------------------------------------*/
@@ -137,59 +275,96 @@ static Pointer* Faces_faceyz_step( Faces* faces, int step )
   Assert( faces != NULL );
   Assert( step >= -1 );
 
-  return Faces_faceyz( faces,
-                       Faces_is_face_comm_async( faces ) ? (step+3)%3 : 0 );
+  return Faces_faceyz( faces, Faces_ibuf_step( faces, step ) );
 }
 
+/*===========================================================================*/
+/*---Connect to the downstream neighbor subdomain on this proc---*/
+
+void Faces_connect_subdomain( Faces* faces,
+                              Faces* faces_downstream,
+                              int    axis,
+                              int    dir_ind );
+
+/*===========================================================================*/
+/*---Does the sweep of a step send any face to another proc---*/
+
+Bool_t Faces_is_send_off_proc(
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  int              step );
+
 /*===========================================================================*/
 /*---Communicate faces computed at step, used at step+1---*/
 
 void Faces_communicate_faces(
-  Faces*          faces,
-  StepScheduler*  stepscheduler,
-  Dimensions      dims_b,
-  int             step,
-  Env*            env );
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env );
+
+/*===========================================================================*/
+/*---Communicate xy faces computed at step, used at step+1---*/
+
+void Faces_communicate_facexy(
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env );
 
 /*===========================================================================*/
 /*---Asynchronously send faces computed at step, used at step+1: start---*/
 
 void Faces_send_faces_start(
-  Faces*          faces,
-  StepScheduler*  stepscheduler,
-  Dimensions      dims_b,
-  int             step,
-  Env*            env );
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env );
 
 /*===========================================================================*/
 /*---Asynchronously send faces computed at step, used at step+1: end---*/
 
 void Faces_send_faces_end(
-  Faces*          faces,
-  StepScheduler*  stepscheduler,
-  Dimensions      dims_b,
-  int             step,
-  Env*            env );
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env );
 
 /*===========================================================================*/
 /*---Asynchronously recv faces computed at step, used at step+1: start---*/
 
 void Faces_recv_faces_start(
-  Faces*          faces,
-  StepScheduler*  stepscheduler,
-  Dimensions      dims_b,
-  int             step,
-  Env*            env );
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env );
 
 /*===========================================================================*/
 /*---Asynchronously recv faces computed at step, used at step+1: end---*/
 
 void Faces_recv_faces_end(
-  Faces*          faces,
-  StepScheduler*  stepscheduler,
-  Dimensions      dims_b,
-  int             step,
-  Env*            env );
+  Faces*           faces,
+  const SweepPlan* sweepplan,
+  Dimensions       dims_b,
+  int              step,
+  int              iunit,
+  Env*             env );
+
+/*===========================================================================*/
+/*---Progress outstanding asynchronous face communication: nonblocking---*/
+
+void Faces_progress( Faces* faces,
+                     Env*   env );
 
 /*===========================================================================*/
 
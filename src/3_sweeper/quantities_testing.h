@@ -74,6 +74,11 @@ static inline P Quantities_init_state(
   Assert( im >= 0 && im < dims.nm );
   Assert( iu >= 0 && iu < NU );
 
+  /*---Energy is the only global extent needed here---*/
+
+  Dimensions dims_g = dims;
+  dims_g.ne = quan->ne_g;
+
   if( Quantities_bc_vacuum() )
   {
     return ((P)0);
@@ -83,8 +88,10 @@ static inline P Quantities_init_state(
     return   ( (P) Quantities_affinefunction_( im ) )
            * ( (P) Quantities_scalefactor_space_( quan,
                                                    ix+quan->ix_base,
-                                                   iy+quan->iy_base, iz ) )
-           * ( (P) Quantities_scalefactor_energy_( ie, dims ) )
+                                                   iy+quan->iy_base,
+                                                   iz+quan->iz_base ) )
+           * ( (P) Quantities_scalefactor_energy_( ie+quan->ie_base,
+                                                    dims_g ) )
            * ( (P) Quantities_scalefactor_unknown_( iu ) );
   }
 }
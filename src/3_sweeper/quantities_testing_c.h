@@ -211,14 +211,17 @@ void Quantities_init_decomp_( Quantities*       quan,
 
   int i  = 0;
 
-  /*---Record z dimension---*/
-
-  quan->ncell_z_g = dims.ncell_z;
+  const int proc_x_this = Env_proc_x_this( env );
+  const int proc_y_this = Env_proc_y_this( env );
+  const int proc_z_this = Env_proc_z_this( env );
+  const int proc_e_this = Env_proc_e_this( env );
 
   /*---Allocate arrays---*/
 
   quan->ix_base_vals = malloc_host_int( Env_nproc_x( env ) + 1 );
   quan->iy_base_vals = malloc_host_int( Env_nproc_y( env ) + 1 );
+  quan->iz_base_vals = malloc_host_int( Env_nproc_z( env ) + 1 );
+  quan->ie_base_vals = malloc_host_int( Env_nproc_e( env ) + 1 );
 
   /*---------------------------------*/
   /*---Set entries of ix_base_vals---*/
@@ -226,38 +229,38 @@ void Quantities_init_decomp_( Quantities*       quan,
 
   /*---Collect values to base proc along axis---*/
 
-  if( Env_proc_x_this( env ) == 0 )
+  if( proc_x_this == 0 )
   {
     int proc_x = 0;
     quan->ix_base_vals[ 1+0 ] = dims.ncell_x;
     for( proc_x=1; proc_x<Env_nproc_x( env ); ++proc_x )
     {
       Env_recv_i( env, & quan->ix_base_vals[ 1+proc_x ], 1,
-        Env_proc( env, proc_x, Env_proc_y_this( env ) ), Env_tag( env ) );
+        Env_proc( env, proc_x, proc_y_this, proc_z_this ), Env_tag( env ) );
     }
   }
   else
   {
     Env_send_i( env, & dims.ncell_x, 1,
-             Env_proc( env, 0, Env_proc_y_this( env ) ), Env_tag( env ) );
+             Env_proc( env, 0, proc_y_this, proc_z_this ), Env_tag( env ) );
   }
   Env_increment_tag( env, 1 );
 
   /*---Broadcast collected array to all other procs along axis---*/
 
-  if( Env_proc_x_this( env ) == 0 )
+  if( proc_x_this == 0 )
   {
     int proc_x = 0;
     for( proc_x=1; proc_x<Env_nproc_x( env ); ++proc_x )
     {
       Env_send_i( env, & quan->ix_base_vals[ 1 ], Env_nproc_x( env ),
-        Env_proc( env, proc_x, Env_proc_y_this( env ) ), Env_tag( env ) );
+        Env_proc( env, proc_x, proc_y_this, proc_z_this ), Env_tag( env ) );
     }
   }
   else
   {
     Env_recv_i( env, & quan->ix_base_vals[ 1 ], Env_nproc_x( env ),
-             Env_proc( env, 0, Env_proc_y_this( env ) ), Env_tag( env ) );
+             Env_proc( env, 0, proc_y_this, proc_z_this ), Env_tag( env ) );
   }
   Env_increment_tag( env, 1 );
 
@@ -269,11 +272,11 @@ void Quantities_init_decomp_( Quantities*       quan,
     quan->ix_base_vals[1+i] += quan->ix_base_vals[i];
   }
 
-  quan->ix_base   = quan->ix_base_vals[ Env_proc_x_this( env ) ];
-  quan->ncell_x_g = quan->ix_base_vals[ Env_nproc_x(     env ) ];
+  quan->ix_base   = quan->ix_base_vals[ proc_x_this ];
+  quan->ncell_x_g = quan->ix_base_vals[ Env_nproc_x( env ) ];
 
-  Assert( quan->ix_base_vals[ Env_proc_x_this( env )+1 ] -
-          quan->ix_base_vals[ Env_proc_x_this( env )   ] == dims.ncell_x );
+  Assert( quan->ix_base_vals[ proc_x_this+1 ] -
+          quan->ix_base_vals[ proc_x_this   ] == dims.ncell_x );
 
   /*---------------------------------*/
   /*---Set entries of iy_base_vals---*/
@@ -281,38 +284,38 @@ void Quantities_init_decomp_( Quantities*       quan,
 
   /*---Collect values to base proc along axis---*/
 
-  if( Env_proc_y_this( env ) == 0 )
+  if( proc_y_this == 0 )
   {
     int proc_y = 0;
     quan->iy_base_vals[ 1+0 ] = dims.ncell_y;
     for( proc_y=1; proc_y<Env_nproc_y( env ); ++proc_y )
     {
       Env_recv_i( env, & quan->iy_base_vals[ 1+proc_y ], 1,
-        Env_proc( env, Env_proc_x_this( env ), proc_y ), Env_tag( env ) );
+        Env_proc( env, proc_x_this, proc_y, proc_z_this ), Env_tag( env ) );
     }
   }
   else
   {
     Env_send_i( env, & dims.ncell_y, 1,
-             Env_proc( env, Env_proc_x_this( env ), 0 ), Env_tag( env ) );
+             Env_proc( env, proc_x_this, 0, proc_z_this ), Env_tag( env ) );
   }
   Env_increment_tag( env, 1 );
 
   /*---Broadcast collected array to all other procs along axis---*/
 
-  if( Env_proc_y_this( env ) == 0 )
+  if( proc_y_this == 0 )
   {
     int proc_y = 0;
     for( proc_y=1; proc_y<Env_nproc_y( env ); ++proc_y )
     {
       Env_send_i( env, & quan->iy_base_vals[ 1 ], Env_nproc_y( env ),
-        Env_proc( env, Env_proc_x_this( env ), proc_y ), Env_tag( env ) );
+        Env_proc( env, proc_x_this, proc_y, proc_z_this ), Env_tag( env ) );
     }
   }
   else
   {
     Env_recv_i( env, & quan->iy_base_vals[ 1 ], Env_nproc_y( env ),
-             Env_proc( env, Env_proc_x_this( env ), 0 ), Env_tag( env ) );
+             Env_proc( env, proc_x_this, 0, proc_z_this ), Env_tag( env ) );
   }
   Env_increment_tag( env, 1 );
 
@@ -324,11 +327,94 @@ void Quantities_init_decomp_( Quantities*       quan,
     quan->iy_base_vals[1+i] += quan->iy_base_vals[i];
   }
 
-  quan->iy_base   = quan->iy_base_vals[ Env_proc_y_this( env ) ];
-  quan->ncell_y_g = quan->iy_base_vals[ Env_nproc_y(     env ) ];
+  quan->iy_base   = quan->iy_base_vals[ proc_y_this ];
+  quan->ncell_y_g = quan->iy_base_vals[ Env_nproc_y( env ) ];
+
+  Assert( quan->iy_base_vals[ proc_y_this+1 ] -
+          quan->iy_base_vals[ proc_y_this   ] == dims.ncell_y );
+
+  /*---------------------------------*/
+  /*---Set entries of iz_base_vals---*/
+  /*---------------------------------*/
+
+  /*---Collect values to base proc along axis---*/
+
+  if( proc_z_this == 0 )
+  {
+    int proc_z = 0;
+    quan->iz_base_vals[ 1+0 ] = dims.ncell_z;
+    for( proc_z=1; proc_z<Env_nproc_z( env ); ++proc_z )
+    {
+      Env_recv_i( env, & quan->iz_base_vals[ 1+proc_z ], 1,
+        Env_proc( env, proc_x_this, proc_y_this, proc_z ), Env_tag( env ) );
+    }
+  }
+  else
+  {
+    Env_send_i( env, & dims.ncell_z, 1,
+             Env_proc( env, proc_x_this, proc_y_this, 0 ), Env_tag( env ) );
+  }
+  Env_increment_tag( env, 1 );
+
+  /*---Broadcast collected array to all other procs along axis---*/
+
+  if( proc_z_this == 0 )
+  {
+    int proc_z = 0;
+    for( proc_z=1; proc_z<Env_nproc_z( env ); ++proc_z )
+    {
+      Env_send_i( env, & quan->iz_base_vals[ 1 ], Env_nproc_z( env ),
+        Env_proc( env, proc_x_this, proc_y_this, proc_z ), Env_tag( env ) );
+    }
+  }
+  else
+  {
+    Env_recv_i( env, & quan->iz_base_vals[ 1 ], Env_nproc_z( env ),
+             Env_proc( env, proc_x_this, proc_y_this, 0 ), Env_tag( env ) );
+  }
+  Env_increment_tag( env, 1 );
+
+  /*---Scan sum---*/
+
+  quan->iz_base_vals[0] = 0;
+  for( i=0; i<Env_nproc_z( env ); ++i )
+  {
+    quan->iz_base_vals[1+i] += quan->iz_base_vals[i];
+  }
+
+  quan->iz_base   = quan->iz_base_vals[ proc_z_this ];
+  quan->ncell_z_g = quan->iz_base_vals[ Env_nproc_z( env ) ];
+
+  Assert( quan->iz_base_vals[ proc_z_this+1 ] -
+          quan->iz_base_vals[ proc_z_this   ] == dims.ncell_z );
+
+  /*---------------------------------*/
+  /*---Set entries of ie_base_vals---*/
+  /*---------------------------------*/
+
+  /*---Energy slices do not share a point-to-point communicator, so sum
+       over all procs; every proc of a slice contributes the same value---*/
+
+  for( i=0; i<Env_nproc_e( env ); ++i )
+  {
+    const double nproc_per_slice = Env_nproc( env ) / Env_nproc_e( env );
+    quan->ie_base_vals[1+i] = (int)( Env_sum_d( env,
+                 i == proc_e_this ? dims.ne : 0 ) / nproc_per_slice + .5 );
+  }
+
+  /*---Scan sum---*/
+
+  quan->ie_base_vals[0] = 0;
+  for( i=0; i<Env_nproc_e( env ); ++i )
+  {
+    quan->ie_base_vals[1+i] += quan->ie_base_vals[i];
+  }
+
+  quan->ie_base = quan->ie_base_vals[ proc_e_this ];
+  quan->ne_g    = quan->ie_base_vals[ Env_nproc_e( env ) ];
 
-  Assert( quan->iy_base_vals[ Env_proc_y_this( env )+1 ] -
-          quan->iy_base_vals[ Env_proc_y_this( env )   ] == dims.ncell_y );
+  Assert( quan->ie_base_vals[ proc_e_this+1 ] -
+          quan->ie_base_vals[ proc_e_this   ] == dims.ne );
 
 } /*---Quantities_init_decomp_---*/
 
@@ -344,9 +430,13 @@ void Quantities_destroy( Quantities* quan )
 
   free_host_int( quan->ix_base_vals );
   free_host_int( quan->iy_base_vals );
+  free_host_int( quan->iz_base_vals );
+  free_host_int( quan->ie_base_vals );
 
   quan->ix_base_vals = NULL;
   quan->iy_base_vals = NULL;
+  quan->iz_base_vals = NULL;
+  quan->ie_base_vals = NULL;
 
 } /*---Quantities_destroy---*/
 
@@ -12,6 +12,7 @@
 #define _quantities_testing_kernels_h_
 
 #include "types_kernels.h"
+#include "env_kernels.h"
 #include "dimensions_kernels.h"
 #include "array_accessors_kernels.h"
 #include "pointer_kernels.h"
@@ -38,11 +39,16 @@ typedef struct
   Pointer  m_from_a;
   int*     ix_base_vals;
   int*     iy_base_vals;
+  int*     iz_base_vals;
+  int*     ie_base_vals;
   int      ix_base;
   int      iy_base;
+  int      iz_base;
+  int      ie_base;
   int      ncell_x_g;
   int      ncell_y_g;
   int      ncell_z_g;
+  int      ne_g;
 } Quantities;
 
 /*===========================================================================*/
@@ -446,6 +452,131 @@ TARGET_HD static inline void Quantities_solve(
   }
 } /*---Quantities_solve---*/
 
+#ifdef USE_SIMD
+
+/*===========================================================================*/
+/*---Perform equation solve at a cell for SIMD_LEN consecutive angles---*/
+
+/*---NOTE: the arithmetic matches Quantities_solve operation for operation,
+     so each angle gives bitwise the same result.  The caller must ensure
+     all angles ia ... ia+SIMD_LEN-1 are valid and the cell is active.
+---*/
+
+static inline void Quantities_solve_simd(
+  const Quantities* const  quan,
+  P* const __restrict__ vslocal,
+  const int             ia,
+  const int             iaind,
+  const int             iamax,
+  P* const __restrict__ facexy,
+  P* const __restrict__ facexz,
+  P* const __restrict__ faceyz,
+  const int             ix_b,
+  const int             iy_b,
+  const int             iz_b,
+  const int             ie,
+  const int             ix_g,
+  const int             iy_g,
+  const int             iz_g,
+  const int             octant,
+  const int             octant_in_block,
+  const int             noctant_per_block,
+  const Dimensions      dims_b,
+  const Dimensions      dims_g )
+{
+  Assert( vslocal );
+  Assert( ia >= 0 && ia+SIMD_LEN <= dims_b.na );
+  Assert( iaind >= 0 && iaind+SIMD_LEN <= iamax );
+  Assert( facexy );
+  Assert( facexz );
+  Assert( faceyz );
+  Assert( ix_b >= 0 && ix_b < dims_b.ncell_x );
+  Assert( iy_b >= 0 && iy_b < dims_b.ncell_y );
+  Assert( iz_b >= 0 && iz_b < dims_b.ncell_z );
+  Assert( ie   >= 0 && ie   < dims_b.ne );
+  Assert( octant >= 0 && octant < NOCTANT );
+  Assert( octant_in_block >= 0 && octant_in_block < noctant_per_block );
+
+  const int dir_x = Dir_x( octant );
+  const int dir_y = Dir_y( octant );
+  const int dir_z = Dir_z( octant );
+
+  int iu = 0;
+  int i = 0;
+
+  const P scalefactor_octant = Quantities_scalefactor_octant_( octant );
+  const P scalefactor_octant_r = ((P)1) / scalefactor_octant;
+  const P scalefactor_space
+                  = Quantities_scalefactor_space_( quan, ix_g, iy_g, iz_g );
+  const P scalefactor_space_r = ((P)1) / scalefactor_space;
+  const P scalefactor_space_x_r = ((P)1) /
+     Quantities_scalefactor_space_( quan, ix_g-Dir_inc(dir_x), iy_g, iz_g );
+  const P scalefactor_space_y_r = ((P)1) /
+     Quantities_scalefactor_space_( quan, ix_g, iy_g-Dir_inc(dir_y), iz_g );
+  const P scalefactor_space_z_r = ((P)1) /
+     Quantities_scalefactor_space_( quan, ix_g, iy_g, iz_g-Dir_inc(dir_z) );
+
+  /*---Weights that vary by angle are gathered into a vector---*/
+
+  P zfluxweight[SIMD_LEN];
+  for( i=0; i<SIMD_LEN; ++i )
+  {
+    zfluxweight[i] = Quantities_zfluxweight_( dims_g, ia+i );
+  }
+
+  const VecP v_scalefactor_octant   = VecP_broadcast( scalefactor_octant );
+  const VecP v_scalefactor_octant_r = VecP_broadcast( scalefactor_octant_r );
+  const VecP v_scalefactor_space    = VecP_broadcast( scalefactor_space );
+  const VecP v_scalefactor_space_r  = VecP_broadcast( scalefactor_space_r );
+  const VecP v_scalefactor_space_x_r
+                                  = VecP_broadcast( scalefactor_space_x_r );
+  const VecP v_scalefactor_space_y_r
+                                  = VecP_broadcast( scalefactor_space_y_r );
+  const VecP v_scalefactor_space_z_r
+                                  = VecP_broadcast( scalefactor_space_z_r );
+  const VecP v_xfluxweight
+                    = VecP_broadcast( Quantities_xfluxweight_( dims_g, ia ) );
+  const VecP v_yfluxweight
+                    = VecP_broadcast( Quantities_yfluxweight_( dims_g, ia ) );
+  const VecP v_zfluxweight = VecP_load( zfluxweight );
+
+  for( iu=0; iu<NU; ++iu )
+  {
+    P* const __restrict__ vslocal_this
+                      = ref_vslocal( vslocal, dims_b, NU, iamax, iaind, iu );
+    P* const __restrict__ facexy_this
+                      = ref_facexy( facexy, dims_b, NU, noctant_per_block,
+                                    ix_b, iy_b, ie, ia, iu, octant_in_block );
+    P* const __restrict__ facexz_this
+                      = ref_facexz( facexz, dims_b, NU, noctant_per_block,
+                                    ix_b, iz_b, ie, ia, iu, octant_in_block );
+    P* const __restrict__ faceyz_this
+                      = ref_faceyz( faceyz, dims_b, NU, noctant_per_block,
+                                    iy_b, iz_b, ie, ia, iu, octant_in_block );
+
+    const VecP result = ( VecP_load( vslocal_this ) * v_scalefactor_space_r + (
+        VecP_load( facexy_this )
+         * v_xfluxweight
+         * v_scalefactor_space_z_r
+      + VecP_load( facexz_this )
+         * v_yfluxweight
+         * v_scalefactor_space_y_r
+      + VecP_load( faceyz_this )
+         * v_zfluxweight
+         * v_scalefactor_space_x_r
+    ) * v_scalefactor_octant_r ) * v_scalefactor_space;
+
+    VecP_store( vslocal_this, result );
+    const VecP result_scaled = result * v_scalefactor_octant;
+    VecP_store( facexy_this, result_scaled );
+    VecP_store( facexz_this, result_scaled );
+    VecP_store( faceyz_this, result_scaled );
+  } /*---for---*/
+
+} /*---Quantities_solve_simd---*/
+
+#endif /*---USE_SIMD---*/
+
 /*===========================================================================*/
 
 #ifdef __cplusplus
@@ -33,14 +33,46 @@ StepScheduler StepScheduler_null()
 void StepScheduler_create( StepScheduler* stepscheduler,
                            int             nblock_z,
                            int             nblock_octant,
+                           int             nsubdomain_x,
+                           int             nsubdomain_y,
+                           int             subdomain_x,
+                           int             subdomain_y,
+                           Bool_t          is_mirrored,
                            Env*            env )
 {
   Insist( nblock_z > 0 ? "Invalid z blocking factor supplied." : 0 );
+  Assert( subdomain_x >= 0 && subdomain_x < nsubdomain_x );
+  Assert( subdomain_y >= 0 && subdomain_y < nsubdomain_y );
   stepscheduler->nblock_z_          = nblock_z;
-  stepscheduler->nproc_x_           = Env_nproc_x( env );
-  stepscheduler->nproc_y_           = Env_nproc_y( env );
-  stepscheduler->nblock_octant_     = nblock_octant;
-  stepscheduler->noctant_per_block_ = NOCTANT / nblock_octant;
+  stepscheduler->nproc_x_           = Env_nproc_x( env ) * nsubdomain_x;
+  stepscheduler->nproc_y_           = Env_nproc_y( env ) * nsubdomain_y;
+  stepscheduler->nproc_z_           = Env_nproc_z( env );
+  stepscheduler->proc_x_            = Env_proc_x_this( env ) * nsubdomain_x
+                                                             + subdomain_x;
+  stepscheduler->proc_y_            = Env_proc_y_this( env ) * nsubdomain_y
+                                                             + subdomain_y;
+
+  /*---Each angle group is given its own octants in the block of
+       octants; the schedule is that of all groups together, and this
+       proc executes only its group's part of it---*/
+
+  Insist( nblock_octant % Env_nproc_a( env ) == 0 ?
+          "Too many angle groups for this number of octant threads." : 0 );
+  stepscheduler->nproc_a_           = Env_nproc_a( env );
+  stepscheduler->proc_a_            = Env_proc_a_this( env );
+  stepscheduler->nblock_octant_     = nblock_octant / Env_nproc_a( env );
+  stepscheduler->noctant_per_block_ = NOCTANT / stepscheduler->nblock_octant_;
+
+  /*---The mirrored schedule reflects the octants of the block sequence
+       (see StepScheduler_stepinfo) so the sequence runs backwards; the
+       direction bits of the octants within a block are left alone---*/
+
+  Insist( ! is_mirrored || Env_nproc_a( env ) == 1 ?
+          "Mirrored schedule not allowed with angle groups." : 0 );
+  stepscheduler->octant_mirror_ = ! is_mirrored ? 0 :
+                                  stepscheduler->nblock_octant_ == 8 ? 5 :
+                                  stepscheduler->nblock_octant_ == 4 ? 6 :
+                                  stepscheduler->nblock_octant_ == 2 ? 4 : 0;
 }
 
 /*===========================================================================*/
@@ -58,20 +90,53 @@ int StepScheduler_nblock_z( const StepScheduler* stepscheduler )
   return stepscheduler->nblock_z_;
 }
 
+/*===========================================================================*/
+/*---Accessors: place of this subdomain in the grid of subdomains---*/
+
+int StepScheduler_nproc_x( const StepScheduler* stepscheduler )
+{
+  return stepscheduler->nproc_x_;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int StepScheduler_nproc_y( const StepScheduler* stepscheduler )
+{
+  return stepscheduler->nproc_y_;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int StepScheduler_proc_x( const StepScheduler* stepscheduler )
+{
+  return stepscheduler->proc_x_;
+}
+
+/*---------------------------------------------------------------------------*/
+
+int StepScheduler_proc_y( const StepScheduler* stepscheduler )
+{
+  return stepscheduler->proc_y_;
+}
+
 /*===========================================================================*/
 /*---Number of block steps executed for a single octant in isolation---*/
 
+/*---When z is decomposed, the z blocks of all procs along z form one
+     chain, which the wavefront traverses as on a single proc.
+---*/
+
 int StepScheduler_nblock( const StepScheduler* stepscheduler )
 {
-  return stepscheduler->nblock_z_;
+  return stepscheduler->nblock_z_ * stepscheduler->nproc_z_;
 }
 
 /*===========================================================================*/
-/*---Number of octants per octant block---*/
+/*---Number of octants per octant block executed by this proc---*/
 
 int StepScheduler_noctant_per_block( const StepScheduler* stepscheduler )
 {
-  return NOCTANT / stepscheduler->nblock_octant_;
+  return stepscheduler->noctant_per_block_ / stepscheduler->nproc_a_;
 }
 
 /*===========================================================================*/
@@ -116,22 +181,32 @@ int StepScheduler_nstep( const StepScheduler* stepscheduler )
 }
 
 /*===========================================================================*/
-/*---Get information describing a sweep step---*/
+/*---Get information describing a sweep step, unmirrored schedule---*/
+/*---pseudo-private member function---*/
 
-StepInfo StepScheduler_stepinfo( const StepScheduler* stepscheduler,  
+static StepInfo StepScheduler_stepinfo_unmirrored_(
+                                 const StepScheduler* stepscheduler,
                                  const int            step,
                                  const int            octant_in_block,
                                  const int            proc_x,
-                                 const int            proc_y )
+                                 const int            proc_y,
+                                 const int            proc_z )
 {
   Assert( octant_in_block>=0 &&
-          octant_in_block * stepscheduler->nblock_octant_ < NOCTANT );
+          octant_in_block < StepScheduler_noctant_per_block( stepscheduler ) );
+
+  /*---Position of the octant in the schedule of all angle groups---*/
+
+  const int octant_in_block_g = octant_in_block + stepscheduler->proc_a_ *
+                             StepScheduler_noctant_per_block( stepscheduler );
 
   /*
   const int nblock_octant     = stepscheduler->nblock_octant_;
   */
   const int nproc_x           = stepscheduler->nproc_x_;
   const int nproc_y           = stepscheduler->nproc_y_;
+  const int nproc_z           = stepscheduler->nproc_z_;
+  const int nblock_z          = stepscheduler->nblock_z_;
   const int nblock            = StepScheduler_nblock( stepscheduler );
   const int nstep             = StepScheduler_nstep( stepscheduler );
   const int noctant_per_block = stepscheduler->noctant_per_block_;
@@ -158,11 +233,11 @@ StepInfo StepScheduler_stepinfo( const StepScheduler* stepscheduler,
   const Bool_t is_folded_y = noctant_per_block >= 4;
   const Bool_t is_folded_z = noctant_per_block >= 8;
 
-  const int folded_proc_x = ( is_folded_x && ( octant_in_block & (1<<0) ) )
+  const int folded_proc_x = ( is_folded_x && ( octant_in_block_g & (1<<0) ) )
                           ?  ( nproc_x - 1 - proc_x )
                           :                  proc_x;
 
-  const int folded_proc_y = ( is_folded_y && ( octant_in_block & (1<<1) ) )
+  const int folded_proc_y = ( is_folded_y && ( octant_in_block_g & (1<<1) ) )
                           ?  ( nproc_y - 1 - proc_y )
                           :                  proc_y;
 
@@ -242,7 +317,7 @@ StepInfo StepScheduler_stepinfo( const StepScheduler* stepscheduler,
 
   folded_octant = octant_selector[ octant_key ];
 
-  octant = folded_octant + octant_in_block;
+  octant = folded_octant + octant_in_block_g;
 
   /*---Next convert the wavefront number to a block number based on
        location in the domain.  Use the equation that defines the plane.
@@ -262,18 +337,23 @@ StepInfo StepScheduler_stepinfo( const StepScheduler* stepscheduler,
                         - ( start_y + folded_proc_y * dir_y )
                         - ( start_z ) ) / dir_z;
 
-  block = ( is_folded_z && ( octant_in_block & (1<<2) ) )
+  block = ( is_folded_z && ( octant_in_block_g & (1<<2) ) )
                           ? ( nblock - 1 - folded_block )
                           : folded_block;
 
+  /*---Convert to the numbering of the blocks on this proc along z---*/
+
+  block -= proc_z * nblock_z;
+
   /*---Now determine whether the block calculation is active based on whether
        the block in question falls within the physical domain.
   ---*/
 
-  stepinfo.is_active = block  >= 0 && block  < nblock &&
+  stepinfo.is_active = block  >= 0 && block  < nblock_z &&
                        step   >= 0 && step   < nstep &&
                        proc_x >= 0 && proc_x < nproc_x &&
-                       proc_y >= 0 && proc_y < nproc_y;
+                       proc_y >= 0 && proc_y < nproc_y &&
+                       proc_z >= 0 && proc_z < nproc_z;
 
   /*---Set remaining values---*/
 
@@ -283,6 +363,37 @@ StepInfo StepScheduler_stepinfo( const StepScheduler* stepscheduler,
   return stepinfo;
 }
 
+/*===========================================================================*/
+/*---Get information describing a sweep step---*/
+
+/*---The mirrored schedule is the unmirrored one seen through a reflection
+     of the domain along the axes of octant_mirror_: the octant swept by
+     a block at a step is that of the reflected block, reflected---*/
+
+StepInfo StepScheduler_stepinfo( const StepScheduler* stepscheduler,
+                                 const int            step,
+                                 const int            octant_in_block,
+                                 const int            proc_x,
+                                 const int            proc_y,
+                                 const int            proc_z )
+{
+  const int mirror = stepscheduler->octant_mirror_;
+
+  StepInfo stepinfo = StepScheduler_stepinfo_unmirrored_( stepscheduler,
+    step, octant_in_block,
+    mirror & (1<<0) ? stepscheduler->nproc_x_ - 1 - proc_x : proc_x,
+    mirror & (1<<1) ? stepscheduler->nproc_y_ - 1 - proc_y : proc_y,
+    mirror & (1<<2) ? stepscheduler->nproc_z_ - 1 - proc_z : proc_z );
+
+  if( mirror & (1<<2) && stepinfo.is_active )
+  {
+    stepinfo.block_z = stepscheduler->nblock_z_ - 1 - stepinfo.block_z;
+  }
+  stepinfo.octant ^= mirror;
+
+  return stepinfo;
+}
+
 /*===========================================================================*/
 /*---Determine whether to send a face computed at step, used at step+1---*/
 
@@ -294,35 +405,46 @@ Bool_t StepScheduler_must_do_send(
   int            octant_in_block,
   Env*           env )
 {
-  const int proc_x = Env_proc_x_this( env );
-  const int proc_y = Env_proc_y_this( env );
+  const int proc_x = stepscheduler->proc_x_;
+  const int proc_y = stepscheduler->proc_y_;
+  const int proc_z = Env_proc_z_this( env );
+
+  const int nblock_z = stepscheduler->nblock_z_;
 
   const Bool_t axis_x = axis==0;
   const Bool_t axis_y = axis==1;
+  const Bool_t axis_z = axis==2;
 
   const int dir = dir_ind==0 ? (int)DIR_UP : (int)DIR_DN;
   const int inc_x = axis_x ? Dir_inc( dir ) : 0;
   const int inc_y = axis_y ? Dir_inc( dir ) : 0;
+  const int inc_z = axis_z ? Dir_inc( dir ) : 0;
 
   /*---Get step info for processors involved in communication---*/
 
   const StepInfo stepinfo_send_source_step = StepScheduler_stepinfo(
-    stepscheduler, step,   octant_in_block, proc_x,       proc_y       );
+    stepscheduler, step,   octant_in_block, proc_x,       proc_y,
+                                            proc_z );
 
   const StepInfo stepinfo_send_target_step = StepScheduler_stepinfo(
-    stepscheduler, step+1, octant_in_block, proc_x+inc_x, proc_y+inc_y );
+    stepscheduler, step+1, octant_in_block, proc_x+inc_x, proc_y+inc_y,
+                                            proc_z+inc_z );
 
   /*---Determine whether to communicate---*/
+  /*---Along z the target block is the next one of the z block chain,
+       the first block on the target proc---*/
 
   Bool_t const do_send = stepinfo_send_source_step.is_active
                       && stepinfo_send_target_step.is_active
                       && stepinfo_send_source_step.octant ==
                          stepinfo_send_target_step.octant
-                      && stepinfo_send_source_step.block_z ==
-                         stepinfo_send_target_step.block_z
+                      && stepinfo_send_source_step.block_z + inc_z ==
+                         stepinfo_send_target_step.block_z + nblock_z * inc_z
                       && ( axis_x ?
                            Dir_x( stepinfo_send_target_step.octant ) :
-                           Dir_y( stepinfo_send_target_step.octant ) ) == dir;
+                           axis_y ?
+                           Dir_y( stepinfo_send_target_step.octant ) :
+                           Dir_z( stepinfo_send_target_step.octant ) ) == dir;
 
   return do_send;
 }
@@ -338,23 +460,30 @@ Bool_t StepScheduler_must_do_recv(
   int            octant_in_block,
   Env*           env )
 {
-  const int proc_x = Env_proc_x_this( env );
-  const int proc_y = Env_proc_y_this( env );
+  const int proc_x = stepscheduler->proc_x_;
+  const int proc_y = stepscheduler->proc_y_;
+  const int proc_z = Env_proc_z_this( env );
+
+  const int nblock_z = stepscheduler->nblock_z_;
 
   const Bool_t axis_x = axis==0;
   const Bool_t axis_y = axis==1;
+  const Bool_t axis_z = axis==2;
 
   const int dir = dir_ind==0 ? (int)DIR_UP : (int)DIR_DN;
   const int inc_x = axis_x ? Dir_inc( dir ) : 0;
   const int inc_y = axis_y ? Dir_inc( dir ) : 0;
+  const int inc_z = axis_z ? Dir_inc( dir ) : 0;
 
   /*---Get step info for processors involved in communication---*/
 
   const StepInfo stepinfo_recv_source_step = StepScheduler_stepinfo(
-    stepscheduler, step,   octant_in_block, proc_x-inc_x, proc_y-inc_y );
+    stepscheduler, step,   octant_in_block, proc_x-inc_x, proc_y-inc_y,
+                                            proc_z-inc_z );
 
   const StepInfo stepinfo_recv_target_step = StepScheduler_stepinfo(
-    stepscheduler, step+1, octant_in_block, proc_x,       proc_y       );
+    stepscheduler, step+1, octant_in_block, proc_x,       proc_y,
+                                            proc_z );
 
   /*---Determine whether to communicate---*/
 
@@ -362,11 +491,13 @@ Bool_t StepScheduler_must_do_recv(
                       && stepinfo_recv_target_step.is_active
                       && stepinfo_recv_source_step.octant ==
                          stepinfo_recv_target_step.octant
-                      && stepinfo_recv_source_step.block_z ==
-                         stepinfo_recv_target_step.block_z
+                      && stepinfo_recv_source_step.block_z + inc_z ==
+                         stepinfo_recv_target_step.block_z + nblock_z * inc_z
                       && ( axis_x ?
                            Dir_x( stepinfo_recv_target_step.octant ) :
-                           Dir_y( stepinfo_recv_target_step.octant ) ) == dir;
+                           axis_y ?
+                           Dir_y( stepinfo_recv_target_step.octant ) :
+                           Dir_z( stepinfo_recv_target_step.octant ) ) == dir;
 
   return do_recv;
 }
@@ -20,16 +20,38 @@ extern "C"
 {
 #endif
 
+/*===========================================================================*/
+/*---Enums---*/
+
+/*---Sweep schedules: octant blocks swept one after another, or all octants
+     swept at once, from all corners---*/
+
+enum{ SCHEDULE_KBA = 0, SCHEDULE_ALL_OCTANT = 1 };
+
 /*===========================================================================*/
 /*---Struct with info to define the sweep step schedule---*/
 
+/*---With over-decomposition each proc holds several subdomains, and the
+     schedule is that of the grid of subdomains over all procs; proc_x_ and
+     proc_y_ give the place of the sweeper's subdomain in that grid.
+     A mirrored schedule is the reflection of the usual one that sweeps
+     the octant blocks in reverse order; octant_mirror_ holds the
+     direction bits it flips.
+---*/
+
 typedef struct
 {
   int nblock_z_;
   int nproc_x_;
   int nproc_y_;
+  int nproc_z_;
+  int proc_x_;
+  int proc_y_;
+  int nproc_a_;
+  int proc_a_;
   int nblock_octant_;
   int noctant_per_block_;
+  int octant_mirror_;
 } StepScheduler;
 
 /*===========================================================================*/
@@ -43,6 +65,11 @@ StepScheduler StepScheduler_null(void);
 void StepScheduler_create( StepScheduler* stepscheduler,
                            int            nblock_z,
                            int            nblock_octant,
+                           int            nsubdomain_x,
+                           int            nsubdomain_y,
+                           int            subdomain_x,
+                           int            subdomain_y,
+                           Bool_t         is_mirrored,
                            Env*           env );
 
 /*===========================================================================*/
@@ -55,6 +82,17 @@ void StepScheduler_destroy( StepScheduler* stepscheduler );
 
 int StepScheduler_nblock_z( const StepScheduler* stepscheduler );
 
+/*===========================================================================*/
+/*---Accessors: place of this subdomain in the grid of subdomains---*/
+
+int StepScheduler_nproc_x( const StepScheduler* stepscheduler );
+
+int StepScheduler_nproc_y( const StepScheduler* stepscheduler );
+
+int StepScheduler_proc_x( const StepScheduler* stepscheduler );
+
+int StepScheduler_proc_y( const StepScheduler* stepscheduler );
+
 /*===========================================================================*/
 /*---Number of block steps executed for a single octant in isolation---*/
 
@@ -77,7 +115,8 @@ StepInfo StepScheduler_stepinfo( const StepScheduler* stepscheduler,
                                  const int            step,
                                  const int            octant_in_block,
                                  const int            proc_x,
-                                 const int            proc_y );
+                                 const int            proc_y,
+                                 const int            proc_z );
 
 /*===========================================================================*/
 /*---Determine whether to send a face computed at step, used at step+1---*/
@@ -19,6 +19,7 @@
 #include "pointer.h"
 #include "quantities.h"
 #include "stepscheduler_kba.h"
+#include "sweepplan_kba.h"
 #include "faces_kba.h"
 
 #include "sweeper_kba_kernels.h"
@@ -29,13 +30,27 @@ extern "C"
 #endif
 
 /*===========================================================================*/
-/*---Struct with pointers etc. used to perform sweep---*/
+/*---Context for progressing face communication from within the sweep---*/
 
 typedef struct
+{
+  Faces*            faces;
+  Env*              env;
+#ifdef USE_OPENMP_WORKSTEAL
+  const TaskRunner* taskrunner;
+#endif
+} SweeperProgress;
+
+/*===========================================================================*/
+/*---Struct with pointers etc. used to perform sweep---*/
+
+typedef struct Sweeper_
 {
   P* __restrict__  vilocal_host_;
   P* __restrict__  vslocal_host_;
   P* __restrict__  volocal_host_;
+  P* __restrict__  vo_private_host_;
+  int*             sync_counter_host_;
 
   Dimensions       dims;
   Dimensions       dims_b;
@@ -54,10 +69,45 @@ typedef struct
   int              ncell_x_per_subblock;
   int              ncell_y_per_subblock;
   int              ncell_z_per_subblock;
+  int              ne_per_batch;
+  int              nechunk;
+  int              nangle_set;
+  Bool_t           is_vo_private;
+  Bool_t           is_numa_placement;
 
   StepScheduler    stepscheduler;
+  SweepPlan        sweepplan;
+#ifdef USE_OPENMP_WORKSTEAL
+  /*---The worker team is shared by the subdomains and the mirror sweeper,
+       which are never swept at the same time---*/
+  TaskGraph        taskgraph;
+  TaskRunner*      taskrunner;
+#endif
 
   Faces            faces;
+
+  /*---Over-decomposition: the subdomains of this proc, each swept by a
+       sweeper of its own, or NULL.  The state vectors, of dimensions
+       dims_v, are those of the proc's block, and a subdomain sweeps the
+       part of them starting at its base cell.  The contexts for sweeping
+       each subdomain are kept by the parent---*/
+
+  int              nsubdomain_x;
+  int              nsubdomain_y;
+  struct Sweeper_* subdomain;
+  Dimensions       dims_v;
+  int              ix_base_subdomain;
+  int              iy_base_subdomain;
+  Quantities*      quan_subdomain;
+  SweeperLite*     sweeperlite_subdomain;
+  SweeperProgress* progress_subdomain;
+
+  /*---Pipelining of iterations: the sweeper of the mirrored schedule that
+       sweeps every other iteration, or NULL, and the steps from the start
+       of one iteration to the start of the next---*/
+
+  struct Sweeper_* mirror;
+  int              nstep_iteration;
 } Sweeper;
 
 /*===========================================================================*/
@@ -88,6 +138,15 @@ static int Sweeper_noctant_per_block( const Sweeper* sweeper )
   return sweeper->noctant_per_block;
 }
 
+/*===========================================================================*/
+/*---Product of thread counts along problem axes, excluding amu axes---*/
+
+static int Sweeper_nthread( const Sweeper* sweeper )
+{
+  return sweeper->nthread_e * sweeper->nthread_octant *
+         sweeper->nthread_x * sweeper->nthread_y * sweeper->nthread_z;
+}
+
 /*===========================================================================*/
 /*---Thread counts for amu for execution target as understood by the host---*/
 
@@ -128,8 +187,9 @@ static inline int Sweeper_nvilocal_( Sweeper* sweeper,
          sweeper->nthread_y *
          sweeper->nthread_z
        :
-         Sweeper_nthread_m( sweeper, env ) *
-         NU *
+         Sweeper_nlocal_per_thread_( sweeper->is_numa_placement,
+           Sweeper_nthread_m( sweeper, env ) *
+           NU ) *
          sweeper->nthread_octant *
          sweeper->nthread_e *
          sweeper->nthread_x *
@@ -152,8 +212,10 @@ static inline int Sweeper_nvslocal_( Sweeper* sweeper,
          sweeper->nthread_y *
          sweeper->nthread_z
        :
-         Sweeper_nthread_a( sweeper, env ) *
-         NU *
+         Sweeper_nlocal_per_thread_( sweeper->is_numa_placement,
+           Sweeper_nthread_a( sweeper, env ) *
+           NU *
+           sweeper->ne_per_batch ) *
          sweeper->nthread_octant *
          sweeper->nthread_e *
          sweeper->nthread_x *
@@ -176,8 +238,10 @@ static inline int Sweeper_nvolocal_( Sweeper* sweeper,
          sweeper->nthread_y *
          sweeper->nthread_z
        :
-         Sweeper_nthread_m( sweeper, env ) *
-         NU *
+         Sweeper_nlocal_per_thread_( sweeper->is_numa_placement,
+           Sweeper_nthread_m( sweeper, env ) *
+           NU *
+           sweeper->ne_per_batch ) *
          sweeper->nthread_octant *
          sweeper->nthread_e *
          sweeper->nthread_x *
@@ -234,9 +298,9 @@ SweeperLite Sweeper_sweeperlite( Sweeper* sweeper );
 
 void Sweeper_sweep_block(
   Sweeper*               sweeper,
+  SweeperLite            sweeperlite,
   Pointer*               vo,
   Pointer*               vi,
-  int*                   is_block_init,
   Pointer*               facexy,
   Pointer*               facexz,
   Pointer*               faceyz,
@@ -246,9 +310,19 @@ void Sweeper_sweep_block(
   const Quantities*      quan,
   Env*                   env );
 
+/*===========================================================================*/
+/*---Place a state vector in memory near the threads that will use it---*/
+
+void Sweeper_place_state( Sweeper*        sweeper,
+                          P* __restrict__ v,
+                          Env*            env );
+
 /*===========================================================================*/
 /*---Perform a sweep---*/
 
+/*---NOTE: vo and vi may hold several right hand sides, interleaved along
+     the energy axis; see pack_state_rhs---*/
+
 void Sweeper_sweep(
   Sweeper*               sweeper,
   Pointer*               vo,
@@ -256,6 +330,20 @@ void Sweeper_sweep(
   const Quantities*      quan,
   Env*                   env );
 
+/*===========================================================================*/
+/*---Perform several sweeps, each taking the result of the last as input---*/
+
+/*---As with successive calls to Sweeper_sweep, sweeping vi into vo for
+     even iterations and vo into vi for odd ones---*/
+
+void Sweeper_sweep_iterations(
+  Sweeper*               sweeper,
+  Pointer*               vo,
+  Pointer*               vi,
+  int                    niterations,
+  const Quantities*      quan,
+  Env*                   env );
+
 /*===========================================================================*/
 
 #ifdef __cplusplus
@@ -19,6 +19,7 @@
 #include "array_accessors.h"
 #include "array_operations.h"
 #include "stepscheduler_kba.h"
+#include "sweepplan_kba.h"
 #include "sweeper_kba.h"
 
 #include "sweeper_kba_kernels.h"
@@ -38,14 +39,252 @@ Sweeper Sweeper_null()
   return result;
 }
 
+#ifdef USE_OPENMP_WORKSTEAL
 /*===========================================================================*/
-/*---Pseudo-constructor for Sweeper struct---*/
+/*---Build the graph of subblock tasks for sweeping a block---*/
 
-void Sweeper_create( Sweeper*          sweeper,
-                     Dimensions        dims,
-                     const Quantities* quan,
-                     Env*              env,
-                     Arguments*        args )
+static void Sweeper_create_taskgraph_( Sweeper* sweeper )
+{
+  const SweeperLite sweeperlite = Sweeper_sweeperlite( sweeper );
+  const SweeperLite* const s = &sweeperlite;
+
+  int semiblock_step = 0;
+
+  TaskGraph_create( &(sweeper->taskgraph), Sweeper_ntask( s ) );
+
+  for( semiblock_step=0; semiblock_step<s->nsemiblock; ++semiblock_step )
+  {
+  int thread_octant = 0;
+  for( thread_octant=0; thread_octant<s->nthread_octant; ++thread_octant )
+  {
+  int thread_e = 0;
+  for( thread_e=0; thread_e<s->nthread_e; ++thread_e )
+  {
+  int thread_z = 0;
+  for( thread_z=0; thread_z<s->nthread_z; ++thread_z )
+  {
+  int thread_y = 0;
+  for( thread_y=0; thread_y<s->nthread_y; ++thread_y )
+  {
+  int thread_x = 0;
+  for( thread_x=0; thread_x<s->nthread_x; ++thread_x )
+  {
+    const int task = Sweeper_task( s, thread_x, thread_y, thread_z,
+                                   thread_e, thread_octant, semiblock_step );
+
+    /*---Wavefront dependencies within a semiblock, as for omp task---*/
+
+    if( thread_x+1 < s->nthread_x )
+    {
+      TaskGraph_add_edge( &(sweeper->taskgraph), task, Sweeper_task( s,
+        thread_x+1, thread_y, thread_z, thread_e, thread_octant,
+        semiblock_step ) );
+    }
+    if( thread_y+1 < s->nthread_y )
+    {
+      TaskGraph_add_edge( &(sweeper->taskgraph), task, Sweeper_task( s,
+        thread_x, thread_y+1, thread_z, thread_e, thread_octant,
+        semiblock_step ) );
+    }
+    if( thread_z+1 < s->nthread_z )
+    {
+      TaskGraph_add_edge( &(sweeper->taskgraph), task, Sweeper_task( s,
+        thread_x, thread_y, thread_z+1, thread_e, thread_octant,
+        semiblock_step ) );
+    }
+
+    /*---Semiblock steps: octant threads write different semiblocks
+         within a step but may overlap across steps, and energy threads
+         never overlap, so join per energy thread---*/
+
+    if( semiblock_step > 0 )
+    {
+      TaskGraph_add_edge( &(sweeper->taskgraph),
+        Sweeper_task_join( s, thread_e, semiblock_step-1 ), task );
+    }
+    if( semiblock_step+1 < s->nsemiblock )
+    {
+      TaskGraph_add_edge( &(sweeper->taskgraph), task,
+        Sweeper_task_join( s, thread_e, semiblock_step ) );
+    }
+  }
+  }
+  }
+  }
+  }
+  }
+
+  TaskGraph_finalize( &(sweeper->taskgraph) );
+}
+#endif
+
+#ifdef USE_OPENMP_THREADS
+/*===========================================================================*/
+/*---First-touch the part of an array belonging to the calling thread---*/
+
+/*---The array consists of slabs, each a sequence of energy group slices
+     of nelt_per_ie elements.  In slabs islab_min..islab_max-1, the
+     slices of the energy groups of the calling thread, as given in
+     Sweeper_sweep_subblock, are split among the nshare threads
+     having these energy groups---*/
+
+static void Sweeper_first_touch_(
+  const Sweeper*   sweeper,
+  P* __restrict__  v,
+  int              ne,
+  size_t           nelt_per_ie,
+  int              islab_min,
+  int              islab_max,
+  int              thread_e,
+  int              ishare,
+  int              nshare )
+{
+  const int iemin = ( ne * ( thread_e     ) ) / sweeper->nthread_e;
+  const int iemax = ( ne * ( thread_e + 1 ) ) / sweeper->nthread_e;
+
+  const size_t nelt = nelt_per_ie * ( iemax - iemin );
+  const size_t imin = ( nelt * ( ishare     ) ) / nshare;
+  const size_t imax = ( nelt * ( ishare + 1 ) ) / nshare;
+
+  int islab = 0;
+
+  for( islab=islab_min; islab<islab_max; ++islab )
+  {
+    P* const __restrict__ v_this = v + nelt_per_ie *
+                                       ( iemin + ne * (size_t)islab );
+    size_t i = 0;
+
+    for( i=imin; i<imax; ++i )
+    {
+      v_this[i] = P_zero();
+    }
+  }
+}
+#endif
+
+/*===========================================================================*/
+/*---First-touch v*local arrays and faces from the threads using them---*/
+
+static void Sweeper_place_local_( Sweeper* sweeper )
+{
+#ifdef USE_OPENMP_THREADS
+  SweeperLite sweeperlite = Sweeper_sweeperlite( sweeper );
+
+  const Dimensions dims_b = sweeper->dims_b;
+
+  const int nvilocal = Sweeper_nlocal_per_thread_( Bool_true,
+                         NTHREAD_M * NU );
+  const int nvslocal = Sweeper_nlocal_per_thread_( Bool_true,
+                         NTHREAD_A * NU * sweeper->ne_per_batch );
+  const int nvolocal = Sweeper_nlocal_per_thread_( Bool_true,
+                         NTHREAD_M * NU * sweeper->ne_per_batch );
+
+  /*---The face arrays have one slab per octant in the octant block---*/
+
+  const size_t nelt_per_ie_facexy = dims_b.na * NU * (size_t)dims_b.ncell_x
+                                                   * (size_t)dims_b.ncell_y;
+  const size_t nelt_per_ie_facexz = dims_b.na * NU * (size_t)dims_b.ncell_x
+                                                   * (size_t)dims_b.ncell_z;
+  const size_t nelt_per_ie_faceyz = dims_b.na * NU * (size_t)dims_b.ncell_y
+                                                   * (size_t)dims_b.ncell_z;
+
+  const int nface = Faces_is_face_comm_async( &(sweeper->faces) ) ? NDIM : 1;
+
+#pragma omp parallel num_threads( Sweeper_nthread( sweeper ) )
+  {
+    P* const __restrict__ vilocal = Sweeper_vilocal_this_( &sweeperlite );
+    P* const __restrict__ vslocal = Sweeper_vslocal_this_( &sweeperlite );
+    P* const __restrict__ volocal = Sweeper_volocal_this_( &sweeperlite );
+
+    const int thread_e      = Sweeper_thread_e( &sweeperlite );
+    const int thread_octant = Sweeper_thread_octant( &sweeperlite );
+    const int ishare = Env_omp_thread() / ( sweeper->nthread_e *
+                                            sweeper->nthread_octant );
+    const int nshare = Sweeper_nthread( sweeper ) / ( sweeper->nthread_e *
+                                                      sweeper->nthread_octant );
+    int i = 0;
+    int octant_in_block = 0;
+
+    for( i=0; i<nvilocal; ++i )
+    {
+      vilocal[i] = P_zero();
+    }
+    for( i=0; i<nvslocal; ++i )
+    {
+      vslocal[i] = P_zero();
+    }
+    for( i=0; i<nvolocal; ++i )
+    {
+      volocal[i] = P_zero();
+    }
+
+    /*---Faces of the octants swept by this thread---*/
+
+    for( octant_in_block=thread_octant;
+         octant_in_block<sweeper->noctant_per_block;
+         octant_in_block+=sweeper->nthread_octant )
+    {
+      Sweeper_first_touch_( sweeper,
+                            Pointer_h( Faces_facexy( &(sweeper->faces), 0 ) ),
+                            dims_b.ne, nelt_per_ie_facexy,
+                            octant_in_block, octant_in_block+1,
+                            thread_e, ishare, nshare );
+
+      for( i=0; i<nface; ++i )
+      {
+        Sweeper_first_touch_( sweeper,
+                              Pointer_h( Faces_facexz( &(sweeper->faces), i ) ),
+                              dims_b.ne, nelt_per_ie_facexz,
+                              octant_in_block, octant_in_block+1,
+                              thread_e, ishare, nshare );
+        Sweeper_first_touch_( sweeper,
+                              Pointer_h( Faces_faceyz( &(sweeper->faces), i ) ),
+                              dims_b.ne, nelt_per_ie_faceyz,
+                              octant_in_block, octant_in_block+1,
+                              thread_e, ishare, nshare );
+      }
+    }
+  } /*---OPENMP---*/
+#endif
+}
+
+/*===========================================================================*/
+/*---Progress face communication from within the sweep---*/
+/*---pseudo-private member function---*/
+
+static void Sweeper_progress_faces_( void* context )
+{
+  SweeperProgress* progress = (SweeperProgress*)context;
+
+#ifdef USE_OPENMP_WORKSTEAL
+  /*---The task workers are not OpenMP threads, so all of them pass the
+       kernel's main thread check; MPI calls are funneled through the
+       thread that runs the task graph, the one that called the sweep---*/
+  if( ! TaskRunner_is_calling_thread( progress->taskrunner ) )
+  {
+    return;
+  }
+#endif
+
+  Faces_progress( progress->faces, progress->env );
+}
+
+/*===========================================================================*/
+/*---Set up a sweeper for one subdomain of the proc's block---*/
+/*---pseudo-private member function---*/
+
+/*---Without over-decomposition the single subdomain is the whole block---*/
+
+static void Sweeper_create_subdomain_( Sweeper*          sweeper,
+                                       Dimensions        dims,
+                                       const Quantities* quan,
+                                       Env*              env,
+                                       Arguments*        args,
+                                       int               nsubdomain_x,
+                                       int               nsubdomain_y,
+                                       int               subdomain_x,
+                                       int               subdomain_y,
+                                       Bool_t            is_mirrored )
 {
   /*====================*/
   /*---Declarations---*/
@@ -54,12 +293,48 @@ void Sweeper_create( Sweeper*          sweeper,
   Bool_t is_face_comm_async = Arguments_consume_int_or_default( args,
                                            "--is_face_comm_async", Bool_true );
 
+  Bool_t is_face_comm_aggregated = Arguments_consume_int_or_default( args,
+                                     "--is_face_comm_aggregated", Bool_false );
+
+  Insist( ( is_face_comm_async || ! is_face_comm_aggregated ) ?
+          "Face message aggregation requires asynchronous communication" : 0 );
+
+  Bool_t is_face_comm_progress = Arguments_consume_int_or_default( args,
+                                       "--is_face_comm_progress", Bool_false );
+
+  Insist( ( is_face_comm_async || ! is_face_comm_progress ) ?
+          "Face communication progress requires asynchronous communication"
+          : 0 );
+  /*---Progress is polled from the host sweep kernel---*/
+  Insist( ! is_face_comm_progress || ! Env_cuda_is_using_device( env ) ?
+          "Face communication progress not allowed for this case" : 0 );
+
+  Bool_t is_face_comm_shm = Arguments_consume_int_or_default( args,
+                                            "--is_face_comm_shm", Bool_false );
+
+  Insist( ( ( is_face_comm_async && ! is_face_comm_aggregated ) ||
+            ! is_face_comm_shm ) ?
+          "Shared memory face communication requires asynchronous"
+          " unaggregated communication" : 0 );
+
+  /*---Faces pass between subdomains of a proc as they would between procs
+       with asynchronous point-to-point messages---*/
+
+  Insist( ( nsubdomain_x * nsubdomain_y == 1 ||
+            ( is_face_comm_async && ! is_face_comm_aggregated &&
+              ! is_face_comm_shm ) ) ?
+          "Over-decomposition requires asynchronous unaggregated"
+          " face communication" : 0 );
+
   Insist( dims.ncell_x > 0 ?
                 "Currently required that all spatial blocks be nonempty" : 0 );
   Insist( dims.ncell_y > 0 ?
                 "Currently required that all spatial blocks be nonempty" : 0 );
   Insist( dims.ncell_z > 0 ?
                 "Currently required that all spatial blocks be nonempty" : 0 );
+  /*---The xy face is moved to and from the device once per sweep---*/
+  Insist( Env_nproc_z( env ) == 1 || ! Env_cuda_is_using_device( env ) ?
+          "Decomposition along z not allowed for this case" : 0 );
 
   /*====================*/
   /*---Set up number of kba blocks---*/
@@ -90,9 +365,33 @@ void Sweeper_create( Sweeper*          sweeper,
                                      || Env_cuda_is_using_device( env ) ?
           "Threading not allowed for this case" : 0 );
 
-  sweeper->noctant_per_block = sweeper->nthread_octant;
+  /*====================*/
+  /*---Set up sweep schedule---*/
+  /*====================*/
+
+  /*---For the all-octant schedule every step has all octants in flight,
+       and each octant thread sweeps a share of them in turn.  This cuts
+       the pipeline fill to that of a single octant, at the cost of more
+       work per step and faces for all octants---*/
+
+  const int schedule = Arguments_consume_int_or_default( args, "--schedule",
+                                                         SCHEDULE_KBA );
+
+  Insist( schedule == SCHEDULE_KBA || schedule == SCHEDULE_ALL_OCTANT ?
+          "Invalid schedule supplied." : 0 );
+  Insist( schedule == SCHEDULE_KBA || ! Env_cuda_is_using_device( env ) ?
+          "All-octant schedule not allowed for this case" : 0 );
+  Insist( schedule == SCHEDULE_KBA || Env_nproc_a( env ) == 1 ?
+          "All-octant schedule not allowed with angle groups" : 0 );
+
+  sweeper->noctant_per_block = schedule == SCHEDULE_ALL_OCTANT ?
+                               NOCTANT : sweeper->nthread_octant;
   sweeper->nblock_octant     = NOCTANT / sweeper->noctant_per_block;
 
+  /*---Angle groups combine their results on the host---*/
+  Insist( Env_nproc_a( env ) == 1 || ! Env_cuda_is_using_device( env ) ?
+          "Angle groups not allowed for this case" : 0 );
+
   /*====================*/
   /*---Set up number of semiblock steps---*/
   /*====================*/
@@ -109,11 +408,18 @@ void Sweeper_create( Sweeper*          sweeper,
   Insist( sweeper->nsemiblock>0 && sweeper->nsemiblock<=NOCTANT
           && ((sweeper->nsemiblock&(sweeper->nsemiblock-1))==0)
                                 ? "Invalid semiblock count supplied" : 0 );
-  Insist( ( sweeper->nsemiblock >= sweeper->nthread_octant ||
+
+  /*---With an incomplete set of semiblock steps, octant threads may update
+       the same part of vo concurrently; each octant then accumulates into
+       its own block-sized buffer, and these are summed into vo
+       after every step---*/
+
+  sweeper->is_vo_private = ! ( sweeper->nsemiblock >= sweeper->nthread_octant ||
             (sweeper->nthread_octant==8 && sweeper->nblock_z % 2 == 0
-                                        && sweeper->nsemiblock==4) ||
-            IS_USING_OPENMP_VO_ATOMIC )
-         ? "Incomplete set of semiblock steps requires atomic vo update" : 0 );
+                                        && sweeper->nsemiblock==4) );
+
+  Insist( ( ! sweeper->is_vo_private || ! Env_cuda_is_using_device( env ) )
+         ? "Incomplete set of semiblock steps not supported for this case" : 0 );
 
   /*====================*/
   /*---Set up size of subblocks---*/
@@ -155,9 +461,16 @@ void Sweeper_create( Sweeper*          sweeper,
   sweeper->dims_b = sweeper->dims;
   sweeper->dims_b.ncell_z = dims_b_ncell_z;
 
+  /*---The state vectors are those of this sweeper unless it sweeps a
+       subdomain---*/
+
+  sweeper->dims_v = sweeper->dims;
+
   sweeper->dims_g = sweeper->dims;
   sweeper->dims_g.ncell_x = quan->ncell_x_g;
   sweeper->dims_g.ncell_y = quan->ncell_y_g;
+  sweeper->dims_g.ncell_z = quan->ncell_z_g;
+  sweeper->dims_g.ne      = quan->ne_g;
 
   /*====================*/
   /*---Set up number of energy threads---*/
@@ -173,6 +486,46 @@ void Sweeper_create( Sweeper*          sweeper,
                                 || Env_cuda_is_using_device( env ) ?
           "Threading not allowed for this case" : 0 );
 
+  /*====================*/
+  /*---Set up energy group batching---*/
+  /*====================*/
+
+  sweeper->ne_per_batch
+                = Arguments_consume_int_or_default( args, "--ne_per_batch", 1);
+
+  Insist( sweeper->ne_per_batch > 0 ? "Invalid batch size supplied." : 0 );
+  /*---Batching is implemented only for the SIMD CPU kernels---*/
+  Insist( sweeper->ne_per_batch==1 || ( IS_USING_SIMD &&
+                                        ! Env_cuda_is_using_device( env ) ) ?
+          "Energy group batching not allowed for this case" : 0 );
+
+  /*====================*/
+  /*---Set up energy chunks for face communication---*/
+  /*====================*/
+
+  sweeper->nechunk = Arguments_consume_int_or_default( args, "--nechunk", 1);
+
+  Insist( sweeper->nechunk > 0 && sweeper->nechunk <= dims.ne ?
+          "Invalid number of energy chunks supplied." : 0 );
+  /*---Faces are moved to and from the device once per step---*/
+  Insist( sweeper->nechunk==1 || ! Env_cuda_is_using_device( env ) ?
+          "Energy chunks not allowed for this case" : 0 );
+
+  /*====================*/
+  /*---Set up angle sets for face communication---*/
+  /*====================*/
+
+  sweeper->nangle_set = Arguments_consume_int_or_default( args,
+                                                        "--nangle_set", 1);
+
+  Insist( sweeper->nangle_set > 0 && sweeper->nangle_set <= dims.na ?
+          "Invalid number of angle sets supplied." : 0 );
+  Insist( sweeper->nangle_set==1 || ! Env_cuda_is_using_device( env ) ?
+          "Angle sets not allowed for this case" : 0 );
+  /*---An aggregated message holds whole energy chunks of several octants---*/
+  Insist( sweeper->nangle_set==1 || ! is_face_comm_aggregated ?
+          "Angle sets not allowed with aggregated face communication" : 0 );
+
   /*====================*/
   /*---Set up number of spatial threads---*/
   /*====================*/
@@ -205,7 +558,17 @@ void Sweeper_create( Sweeper*          sweeper,
   }
   else
   {
-    sweeper->nthread_x = 1;
+    /*---For OpenMP threads builds, X threads share the cells of each
+         hyperplane ix+iy+iz=const of the semiblock---*/
+
+    sweeper->nthread_x
+                   = Arguments_consume_int_or_default( args, "--nthread_x", 1);
+
+    Insist( sweeper->nthread_x > 0 ? "Invalid thread count supplied." : 0 );
+    /*---Don't allow threading in cases where it doesn't make sense---*/
+    Insist( sweeper->nthread_x==1 || ( IS_USING_OPENMP_THREADS &&
+                                     ! Env_cuda_is_using_device( env ) ) ?
+            "Threading not allowed for this case" : 0 );
 
     sweeper->nthread_y
                    = Arguments_consume_int_or_default( args, "--nthread_y", 1);
@@ -230,6 +593,10 @@ void Sweeper_create( Sweeper*          sweeper,
             "Threading not allowed for this case" : 0 );
     Insist( sweeper->nthread_z==1 || ! IS_USING_OPENMP_TASKS ?
             "Spatial threading must be defined via subblock sizes." : 0 );
+
+    Insist( sweeper->nthread_x==1 || ( sweeper->nthread_y==1 &&
+                                       sweeper->nthread_z==1 ) ?
+            "Hyperplane threading cannot be combined with Y/Z threading." : 0 );
   }
 
   /*====================*/
@@ -237,7 +604,26 @@ void Sweeper_create( Sweeper*          sweeper,
   /*====================*/
 
   StepScheduler_create( &(sweeper->stepscheduler),
-                              sweeper->nblock_z, sweeper->nblock_octant, env );
+                        sweeper->nblock_z, sweeper->nblock_octant,
+                        nsubdomain_x, nsubdomain_y, subdomain_x, subdomain_y,
+                        is_mirrored, env );
+
+  /*====================*/
+  /*---Set up sweep plan---*/
+  /*====================*/
+
+  SweepPlan_create( &(sweeper->sweepplan), &(sweeper->stepscheduler),
+                    sweeper->nsemiblock, env );
+
+#ifdef USE_OPENMP_WORKSTEAL
+  /*====================*/
+  /*---Set up work-stealing task graph---*/
+  /*====================*/
+
+  /*---The worker team is set up by Sweeper_create---*/
+
+  Sweeper_create_taskgraph_( sweeper );
+#endif
 
   /*====================*/
   /*---Set up amu threads---*/
@@ -262,10 +648,37 @@ void Sweeper_create( Sweeper*          sweeper,
     Insist( dims.na % VEC_LEN == 0 );
   }
 
+  /*====================*/
+  /*---Set up memory placement---*/
+  /*====================*/
+
+  /*---Memory is placed by first touch, from the thread that will use it,
+       which assumes threads are bound to cores, e.g., by OMP_PROC_BIND---*/
+
+  sweeper->is_numa_placement = Arguments_consume_int_or_default( args,
+                                        "--is_numa_placement", Bool_false );
+
+  Insist( ( ! sweeper->is_numa_placement || ( IS_USING_OPENMP_THREADS &&
+                                    ! Env_cuda_is_using_device( env ) ) )
+         ? "NUMA placement requires an OpenMP threads build." : 0 );
+
   /*====================*/
   /*---Allocate arrays---*/
   /*====================*/
 
+  if( sweeper->is_numa_placement )
+  {
+    const size_t page_size = SWEEPER_NP_PER_PAGE * sizeof(P);
+
+    sweeper->vilocal_host_ = malloc_host_aligned_P(
+                             Sweeper_nvilocal_( sweeper, env ), page_size );
+    sweeper->vslocal_host_ = malloc_host_aligned_P(
+                             Sweeper_nvslocal_( sweeper, env ), page_size );
+    sweeper->volocal_host_ = malloc_host_aligned_P(
+                             Sweeper_nvolocal_( sweeper, env ), page_size );
+  }
+  else
+  {
   sweeper->vilocal_host_ = Env_cuda_is_using_device( env ) ?
                            ( (P*) NULL ) :
                            malloc_host_P( Sweeper_nvilocal_( sweeper, env ) );
@@ -277,109 +690,533 @@ void Sweeper_create( Sweeper*          sweeper,
   sweeper->volocal_host_ = Env_cuda_is_using_device( env ) ?
                            ( (P*) NULL ) :
                            malloc_host_P( Sweeper_nvolocal_( sweeper, env ) );
+  }
+
+  sweeper->vo_private_host_ = sweeper->is_vo_private ?
+                           malloc_host_P( Dimensions_size_state(
+                                                     sweeper->dims_b, NU ) *
+                                          sweeper->noctant_per_block ) :
+                           ( (P*) NULL );
+
+  /*---Padded per-thread counters for point-to-point thread sync---*/
+
+  sweeper->sync_counter_host_ = IS_USING_OPENMP_THREADS ?
+                           malloc_host_int( Sweeper_nthread( sweeper ) *
+                                            ENV_OMP_COUNTER_STRIDE ) :
+                           ( (int*) NULL );
 
   /*====================*/
   /*---Allocate faces---*/
   /*====================*/
 
   Faces_create( &(sweeper->faces), sweeper->dims_b,
-                sweeper->noctant_per_block, is_face_comm_async, env );
-}
-
-/*===========================================================================*/
-/*---Pseudo-destructor for Sweeper struct---*/
+                sweeper->noctant_per_block, sweeper->nechunk,
+                sweeper->nangle_set, is_face_comm_async,
+                is_face_comm_aggregated, is_face_comm_progress,
+                is_face_comm_shm, nsubdomain_x, nsubdomain_y,
+                subdomain_x, subdomain_y, env );
 
-void Sweeper_destroy( Sweeper* sweeper,
-                      Env*     env )
-{
   /*====================*/
-  /*---Deallocate arrays---*/
+  /*---Place thread-local arrays and faces---*/
   /*====================*/
 
-  if( ! Env_cuda_is_using_device( env ) )
+  if( sweeper->is_numa_placement )
   {
-    if( sweeper->vilocal_host_ )
-    {
-      free_host_P( sweeper->vilocal_host_ );
-    }
-    if( sweeper->vslocal_host_ )
-    {
-      free_host_P( sweeper->vslocal_host_ );
-    }
-    if( sweeper->volocal_host_ )
-    {
-      free_host_P( sweeper->volocal_host_ );
-    }
-    sweeper->vilocal_host_ = NULL;
-    sweeper->vslocal_host_ = NULL;
-    sweeper->volocal_host_ = NULL;
+    Sweeper_place_local_( sweeper );
   }
+}
 
-  /*====================*/
-  /*---Deallocate faces---*/
-  /*====================*/
+/*===========================================================================*/
+/*---Steps from the start of one pipelined iteration to that of the next---*/
+/*---pseudo-private member function---*/
+
+/*---A block of the input of an iteration is final once the iteration
+     before has swept it for the last time, and the iteration may overwrite
+     the block of its output, the input of the iteration before, only
+     then.  So the next iteration may start as soon as on every proc its
+     first step on each block comes after the last step of the iteration
+     before on the block.  At most two iterations are in flight at a time,
+     one on each sweeper---*/
+
+static int Sweeper_nstep_iteration_( Sweeper* sweeper,
+                                     Env*     env )
+{
+  const int nstep    = SweepPlan_nstep( &(sweeper->sweepplan) );
+  const int nblock_z = sweeper->nblock_z;
 
-  Faces_destroy( &(sweeper->faces) );
+  int* const step_first = malloc_host_int( 2 * nblock_z );
+  int* const step_last  = malloc_host_int( 2 * nblock_z );
 
-  /*====================*/
-  /*---Terminate scheduler---*/
-  /*====================*/
+  int result = iceil( nstep, 2 );
+  int imirror = 0;
+  int step = 0;
+  int octant_in_block = 0;
+  int block_z = 0;
 
-  StepScheduler_destroy( &( sweeper->stepscheduler ) );
-}
+  for( block_z=0; block_z<2*nblock_z; ++block_z )
+  {
+    step_first[ block_z ] = nstep;
+    step_last[  block_z ] = -1;
+  }
 
-/*===========================================================================*/
-/*---Extract SweeperLite from Sweeper---*/
+  for( imirror=0; imirror<2; ++imirror )
+  {
+    const SweepPlan* const sweepplan = imirror==0 ?
+                                       &(sweeper->sweepplan) :
+                                       &(sweeper->mirror->sweepplan);
 
-SweeperLite Sweeper_sweeperlite( Sweeper* sweeper )
-{
-  SweeperLite sweeperlite;
+    for( step=0; step<nstep; ++step )
+    for( octant_in_block=0; octant_in_block<sweeper->noctant_per_block;
+                                                            ++octant_in_block )
+    {
+      const StepInfo stepinfo = SweepPlan_stepinfoall( sweepplan, step
+                                              )->stepinfo[ octant_in_block ];
+      if( stepinfo.is_active )
+      {
+        const int i = stepinfo.block_z + nblock_z * imirror;
 
-  sweeperlite.vilocal_host_ = sweeper->vilocal_host_;
-  sweeperlite.vslocal_host_ = sweeper->vslocal_host_;
-  sweeperlite.volocal_host_ = sweeper->volocal_host_;
+        step_first[ i ] = step < step_first[ i ] ? step : step_first[ i ];
+        step_last[  i ] = step;
+      }
+    }
+  }
 
-  sweeperlite.dims   = sweeper->dims;
-  sweeperlite.dims_b = sweeper->dims_b;
-  sweeperlite.dims_g = sweeper->dims_g;
+  /*---Each sweeper is followed by the other---*/
 
-  sweeperlite.nthread_e      = sweeper->nthread_e;
-  sweeperlite.nthread_octant = sweeper->nthread_octant;
-  sweeperlite.nthread_x      = sweeper->nthread_x;
-  sweeperlite.nthread_y      = sweeper->nthread_y;
-  sweeperlite.nthread_z      = sweeper->nthread_z;
+  for( imirror=0; imirror<2; ++imirror )
+  for( block_z=0; block_z<nblock_z; ++block_z )
+  {
+    const int nstep_min = step_last[ block_z + nblock_z * imirror ] + 1
+                        - step_first[ block_z + nblock_z * (1-imirror) ];
 
-  sweeperlite.nblock_z             = sweeper->nblock_z;
-  sweeperlite.nblock_octant        = sweeper->nblock_octant;
-  sweeperlite.noctant_per_block    = sweeper->noctant_per_block;
-  sweeperlite.nsemiblock           = sweeper->nsemiblock;
-  sweeperlite.ncell_x_per_subblock = sweeper->ncell_x_per_subblock;
-  sweeperlite.ncell_y_per_subblock = sweeper->ncell_y_per_subblock;
-  sweeperlite.ncell_z_per_subblock = sweeper->ncell_z_per_subblock;
+    result = nstep_min > result ? nstep_min : result;
+  }
 
-#ifdef USE_OPENMP_TASKS
-  /*---Mark these as not yet properly initialized---*/
-  sweeperlite.thread_e = -1;
-  sweeperlite.thread_octant = -1;
-  sweeperlite.thread_x = -1;
-  sweeperlite.thread_y = -1;
-  sweeperlite.thread_z = -1;
-  /*---(Arbitrarily) point to the base of the current sweeper struct---*/
-  /*---NOTE: will break if sweeperlite is used after sweeper destroyed---*/
-  sweeperlite.task_dependency = (char*)sweeper;
+  free_host_int( step_first );
+  free_host_int( step_last );
+
+  return Env_max_i( env, result );
+}
+
+/*===========================================================================*/
+/*---Set up the sweeper of the mirrored schedule for pipelined iterations---*/
+/*---pseudo-private member function---*/
+
+/*---Iterations alternate between schedules that are mirror images of one
+     another, so an iteration starts from the corner where the last octant
+     block of the one before it started, and its first blocks are ready
+     while the one before is still sweeping elsewhere.  The mirror sweeper
+     has its own faces and messages---*/
+
+static void Sweeper_create_mirror_( Sweeper*          sweeper,
+                                    Dimensions        dims,
+                                    const Quantities* quan,
+                                    Env*              env,
+                                    Arguments*        args )
+{
+  Insist( ! Env_cuda_is_using_device( env ) ?
+          "Iteration pipelining not allowed for this case" : 0 );
+  /*---The angle groups sum their results at the end of each sweep---*/
+  Insist( Env_nproc_a( env ) == 1 ?
+          "Iteration pipelining not allowed with angle groups" : 0 );
+  /*---The xy faces are exchanged synchronously---*/
+  Insist( Env_nproc_z( env ) == 1 ?
+          "Iteration pipelining not allowed with decomposition along z" : 0 );
+  Insist( Faces_is_face_comm_async( &(sweeper->faces) ) &&
+          ! Faces_is_face_comm_aggregated( &(sweeper->faces) ) &&
+          ! Faces_is_face_comm_shm( &(sweeper->faces) ) ?
+          "Iteration pipelining requires asynchronous unaggregated"
+          " face communication" : 0 );
+
+  /*---Keep the message tags of the two sweepers apart---*/
+
+  Env_increment_tag( env, sweeper->noctant_per_block *
+                          Faces_nunit( &(sweeper->faces) ) );
+
+  sweeper->mirror = (Sweeper*)malloc( sizeof(Sweeper) );
+  *(sweeper->mirror) = Sweeper_null();
+
+  Sweeper_create_subdomain_( sweeper->mirror, dims, quan, env, args,
+                             1, 1, 0, 0, Bool_true );
+  sweeper->mirror->nsubdomain_x = 1;
+  sweeper->mirror->nsubdomain_y = 1;
+#ifdef USE_OPENMP_WORKSTEAL
+  sweeper->mirror->taskrunner   = sweeper->taskrunner;
 #endif
 
-  return sweeperlite;
+  sweeper->nstep_iteration = Sweeper_nstep_iteration_( sweeper, env );
 }
 
 /*===========================================================================*/
-/*---Adapter function to launch the sweep block kernel---*/
+/*---Pseudo-constructor for Sweeper struct---*/
 
-static void Sweeper_sweep_block_adapter(
-  Sweeper*               sweeper,
-        P* __restrict__  vo,
-  const P* __restrict__  vi,
-        P* __restrict__  facexy,
+/*---With over-decomposition the proc's block is split into a grid of
+     subdomains along x and y, and the sweep schedule is that of the grid
+     of subdomains over all procs.  The subdomains of a proc then sweep
+     different steps of the wavefront at the same time, so a proc has work
+     to do while waiting on its upstream neighbors.  Each subdomain has its
+     own sweeper, with its own faces, all taking the same options---*/
+
+void Sweeper_create( Sweeper*          sweeper,
+                     Dimensions        dims,
+                     const Quantities* quan,
+                     Env*              env,
+                     Arguments*        args )
+{
+  const int nsubdomain_x = Arguments_consume_int_or_default( args,
+                                                      "--nsubdomain_x", 1 );
+  const int nsubdomain_y = Arguments_consume_int_or_default( args,
+                                                      "--nsubdomain_y", 1 );
+  const int nsubdomain = nsubdomain_x * nsubdomain_y;
+
+  const Bool_t is_iteration_pipelined = Arguments_consume_int_or_default(
+                           args, "--is_iteration_pipelined", Bool_false );
+
+  int subdomain_x = 0;
+  int subdomain_y = 0;
+  int isubdomain = 0;
+
+  Insist( nsubdomain_x > 0 && nsubdomain_x <= dims.ncell_x ?
+          "Invalid number of subdomains supplied." : 0 );
+  Insist( nsubdomain_y > 0 && nsubdomain_y <= dims.ncell_y ?
+          "Invalid number of subdomains supplied." : 0 );
+  Insist( ! is_iteration_pipelined || nsubdomain == 1 ?
+          "Iteration pipelining not allowed with over-decomposition" : 0 );
+
+  if( nsubdomain == 1 )
+  {
+    /*---The mirror sweeper reads a copy of the options---*/
+
+    Arguments args_mirror = Arguments_null();
+
+    if( is_iteration_pipelined )
+    {
+      Arguments_create_copy( &args_mirror, args );
+    }
+
+    Sweeper_create_subdomain_( sweeper, dims, quan, env, args, 1, 1, 0, 0,
+                               Bool_false );
+    sweeper->nsubdomain_x = 1;
+    sweeper->nsubdomain_y = 1;
+#ifdef USE_OPENMP_WORKSTEAL
+    sweeper->taskrunner = (TaskRunner*)malloc( sizeof(TaskRunner) );
+    TaskRunner_create( sweeper->taskrunner, Env_omp_nthread_max() );
+#endif
+
+    if( is_iteration_pipelined )
+    {
+      Sweeper_create_mirror_( sweeper, dims, quan, env, &args_mirror );
+      Arguments_destroy( &args_mirror );
+    }
+    return;
+  }
+
+  /*---The subdomains are swept one after another from the host---*/
+  Insist( ! Env_cuda_is_using_device( env ) ?
+          "Over-decomposition not allowed for this case" : 0 );
+  /*---The xy faces are exchanged synchronously---*/
+  Insist( Env_nproc_z( env ) == 1 ?
+          "Over-decomposition not allowed with decomposition along z" : 0 );
+
+  *sweeper = Sweeper_null();
+  sweeper->dims         = dims;
+  sweeper->dims_v       = dims;
+  sweeper->nsubdomain_x = nsubdomain_x;
+  sweeper->nsubdomain_y = nsubdomain_y;
+  sweeper->subdomain    = (Sweeper*)malloc( nsubdomain * sizeof(Sweeper) );
+
+  sweeper->quan_subdomain        = (Quantities*)malloc( nsubdomain *
+                                                        sizeof(Quantities) );
+  sweeper->sweeperlite_subdomain = (SweeperLite*)malloc( nsubdomain *
+                                                        sizeof(SweeperLite) );
+  sweeper->progress_subdomain    = (SweeperProgress*)malloc( nsubdomain *
+                                                    sizeof(SweeperProgress) );
+#ifdef USE_OPENMP_WORKSTEAL
+  sweeper->taskrunner = (TaskRunner*)malloc( sizeof(TaskRunner) );
+  TaskRunner_create( sweeper->taskrunner, Env_omp_nthread_max() );
+#endif
+
+  for( subdomain_y=0; subdomain_y<nsubdomain_y; ++subdomain_y )
+  for( subdomain_x=0; subdomain_x<nsubdomain_x; ++subdomain_x )
+  {
+    Sweeper* const subdomain = & sweeper->subdomain[ subdomain_x +
+                                               nsubdomain_x * subdomain_y ];
+
+    /*---The last subdomain consumes the options; the others read a copy---*/
+
+    const Bool_t is_last = subdomain_x == nsubdomain_x-1 &&
+                           subdomain_y == nsubdomain_y-1;
+    Arguments args_subdomain = Arguments_null();
+
+    Dimensions dims_subdomain = dims;
+
+    const int ix_base = ( subdomain_x * dims.ncell_x ) / nsubdomain_x;
+    const int iy_base = ( subdomain_y * dims.ncell_y ) / nsubdomain_y;
+
+    dims_subdomain.ncell_x = ( (subdomain_x+1) * dims.ncell_x ) / nsubdomain_x
+                           - ix_base;
+    dims_subdomain.ncell_y = ( (subdomain_y+1) * dims.ncell_y ) / nsubdomain_y
+                           - iy_base;
+
+    if( ! is_last )
+    {
+      Arguments_create_copy( &args_subdomain, args );
+    }
+
+    *subdomain = Sweeper_null();
+    Sweeper_create_subdomain_( subdomain, dims_subdomain, quan, env,
+                               is_last ? args : &args_subdomain,
+                               nsubdomain_x, nsubdomain_y,
+                               subdomain_x, subdomain_y, Bool_false );
+
+    if( ! is_last )
+    {
+      Arguments_destroy( &args_subdomain );
+    }
+
+    subdomain->nsubdomain_x      = 1;
+    subdomain->nsubdomain_y      = 1;
+    subdomain->dims_v            = dims;
+    subdomain->ix_base_subdomain = ix_base;
+    subdomain->iy_base_subdomain = iy_base;
+#ifdef USE_OPENMP_WORKSTEAL
+    subdomain->taskrunner        = sweeper->taskrunner;
+#endif
+  }
+
+  /*---Let each subdomain write its faces to its downstream neighbors on
+       this proc---*/
+
+  for( isubdomain=0; isubdomain<nsubdomain; ++isubdomain )
+  {
+    Sweeper* const subdomain = & sweeper->subdomain[ isubdomain ];
+
+    int axis = 0;
+    int dir_ind = 0;
+
+    for( axis=0; axis<2; ++axis )
+    for( dir_ind=0; dir_ind<2; ++dir_ind )
+    {
+      const int dir = dir_ind==0 ? DIR_UP*1 : DIR_DN*1;
+
+      if( subdomain->faces.is_sub_send[axis][dir_ind] )
+      {
+        const int isubdomain_downstream = isubdomain + Dir_inc( dir ) *
+                                          ( axis==0 ? 1 : nsubdomain_x );
+
+        Faces_connect_subdomain( &(subdomain->faces),
+          &(sweeper->subdomain[ isubdomain_downstream ].faces),
+          axis, dir_ind );
+      }
+    }
+
+    /*---Set up the context for sweeping the subdomain---*/
+
+    sweeper->sweeperlite_subdomain[ isubdomain ] =
+                                            Sweeper_sweeperlite( subdomain );
+
+    sweeper->progress_subdomain[ isubdomain ].faces = &(subdomain->faces);
+    sweeper->progress_subdomain[ isubdomain ].env   = env;
+#ifdef USE_OPENMP_WORKSTEAL
+    sweeper->progress_subdomain[ isubdomain ].taskrunner =
+                                                       sweeper->taskrunner;
+#endif
+
+    if( Faces_is_face_comm_progress( &(subdomain->faces) ) )
+    {
+      sweeper->sweeperlite_subdomain[ isubdomain ].progress_fn =
+                                                     Sweeper_progress_faces_;
+      sweeper->sweeperlite_subdomain[ isubdomain ].progress_context =
+                                    & sweeper->progress_subdomain[ isubdomain ];
+    }
+  }
+}
+
+/*===========================================================================*/
+/*---Tear down the sweeper for one subdomain of the proc's block---*/
+/*---pseudo-private member function---*/
+
+static void Sweeper_destroy_subdomain_( Sweeper* sweeper,
+                                        Env*     env )
+{
+  /*====================*/
+  /*---Deallocate arrays---*/
+  /*====================*/
+
+  if( sweeper->is_numa_placement )
+  {
+    free_host_aligned_P( sweeper->vilocal_host_ );
+    free_host_aligned_P( sweeper->vslocal_host_ );
+    free_host_aligned_P( sweeper->volocal_host_ );
+    sweeper->vilocal_host_ = NULL;
+    sweeper->vslocal_host_ = NULL;
+    sweeper->volocal_host_ = NULL;
+  }
+
+  if( ! Env_cuda_is_using_device( env ) )
+  {
+    if( sweeper->vilocal_host_ )
+    {
+      free_host_P( sweeper->vilocal_host_ );
+    }
+    if( sweeper->vslocal_host_ )
+    {
+      free_host_P( sweeper->vslocal_host_ );
+    }
+    if( sweeper->volocal_host_ )
+    {
+      free_host_P( sweeper->volocal_host_ );
+    }
+    sweeper->vilocal_host_ = NULL;
+    sweeper->vslocal_host_ = NULL;
+    sweeper->volocal_host_ = NULL;
+  }
+
+  if( sweeper->vo_private_host_ )
+  {
+    free_host_P( sweeper->vo_private_host_ );
+  }
+  sweeper->vo_private_host_ = NULL;
+
+  if( sweeper->sync_counter_host_ )
+  {
+    free_host_int( sweeper->sync_counter_host_ );
+  }
+  sweeper->sync_counter_host_ = NULL;
+
+  /*====================*/
+  /*---Deallocate faces---*/
+  /*====================*/
+
+  Faces_destroy( &(sweeper->faces), env );
+
+  /*====================*/
+  /*---Terminate plan and scheduler---*/
+  /*====================*/
+
+#ifdef USE_OPENMP_WORKSTEAL
+  TaskGraph_destroy( &( sweeper->taskgraph ) );
+#endif
+  SweepPlan_destroy( &( sweeper->sweepplan ) );
+  StepScheduler_destroy( &( sweeper->stepscheduler ) );
+}
+
+/*===========================================================================*/
+/*---Pseudo-destructor for Sweeper struct---*/
+
+void Sweeper_destroy( Sweeper* sweeper,
+                      Env*     env )
+{
+  if( sweeper->subdomain )
+  {
+    int isubdomain = 0;
+
+    for( isubdomain=0;
+         isubdomain<sweeper->nsubdomain_x * sweeper->nsubdomain_y;
+         ++isubdomain )
+    {
+      Sweeper_destroy_subdomain_( & sweeper->subdomain[ isubdomain ], env );
+    }
+
+    free( (void*) sweeper->subdomain );
+    free( (void*) sweeper->quan_subdomain );
+    free( (void*) sweeper->sweeperlite_subdomain );
+    free( (void*) sweeper->progress_subdomain );
+    sweeper->subdomain             = NULL;
+    sweeper->quan_subdomain        = NULL;
+    sweeper->sweeperlite_subdomain = NULL;
+    sweeper->progress_subdomain    = NULL;
+  }
+  else
+  {
+    if( sweeper->mirror )
+    {
+      Sweeper_destroy_subdomain_( sweeper->mirror, env );
+      free( (void*) sweeper->mirror );
+      sweeper->mirror = NULL;
+    }
+
+    Sweeper_destroy_subdomain_( sweeper, env );
+  }
+
+#ifdef USE_OPENMP_WORKSTEAL
+  TaskRunner_destroy( sweeper->taskrunner );
+  free( (void*) sweeper->taskrunner );
+  sweeper->taskrunner = NULL;
+#endif
+}
+
+/*===========================================================================*/
+/*---Extract SweeperLite from Sweeper---*/
+
+SweeperLite Sweeper_sweeperlite( Sweeper* sweeper )
+{
+  SweeperLite sweeperlite;
+
+  sweeperlite.vilocal_host_ = sweeper->vilocal_host_;
+  sweeperlite.vslocal_host_ = sweeper->vslocal_host_;
+  sweeperlite.volocal_host_ = sweeper->volocal_host_;
+  sweeperlite.vo_private_host_ = sweeper->vo_private_host_;
+  sweeperlite.sync_counter_host_ = sweeper->sync_counter_host_;
+
+  sweeperlite.dims   = sweeper->dims;
+  sweeperlite.dims_b = sweeper->dims_b;
+  sweeperlite.dims_g = sweeper->dims_g;
+  sweeperlite.dims_v = sweeper->dims_v;
+  sweeperlite.ix_base_subdomain = sweeper->ix_base_subdomain;
+  sweeperlite.iy_base_subdomain = sweeper->iy_base_subdomain;
+
+  sweeperlite.nthread_e      = sweeper->nthread_e;
+  sweeperlite.nthread_octant = sweeper->nthread_octant;
+  sweeperlite.nthread_x      = sweeper->nthread_x;
+  sweeperlite.nthread_y      = sweeper->nthread_y;
+  sweeperlite.nthread_z      = sweeper->nthread_z;
+
+  sweeperlite.nblock_z             = sweeper->nblock_z;
+  sweeperlite.nblock_octant        = sweeper->nblock_octant;
+  sweeperlite.noctant_per_block    = sweeper->noctant_per_block;
+  sweeperlite.nsemiblock           = sweeper->nsemiblock;
+  sweeperlite.ncell_x_per_subblock = sweeper->ncell_x_per_subblock;
+  sweeperlite.ncell_y_per_subblock = sweeper->ncell_y_per_subblock;
+  sweeperlite.ncell_z_per_subblock = sweeper->ncell_z_per_subblock;
+  sweeperlite.ne_per_batch         = sweeper->ne_per_batch;
+  sweeperlite.iemin_chunk          = 0;
+  sweeperlite.iemax_chunk          = sweeper->dims.ne;
+  sweeperlite.iamin_set            = 0;
+  sweeperlite.iamax_set            = sweeper->dims.na;
+  sweeperlite.is_vo_private        = sweeper->is_vo_private;
+  sweeperlite.is_numa_placement    = sweeper->is_numa_placement;
+  sweeperlite.progress_fn          = NULL;
+  sweeperlite.progress_context     = NULL;
+
+#ifdef USE_OPENMP_TASKS
+  /*---Mark these as not yet properly initialized---*/
+  sweeperlite.thread_e = -1;
+  sweeperlite.thread_octant = -1;
+  sweeperlite.thread_x = -1;
+  sweeperlite.thread_y = -1;
+  sweeperlite.thread_z = -1;
+  /*---(Arbitrarily) point to the base of the current sweeper struct---*/
+  /*---NOTE: will break if sweeperlite is used after sweeper destroyed---*/
+  sweeperlite.task_dependency = (char*)sweeper;
+#endif
+#ifdef USE_OPENMP_WORKSTEAL
+  sweeperlite.taskrunner = sweeper->taskrunner;
+  sweeperlite.taskgraph  = &(sweeper->taskgraph);
+#endif
+
+  return sweeperlite;
+}
+
+/*===========================================================================*/
+/*---Adapter function to launch the sweep block kernel---*/
+
+static void Sweeper_sweep_block_adapter(
+  Sweeper*               sweeper,
+  SweeperLite            sweeperlite,
+        P* __restrict__  vo,
+  const P* __restrict__  vi,
+        P* __restrict__  facexy,
         P* __restrict__  facexz,
         P* __restrict__  faceyz,
   const P* __restrict__  a_from_m,
@@ -394,10 +1231,6 @@ static void Sweeper_sweep_block_adapter(
   unsigned long int      do_block_init,
   Env*                   env )
 {
-  /*---Create lightweight version of Sweeper class that uses less GPU mem---*/
-
-  SweeperLite sweeperlite = Sweeper_sweeperlite( sweeper );
-
   /*---Call sweep block implementation function---*/
 
   if( Env_cuda_is_using_device( env ) )
@@ -435,8 +1268,15 @@ static void Sweeper_sweep_block_adapter(
   else
   {
 #ifdef USE_OPENMP_THREADS
-#pragma omp parallel num_threads( sweeper->nthread_e * sweeper->nthread_octant \
-                                * sweeper->nthread_y * sweeper->nthread_z )
+    /*---Reset thread sync counters, as all threads are now joined---*/
+
+    int i = 0;
+    for( i=0; i<Sweeper_nthread( sweeper ) * ENV_OMP_COUNTER_STRIDE; ++i )
+    {
+      sweeper->sync_counter_host_[i] = 0;
+    }
+
+#pragma omp parallel num_threads( Sweeper_nthread( sweeper ) )
   {
 #endif
 
@@ -464,104 +1304,196 @@ static void Sweeper_sweep_block_adapter(
 }
 
 /*===========================================================================*/
-/*---Perform a sweep for a block---*/
+/*---Sum the private vo buffers of the octants of a step into vo---*/
 
-void Sweeper_sweep_block(
+static void Sweeper_reduce_vo_private_(
   Sweeper*               sweeper,
-  Pointer*               vo,
-  Pointer*               vi,
-  int*                   is_block_init,
-  Pointer*               facexy,
-  Pointer*               facexz,
-  Pointer*               faceyz,
-  const Pointer*         a_from_m,
-  const Pointer*         m_from_a,
-  int                    step,
-  const Quantities*      quan,
-  Env*                   env )
+  SweeperLite            sweeperlite,
+  P* __restrict__        vo,
+  const StepInfoAll*     stepinfoall,
+  unsigned long int      do_block_init )
 {
-  /*---Declarations---*/
+  const int noctant_per_block = sweeper->noctant_per_block;
 
-  const int proc_x = Env_proc_x_this( env );
-  const int proc_y = Env_proc_y_this( env );
+  /*---Only the energy groups of the current energy chunk are combined;
+       these are contiguous within each z slab of the block---*/
 
-  const int noctant_per_block = sweeper->noctant_per_block;
+  const Dimensions dims_b = sweeper->dims_b;
+  const Dimensions dims_v = sweeper->dims_v;
 
-  StepInfoAll stepinfoall;  /*---But only use noctant_per_block values---*/
+  const size_t nelt_per_ie = dims_b.nm * NU * (size_t)dims_b.ncell_x
+                                            * (size_t)dims_b.ncell_y;
 
-  int octant_in_block = 0;
+  /*---The buffers and vo agree along the rows of cells along x, but the
+       rows of vo are strided as in the state vectors of the proc---*/
 
-  int semiblock_step = 0;
+  const size_t nelt_row   = dims_b.nm * NU * (size_t)dims_b.ncell_x;
+  const size_t nelt_row_v = dims_v.nm * NU * (size_t)dims_v.ncell_x;
+  const size_t nelt_per_slab = nelt_per_ie * ( sweeperlite.iemax_chunk -
+                                               sweeperlite.iemin_chunk );
 
-  unsigned long int do_block_init = 0;
+  /*---Chunk the slabs so the buffers being combined stay in cache---*/
 
-  /*---Precalculate stepinfo for required octants---*/
+  const int nelt_per_chunk = 1024;
+  const int nchunk_per_slab = (int)( ( nelt_per_slab + nelt_per_chunk - 1 )
+                                                     / nelt_per_chunk );
+  const int nchunk = nchunk_per_slab * dims_b.ncell_z;
 
-  for( octant_in_block=0; octant_in_block<sweeper->noctant_per_block;
+  int octant_in_block = 0;
+
+  /*---The octants sweeping a block are combined when visiting the first---*/
+
+  for( octant_in_block=0; octant_in_block<noctant_per_block;
                                                             ++octant_in_block )
   {
-    stepinfoall.stepinfo[octant_in_block] = StepScheduler_stepinfo(
-      &(sweeper->stepscheduler), step, octant_in_block, proc_x, proc_y );
+    const StepInfo stepinfo = stepinfoall->stepinfo[octant_in_block];
 
-  }
+    P* vo_private[NOCTANT];
+    int noctant_this_block = 0;
+    Bool_t is_first_octant = stepinfo.is_active;
+    Bool_t is_block_init = Bool_false;
 
-  /*---Precalculate initialization schedule---*/
-  /*---Determine whether this is the first calculation for this sweep step
-       and semiblock step - in which case set values rather than add values---*/
+    int octant_in_block_2 = 0;
 
-  for( semiblock_step=0; semiblock_step<sweeper->nsemiblock; ++semiblock_step )
-  {
-#pragma novector
-    for( octant_in_block=0; octant_in_block<sweeper->noctant_per_block;
-                                                            ++octant_in_block )
+    for( octant_in_block_2=0; octant_in_block_2<noctant_per_block;
+                                                          ++octant_in_block_2 )
     {
-      const StepInfo stepinfo = stepinfoall.stepinfo[octant_in_block];
-      if( stepinfo.is_active )
-      {
-        const Bool_t is_semiblock_x_lo = is_semiblock_min_when_semiblocked(
-            sweeper->nsemiblock, semiblock_step,
-            DIM_X, Dir_x( stepinfo.octant ) );
-        const Bool_t is_semiblock_min_x = is_semiblock_x_lo ||
-                             ! is_axis_semiblocked(sweeper->nsemiblock, DIM_X);
+      const StepInfo stepinfo_2 = stepinfoall->stepinfo[octant_in_block_2];
 
+      if( stepinfo_2.is_active && stepinfo_2.block_z == stepinfo.block_z )
+      {
+        int semiblock_step = 0;
 
-        const Bool_t is_semiblock_y_lo = is_semiblock_min_when_semiblocked(
-            sweeper->nsemiblock, semiblock_step,
-            DIM_Y, Dir_y( stepinfo.octant ) );
-        const Bool_t is_semiblock_min_y = is_semiblock_y_lo ||
-                             ! is_axis_semiblocked(sweeper->nsemiblock, DIM_Y);
+        is_first_octant = is_first_octant &&
+                          octant_in_block_2 >= octant_in_block;
 
+        vo_private[noctant_this_block++] = Sweeper_vo_private_this_(
+                                             &sweeperlite, octant_in_block_2 );
 
-        const Bool_t is_semiblock_z_lo = is_semiblock_min_when_semiblocked(
-            sweeper->nsemiblock, semiblock_step,
-            DIM_Z, Dir_z( stepinfo.octant ) );
-        const Bool_t is_semiblock_min_z = is_semiblock_z_lo ||
-                             ! is_axis_semiblocked(sweeper->nsemiblock, DIM_Z);
+        /*---On the first visit to the block, set vo rather than add---*/
 
-        /*---Which semiblock is being processed, according to a uniform
-             direction-independent numbering scheme---*/
+        for( semiblock_step=0; semiblock_step<sweeper->nsemiblock;
+                                                             ++semiblock_step )
+        {
+          is_block_init = is_block_init || ( do_block_init &
+                                   ( ((unsigned long int)1) <<
+                                     ( octant_in_block_2 + noctant_per_block *
+                                       semiblock_step ) ) );
+        }
+      }
+    } /*---octant_in_block_2---*/
 
-        const int semiblock_num = ( is_semiblock_min_x ? 0 : 1 ) + 2 * (
-                                  ( is_semiblock_min_y ? 0 : 1 ) + 2 * (
-                                  ( is_semiblock_min_z ? 0 : 1 ) ));
+    if( is_first_octant )
+    {
+      P* const __restrict__ vo_this = ref_state( vo, dims_v, NU,
+                        sweeper->ix_base_subdomain, sweeper->iy_base_subdomain,
+                        stepinfo.block_z * sweeper->dims_b.ncell_z, 0, 0, 0 );
+      int ichunk = 0;
 
-        /*---Update the running tally of whether this semiblock of this
-             block has been initialized yet---*/
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for( ichunk=0; ichunk<nchunk; ++ichunk )
+      {
+        const int iz = ichunk / nchunk_per_slab;
+        const size_t ibase = nelt_per_ie * ( sweeperlite.iemin_chunk +
+                                             dims_b.ne * (size_t)iz );
+        const size_t imin = ibase + ( ichunk % nchunk_per_slab ) *
+                                                    (size_t)nelt_per_chunk;
+        const size_t imax = imin + nelt_per_chunk < ibase + nelt_per_slab ?
+                            imin + nelt_per_chunk : ibase + nelt_per_slab;
+        size_t i = 0;
+        size_t irow = 0;
+        int stride = 0;
+        int ioctant = 0;
+
+        /*---Pairwise tree in a fixed order, in place in the buffers,
+             so the result does not depend on the number of threads---*/
+
+        for( stride=1; stride<noctant_this_block; stride*=2 )
+        {
+          for( ioctant=0; ioctant+stride<noctant_this_block;
+                                                           ioctant+=2*stride )
+          {
+            P* const __restrict__       dst = vo_private[ioctant];
+            const P* const __restrict__ src = vo_private[ioctant+stride];
+
+            for( i=imin; i<imax; ++i )
+            {
+              dst[i] += src[i];
+            }
+          }
+        }
 
-        if( ! ( is_block_init[ stepinfo.block_z ] & ( 1 << semiblock_num ) ) )
+        for( irow=imin/nelt_row; irow*nelt_row<imax; ++irow )
         {
-          do_block_init |= ( ((unsigned long int)1) <<
-                             ( octant_in_block + noctant_per_block *
-                               semiblock_step ) );
-          is_block_init[ stepinfo.block_z ] |= ( 1 << semiblock_num );
+          P* const __restrict__ vo_row = vo_this + nelt_row_v * (
+                          irow % dims_b.ncell_y + dims_v.ncell_y *
+                        ( irow / dims_b.ncell_y ) );
+          const P* const __restrict__ vo_private_row = vo_private[0] +
+                                                       irow * nelt_row;
+          const size_t kmin = imin > irow * nelt_row ?
+                              imin - irow * nelt_row : 0;
+          const size_t kmax = imax < ( irow + 1 ) * nelt_row ?
+                              imax - irow * nelt_row : nelt_row;
+          size_t k = 0;
+
+          if( is_block_init )
+          {
+            for( k=kmin; k<kmax; ++k )
+            {
+              vo_row[k] = vo_private_row[k];
+            }
+          }
+          else
+          {
+            for( k=kmin; k<kmax; ++k )
+            {
+              vo_row[k] += vo_private_row[k];
+            }
+          }
         }
-      }
-    } /*---octant_in_block---*/
-  } /*---semiblock---*/
+      } /*---ichunk---*/
+    } /*---is_first_octant---*/
+  } /*---octant_in_block---*/
+}
+
+/*===========================================================================*/
+/*---Perform a sweep for a block---*/
+
+void Sweeper_sweep_block(
+  Sweeper*               sweeper,
+  SweeperLite            sweeperlite,
+  Pointer*               vo,
+  Pointer*               vi,
+  Pointer*               facexy,
+  Pointer*               facexz,
+  Pointer*               faceyz,
+  const Pointer*         a_from_m,
+  const Pointer*         m_from_a,
+  int                    step,
+  const Quantities*      quan,
+  Env*                   env )
+{
+  /*---Declarations---*/
+
+  const int proc_x = StepScheduler_proc_x( &(sweeper->stepscheduler) );
+  const int proc_y = StepScheduler_proc_y( &(sweeper->stepscheduler) );
+
+  /*---Step info and initialization schedule are looked up from the plan---*/
+
+  const StepInfoAll* stepinfoall = SweepPlan_stepinfoall(
+                                              &(sweeper->sweepplan), step );
+  /*---Only the first angle set initializes vo; later sets add to it---*/
+
+  const unsigned long int do_block_init = sweeperlite.iamin_set != 0 ? 0 :
+                                          SweepPlan_do_block_init(
+                                              &(sweeper->sweepplan), step );
 
   /*---Call kernel adapter---*/
 
   Sweeper_sweep_block_adapter( sweeper,
+                               sweeperlite,
                                Pointer_active( vo ),
                                Pointer_active( vi ),
                                Pointer_active( facexy ),
@@ -572,275 +1504,593 @@ void Sweeper_sweep_block(
                                step,
                                quan,
                                proc_x==0,
-                               proc_x==Env_nproc_x( env )-1,
+                               proc_x==StepScheduler_nproc_x(
+                                         &(sweeper->stepscheduler) )-1,
                                proc_y==0,
-                               proc_y==Env_nproc_y( env )-1,
-                               stepinfoall,
+                               proc_y==StepScheduler_nproc_y(
+                                         &(sweeper->stepscheduler) )-1,
+                               *stepinfoall,
                                do_block_init,
                                env);
+
+  /*---Combine the private vo contributions of the octants---*/
+
+  if( sweeper->is_vo_private )
+  {
+    Sweeper_reduce_vo_private_( sweeper, sweeperlite, Pointer_active( vo ),
+                                stepinfoall, do_block_init );
+  }
 }
 
 /*===========================================================================*/
-/*---Perform a sweep---*/
+/*---Place a state vector in memory near the threads that will use it---*/
 
-void Sweeper_sweep(
+void Sweeper_place_state( Sweeper*        sweeper,
+                          P* __restrict__ v,
+                          Env*            env )
+{
+  Assert( sweeper );
+  Assert( v );
+
+#ifdef USE_OPENMP_THREADS
+  /*---With over-decomposition the subdomains share one thread layout;
+       the state vectors are placed as if the first swept the whole block,
+       which is exact for threading in energy only---*/
+
+  Sweeper* const sweeper_threads = sweeper->subdomain ?
+                                   & sweeper->subdomain[0] : sweeper;
+
+  if( sweeper_threads->is_numa_placement )
+  {
+    SweeperLite sweeperlite = Sweeper_sweeperlite( sweeper_threads );
+
+    const Dimensions dims = sweeper->dims_v;
+
+    /*---The state vector has one slab per cell along z---*/
+
+    const size_t nelt_per_ie = dims.nm * NU * (size_t)dims.ncell_x
+                                            * (size_t)dims.ncell_y;
+
+#pragma omp parallel num_threads( Sweeper_nthread( sweeper_threads ) )
+    {
+      /*---All threads with the same energy groups sweep the whole block---*/
+
+      Sweeper_first_touch_( sweeper_threads, v, dims.ne, nelt_per_ie,
+                            0, dims.ncell_z,
+                            Sweeper_thread_e( &sweeperlite ),
+                            Env_omp_thread() / sweeper_threads->nthread_e,
+                            Sweeper_nthread( sweeper_threads ) /
+                            sweeper_threads->nthread_e );
+    } /*---OPENMP---*/
+  }
+#endif
+}
+
+/*===========================================================================*/
+/*---Sweep one work unit of a step, with its face communication---*/
+/*---pseudo-private member function---*/
+
+static void Sweeper_sweep_step_unit_(
   Sweeper*               sweeper,
+  SweeperLite            sweeperlite,
   Pointer*               vo,
   Pointer*               vi,
   const Quantities*      quan,
+  int                    step,
+  int                    iunit,
   Env*                   env )
 {
-  Assert( sweeper );
-  Assert( vi );
-  Assert( vo );
-
   /*---Declarations---*/
 
   const int nblock_z = sweeper->nblock_z;
 
-  const int nstep = StepScheduler_nstep( &(sweeper->stepscheduler) );
-  int step = -1;
+  const int nstep = SweepPlan_nstep( &(sweeper->sweepplan) );
+
+  const Bool_t is_sweep_step = step>=0 && step<nstep;
 
   const size_t size_state_block = Dimensions_size_state( sweeper->dims, NU )
                                                                    / nblock_z;
 
-  Bool_t* is_block_init = (Bool_t*) malloc( nblock_z * sizeof( Bool_t ) );
+  /*---Pointers to single active block of state vector---*/
+
+  Pointer vi_b = Pointer_null();
+  Pointer vo_b = Pointer_null();
 
   int i = 0;
 
-  for( i=0; i<nblock_z; ++i )
+  /*---Pick up needed face pointers---*/
+
+  /*=========================================================================
+  =    Order is important here.
+  =    The _r face for a step must match the _c face for the next step.
+  =    The _s face for a step must match the _c face for the prev step.
+  =========================================================================*/
+
+  Pointer* facexy = Faces_facexy_step( &(sweeper->faces), step );
+  Pointer* facexz = Faces_facexz_step( &(sweeper->faces), step );
+  Pointer* faceyz = Faces_faceyz_step( &(sweeper->faces), step );
+
+  /*=========================================================================
+  =    Faces are triple buffered via a circular buffer of face arrays.
+  =    The following shows the pattern of face usage over a step:
+  =
+  =                         step:     ...    i    i+1   i+2   i+3   ...
+  =    ------------------------------------------------------------------
+  =    Recv face for this step wait   ...  face0 face1 face2 face0  ...
+  =    Recv face for next step start  ...  face1 face2 face0 face1  ...
+  =    Compute this step using face   ...  face0 face1 face2 face0  ...
+  =    Send face from last step wait  ...  face2 face0 face1 face2  ...
+  =    Send face from this step start ...  face0 face1 face2 face0  ...
+  =========================================================================*/
+
+  const Bool_t is_first_unit = iunit == 0;
+  const Bool_t is_last_unit  = iunit == Faces_nunit( &(sweeper->faces) )
+                                         - 1;
+
+  const int ichunk     = Faces_ichunk_unit( &(sweeper->faces), iunit );
+  const int iangle_set = Faces_iangle_set_unit( &(sweeper->faces),
+                                                iunit );
+
+  SweeperLite sweeperlite_unit = sweeperlite;
+
+  sweeperlite_unit.iemin_chunk = Faces_iemin_chunk( &(sweeper->faces),
+                                            sweeper->dims.ne, ichunk );
+  sweeperlite_unit.iemax_chunk = Faces_iemin_chunk( &(sweeper->faces),
+                                            sweeper->dims.ne, ichunk+1 );
+  sweeperlite_unit.iamin_set   = Faces_iamin_set( &(sweeper->faces),
+                                            sweeper->dims.na, iangle_set );
+  sweeperlite_unit.iamax_set   = Faces_iamin_set( &(sweeper->faces),
+                                          sweeper->dims.na, iangle_set+1 );
+
+  /*====================*/
+  /*---Recv face via MPI WAIT (i)---*/
+  /*====================*/
+
+  if( is_sweep_step &&  Faces_is_face_comm_async( &(sweeper->faces)) )
   {
-    is_block_init[i] = 0;
+    Faces_recv_faces_end( &(sweeper->faces), &(sweeper->sweepplan),
+                          sweeper->dims_b, step-1, iunit, env );
   }
 
-  /*---Initialize result array to zero if needed---*/
-
-#ifdef USE_OPENMP_VO_ATOMIC
-  initialize_state_zero( Pointer_h( vo ), sweeper->dims, NU );
-  Pointer_update_d_stream( vo, Env_cuda_stream_kernel_faces( env ) );
-#endif
+  /*====================*/
+  /*---Send face to device START (i)---*/
+  /*---Send face to device WAIT (i)---*/
+  /*====================*/
 
-  /*--------------------*/
-  /*---Loop over kba parallel steps---*/
-  /*--------------------*/
+  if( is_sweep_step && is_first_unit )
+  {
+    if( step == 0 )
+    {
+      Pointer_update_d_stream( facexy,
+                               Env_cuda_stream_kernel_faces( env ) );
+    }
+    Pointer_update_d_stream( facexz,
+                             Env_cuda_stream_kernel_faces( env ) );
+    Pointer_update_d_stream( faceyz,
+                             Env_cuda_stream_kernel_faces( env ) );
+  }
+  Env_cuda_stream_wait( env, Env_cuda_stream_kernel_faces( env ) );
 
-  /*---Extra step at begin/end to fill/drain async pipeline---*/
+  /*====================*/
+  /*---Recv face via MPI START (i+1)---*/
+  /*====================*/
 
-  for( step=0-1; step<nstep+1; ++step )
+  if( is_sweep_step &&  Faces_is_face_comm_async( &(sweeper->faces)) )
   {
-    const Bool_t is_sweep_step = step>=0 && step<nstep;
+    Faces_recv_faces_start( &(sweeper->faces), &(sweeper->sweepplan),
+                          sweeper->dims_b, step, iunit, env );
+  }
 
-    /*---Pointers to single active block of state vector---*/
+  /*====================*/
+  /*---Perform the sweep on the block START (i)---*/
+  /*====================*/
 
-    Pointer vi_b = Pointer_null();
-    Pointer vo_b = Pointer_null();
+  if( is_sweep_step )
+  {
+    Sweeper_sweep_block( sweeper, sweeperlite_unit, vo, vi,
+                         facexy, facexz, faceyz,
+                         & quan->a_from_m, & quan->m_from_a,
+                         step, quan, env );
+  }
 
-    int i = 0;
+  /*====================*/
+  /*---Send block to device START (i+1)---*/
+  /*====================*/
 
-    /*---Pick up needed face pointers---*/
-
-    /*=========================================================================
-    =    Order is important here.
-    =    The _r face for a step must match the _c face for the next step.
-    =    The _s face for a step must match the _c face for the prev step.
-    =========================================================================*/
-
-    Pointer* facexy = Faces_facexy_step( &(sweeper->faces), step );
-    Pointer* facexz = Faces_facexz_step( &(sweeper->faces), step );
-    Pointer* faceyz = Faces_faceyz_step( &(sweeper->faces), step );
-
-    /*=========================================================================
-    =    Faces are triple buffered via a circular buffer of face arrays.
-    =    The following shows the pattern of face usage over a step:
-    =
-    =                         step:     ...    i    i+1   i+2   i+3   ...
-    =    ------------------------------------------------------------------
-    =    Recv face for this step wait   ...  face0 face1 face2 face0  ...
-    =    Recv face for next step start  ...  face1 face2 face0 face1  ...
-    =    Compute this step using face   ...  face0 face1 face2 face0  ...
-    =    Send face from last step wait  ...  face2 face0 face1 face2  ...
-    =    Send face from this step start ...  face0 face1 face2 face0  ...
-    =========================================================================*/
-
-    /*====================*/
-    /*---Recv face via MPI WAIT (i)---*/
-    /*====================*/
-
-    if( is_sweep_step &&  Faces_is_face_comm_async( &(sweeper->faces)) )
-    {
-      Faces_recv_faces_end( &(sweeper->faces), &(sweeper->stepscheduler),
-                            sweeper->dims_b, step-1, env );
+  for( i=0; i<2; ++i )
+  {
+    /*---Determine blocks needing transfer, counting from top/bottom z---*/
+    /*---NOTE: for case of one octant thread, can speed this up by only
+         send/recv of one block per step, not two---*/
+
+    const int stept = step + 1;
+    const int    block_to_send[2] = {                                stept,
+                                      ( nblock_z-1 ) -             stept };
+    const Bool_t do_block_send[2] = { block_to_send[0] <  nblock_z/2,
+                                      block_to_send[1] >= nblock_z/2 };
+    Assert( nstep >= nblock_z );  /*---Sanity check---*/
+    if( do_block_send[i] && is_last_unit )
+    {
+      Pointer_create_alias(    &vi_b, vi,
+                               size_state_block * block_to_send[i],
+                               size_state_block );
+      Pointer_update_d_stream( &vi_b, Env_cuda_stream_send_block( env ) );
+      Pointer_destroy(         &vi_b );
     }
+  }
 
-    /*====================*/
-    /*---Send face to device START (i)---*/
-    /*---Send face to device WAIT (i)---*/
-    /*====================*/
+  /*====================*/
+  /*---Recv block from device START (i-1)---*/
+  /*====================*/
 
-    if( is_sweep_step )
+  for( i=0; i<2; ++i )
+  {
+    /*---Determine blocks needing transfer, counting from top/bottom z---*/
+    /*---NOTE: for case of one octant thread, can speed this up by only
+         send/recv of one block per step, not two---*/
+
+    const int stept = step - 1;
+    const int    block_to_recv[2] = { ( nblock_z-1 ) - ( nstep-1 - stept ),
+                                                     ( nstep-1 - stept ) };
+    const Bool_t do_block_recv[2] = { block_to_recv[0] >= nblock_z/2,
+                                      block_to_recv[1] <  nblock_z/2 };
+    Assert( nstep >= nblock_z );  /*---Sanity check---*/
+    if( do_block_recv[i] && is_last_unit )
     {
-      if( step == 0 )
-      {
-        Pointer_update_d_stream( facexy, Env_cuda_stream_kernel_faces( env ) );
-      }
-      Pointer_update_d_stream(   facexz, Env_cuda_stream_kernel_faces( env ) );
-      Pointer_update_d_stream(   faceyz, Env_cuda_stream_kernel_faces( env ) );
+      Pointer_create_alias(    &vo_b, vo,
+                               size_state_block * block_to_recv[i],
+                               size_state_block );
+      Pointer_update_h_stream( &vo_b, Env_cuda_stream_recv_block( env ) );
+      Pointer_destroy(         &vo_b );
     }
-    Env_cuda_stream_wait( env, Env_cuda_stream_kernel_faces( env ) );
+  }
 
-    /*====================*/
-    /*---Recv face via MPI START (i+1)---*/
-    /*====================*/
+  /*====================*/
+  /*---Send block to device WAIT (i+1)---*/
+  /*---Recv block from device WAIT (i-1)---*/
+  /*====================*/
 
-    if( is_sweep_step &&  Faces_is_face_comm_async( &(sweeper->faces)) )
-    {
-      Faces_recv_faces_start( &(sweeper->faces), &(sweeper->stepscheduler),
-                            sweeper->dims_b, step, env );
-    }
+  Env_cuda_stream_wait( env, Env_cuda_stream_send_block( env ) );
+  Env_cuda_stream_wait( env, Env_cuda_stream_recv_block( env ) );
+
+  /*====================*/
+  /*---Send face via MPI WAIT (i-1)---*/
+  /*====================*/
+
+  if( is_sweep_step && Faces_is_face_comm_async( &(sweeper->faces)) )
+  {
+    Faces_send_faces_end( &(sweeper->faces), &(sweeper->sweepplan),
+                          sweeper->dims_b, step-1, iunit, env );
+  }
 
-    /*====================*/
-    /*---Perform the sweep on the block START (i)---*/
-    /*====================*/
+  /*====================*/
+  /*---Perform the sweep on the block WAIT (i)---*/
+  /*====================*/
+
+  Env_cuda_stream_wait( env, Env_cuda_stream_kernel_faces( env ) );
+
+  /*====================*/
+  /*---Recv face from device START (i)---*/
+  /*---Recv face from device WAIT (i)---*/
+  /*====================*/
 
-    if( is_sweep_step )
+  if( is_sweep_step && is_last_unit )
+  {
+    if( step == nstep-1 )
     {
-      Sweeper_sweep_block( sweeper, vo, vi, is_block_init,
-                           facexy, facexz, faceyz,
-                           & quan->a_from_m, & quan->m_from_a,
-                           step, quan, env );
+      Pointer_update_h_stream( facexy,
+                               Env_cuda_stream_kernel_faces( env ) );
     }
+    Pointer_update_h_stream( facexz,
+                             Env_cuda_stream_kernel_faces( env ) );
+    Pointer_update_h_stream( faceyz,
+                             Env_cuda_stream_kernel_faces( env ) );
+  }
+  Env_cuda_stream_wait( env, Env_cuda_stream_kernel_faces( env ) );
+
+  /*====================*/
+  /*---Send face via MPI START (i)---*/
+  /*====================*/
+
+  if( is_sweep_step && Faces_is_face_comm_async( &(sweeper->faces)) )
+  {
+    Faces_send_faces_start( &(sweeper->faces), &(sweeper->sweepplan),
+                          sweeper->dims_b, step, iunit, env );
+  }
+
+  /*====================*/
+  /*---Communicate faces (synchronous)---*/
+  /*====================*/
+
+  if( is_sweep_step && ! Faces_is_face_comm_async( &(sweeper->faces)) )
+  {
+    Faces_communicate_faces( &(sweeper->faces), &(sweeper->sweepplan),
+                          sweeper->dims_b, step, iunit, env );
+  }
 
-    /*====================*/
-    /*---Send block to device START (i+1)---*/
-    /*====================*/
+  /*====================*/
+  /*---Communicate xy faces if z is decomposed (synchronous)---*/
+  /*====================*/
 
-    for( i=0; i<2; ++i )
+  if( is_sweep_step )
+  {
+    Faces_communicate_facexy( &(sweeper->faces), &(sweeper->sweepplan),
+                          sweeper->dims_b, step, iunit, env );
+  }
+}
+
+/*===========================================================================*/
+/*---Perform a sweep of the subdomains of an over-decomposed block---*/
+/*---pseudo-private member function---*/
+
+/*---The subdomains are interleaved at the finest grain at which faces
+     are sent: for each step and work unit, every subdomain is swept in
+     turn, those whose faces go to other procs first, so these messages
+     are in flight while the rest are swept.  Faces between subdomains of
+     the proc are copied in place of a message.
+---*/
+
+static void Sweeper_sweep_subdomains_(
+  Sweeper*               sweeper,
+  Pointer*               vo,
+  Pointer*               vi,
+  const Quantities*      quan,
+  Env*                   env )
+{
+  const int nsubdomain = sweeper->nsubdomain_x * sweeper->nsubdomain_y;
+
+  Sweeper* const subdomain0 = & sweeper->subdomain[0];
+
+  const int nstep = SweepPlan_nstep( &(subdomain0->sweepplan) );
+  const int nunit = Faces_nunit( &(subdomain0->faces) );
+
+  Quantities*  const quan_subdomain = sweeper->quan_subdomain;
+  SweeperLite* const sweeperlite    = sweeper->sweeperlite_subdomain;
+
+  int isubdomain = 0;
+  int step = -1;
+
+  for( isubdomain=0; isubdomain<nsubdomain; ++isubdomain )
+  {
+    Sweeper* const subdomain = & sweeper->subdomain[ isubdomain ];
+
+    /*---Global cell indices, as used for boundary conditions---*/
+
+    quan_subdomain[ isubdomain ] = *quan;
+    quan_subdomain[ isubdomain ].ix_base += subdomain->ix_base_subdomain;
+    quan_subdomain[ isubdomain ].iy_base += subdomain->iy_base_subdomain;
+  }
+
+  /*---Extra step at begin/end to fill/drain async pipeline---*/
+
+  for( step=0-1; step<nstep+1; ++step )
+  {
+    int iunit = 0;
+
+    for( iunit=0; iunit<nunit; ++iunit )
     {
-      /*---Determine blocks needing transfer, counting from top/bottom z---*/
-      /*---NOTE: for case of one octant thread, can speed this up by only
-           send/recv of one block per step, not two---*/
+      int pass = 0;
 
-      const int stept = step + 1;
-      const int    block_to_send[2] = {                                stept,
-                                        ( nblock_z-1 ) -               stept };
-      const Bool_t do_block_send[2] = { block_to_send[0] <  nblock_z/2,
-                                        block_to_send[1] >= nblock_z/2 };
-      Assert( nstep >= nblock_z );  /*---Sanity check---*/
-      if( do_block_send[i] )
+      for( pass=0; pass<2; ++pass )
       {
-        Pointer_create_alias(    &vi_b, vi, size_state_block * block_to_send[i],
-                                            size_state_block );
-        Pointer_update_d_stream( &vi_b, Env_cuda_stream_send_block( env ) );
-        Pointer_destroy(         &vi_b );
-
-        /*---Initialize result array to zero if needed---*/
-        /*---NOTE: this is not performance-optimal---*/
-#ifdef USE_OPENMP_VO_ATOMIC
-        Pointer_create_alias(    &vo_b, vi, size_state_block * block_to_send[i],
-                                          size_state_block );
-        initialize_state_zero( Pointer_h( &vo_b ), sweeper->dims, NU );
-        Pointer_update_d_stream( &vo_b, Env_cuda_stream_send_block( env ) );
-        Pointer_destroy(         &vo_b );
+        for( isubdomain=0; isubdomain<nsubdomain; ++isubdomain )
+        {
+          Sweeper* const subdomain = & sweeper->subdomain[ isubdomain ];
+
+          const Bool_t is_send_off_proc = step>=0 && step<nstep &&
+                       Faces_is_send_off_proc( &(subdomain->faces),
+                                               &(subdomain->sweepplan), step );
+
+          if( is_send_off_proc != ( pass == 0 ) )
+          {
+            continue;
+          }
+
+          Sweeper_sweep_step_unit_( subdomain, sweeperlite[ isubdomain ],
+                                    vo, vi, & quan_subdomain[ isubdomain ],
+                                    step, iunit, env );
+        }
+      } /*---pass---*/
+    } /*---iunit---*/
+  } /*---step---*/
+
+  /*---Each angle group has swept only its own octants; sum the results---*/
+
+  Env_sum_angle_groups_P( env, Pointer_h( vo ),
+                          Dimensions_size_state( sweeper->dims, NU ) );
+
+  /*---Increment message tag---*/
+
+  Env_increment_tag( env, subdomain0->noctant_per_block * nunit *
+                          nsubdomain );
+}
+
+/*===========================================================================*/
+/*---Perform a sweep---*/
+
+void Sweeper_sweep(
+  Sweeper*               sweeper,
+  Pointer*               vo,
+  Pointer*               vi,
+  const Quantities*      quan,
+  Env*                   env )
+{
+  Assert( sweeper );
+  Assert( vi );
+  Assert( vo );
+
+  if( sweeper->subdomain )
+  {
+    Sweeper_sweep_subdomains_( sweeper, vo, vi, quan, env );
+    return;
+  }
+
+  /*---Declarations---*/
+
+  const int nstep = SweepPlan_nstep( &(sweeper->sweepplan) );
+  int step = -1;
+
+  /*---Create lightweight version of Sweeper class that uses less GPU mem---*/
+
+  SweeperLite sweeperlite = Sweeper_sweeperlite( sweeper );
+
+  /*---Let the kernel progress the in-flight face messages between
+       subblocks, rather than only when the messages are waited on---*/
+
+  SweeperProgress progress;
+  progress.faces = &(sweeper->faces);
+  progress.env   = env;
+#ifdef USE_OPENMP_WORKSTEAL
+  progress.taskrunner = sweeper->taskrunner;
 #endif
-      }
-    }
 
-    /*====================*/
-    /*---Recv block from device START (i-1)---*/
-    /*====================*/
+  if( Faces_is_face_comm_progress( &(sweeper->faces) ) )
+  {
+    sweeperlite.progress_fn      = Sweeper_progress_faces_;
+    sweeperlite.progress_context = &progress;
+  }
+
+  /*--------------------*/
+  /*---Loop over kba parallel steps---*/
+  /*--------------------*/
 
-    for( i=0; i<2; ++i )
+  /*---Extra step at begin/end to fill/drain async pipeline---*/
+
+  for( step=0-1; step<nstep+1; ++step )
+  {
+    int iunit = 0;
+
+    /*---Loop over work units, each an energy chunk and an angle set: the
+         faces of each unit are sent as soon as the unit has been swept, so
+         the downstream neighbor can start on it while this unit's
+         successors are being swept---*/
+
+    for( iunit=0; iunit<Faces_nunit( &(sweeper->faces) ); ++iunit )
     {
-      /*---Determine blocks needing transfer, counting from top/bottom z---*/
-      /*---NOTE: for case of one octant thread, can speed this up by only
-           send/recv of one block per step, not two---*/
+      Sweeper_sweep_step_unit_( sweeper, sweeperlite, vo, vi, quan,
+                                step, iunit, env );
+    } /*---iunit---*/
 
-      const int stept = step - 1;
-      const int    block_to_recv[2] = { ( nblock_z-1 ) - ( nstep-1 - stept ),
-                                                         ( nstep-1 - stept ) };
-      const Bool_t do_block_recv[2] = { block_to_recv[0] >= nblock_z/2,
-                                        block_to_recv[1] <  nblock_z/2 };
-      Assert( nstep >= nblock_z );  /*---Sanity check---*/
-      if( do_block_recv[i] )
-      {
-        Pointer_create_alias(    &vo_b, vo, size_state_block * block_to_recv[i],
-                                            size_state_block );
-        Pointer_update_h_stream( &vo_b, Env_cuda_stream_recv_block( env ) );
-        Pointer_destroy(         &vo_b );
-      }
-    }
+  } /*---step---*/
 
-    /*====================*/
-    /*---Send block to device WAIT (i+1)---*/
-    /*---Recv block from device WAIT (i-1)---*/
-    /*====================*/
+  /*---Each angle group has swept only its own octants; sum the results---*/
 
-    Env_cuda_stream_wait( env, Env_cuda_stream_send_block( env ) );
-    Env_cuda_stream_wait( env, Env_cuda_stream_recv_block( env ) );
+  Env_sum_angle_groups_P( env, Pointer_h( vo ),
+                          Dimensions_size_state( sweeper->dims, NU ) );
 
-    /*====================*/
-    /*---Send face via MPI WAIT (i-1)---*/
-    /*====================*/
+  /*---Increment message tag---*/
 
-    if( is_sweep_step && Faces_is_face_comm_async( &(sweeper->faces)) )
-    {
-      Faces_send_faces_end( &(sweeper->faces), &(sweeper->stepscheduler),
-                            sweeper->dims_b, step-1, env );
-    }
+  Env_increment_tag( env, sweeper->noctant_per_block *
+                          Faces_nunit( &(sweeper->faces) ) );
 
-    /*====================*/
-    /*---Perform the sweep on the block WAIT (i)---*/
-    /*====================*/
+} /*---sweep---*/
 
-    Env_cuda_stream_wait( env, Env_cuda_stream_kernel_faces( env ) );
+/*===========================================================================*/
+/*---Perform several sweeps, each taking the result of the last as input---*/
 
-    /*====================*/
-    /*---Recv face from device START (i)---*/
-    /*---Recv face from device WAIT (i)---*/
-    /*====================*/
+/*---With pipelining the iterations alternate between the sweeper and its
+     mirror, each starting nstep_iteration steps after the one before, so
+     that the pipeline fill and drain of a sweep overlap those of its
+     neighbors.  At each step the older iteration goes first---*/
 
-    if( is_sweep_step )
-    {
-      if( step == nstep-1 )
-      {
-        Pointer_update_h_stream( facexy, Env_cuda_stream_kernel_faces( env ) );
-      }
-      Pointer_update_h_stream(   facexz, Env_cuda_stream_kernel_faces( env ) );
-      Pointer_update_h_stream(   faceyz, Env_cuda_stream_kernel_faces( env ) );
-    }
-    Env_cuda_stream_wait( env, Env_cuda_stream_kernel_faces( env ) );
+void Sweeper_sweep_iterations(
+  Sweeper*               sweeper,
+  Pointer*               vo,
+  Pointer*               vi,
+  int                    niterations,
+  const Quantities*      quan,
+  Env*                   env )
+{
+  Assert( sweeper );
+  Assert( vi );
+  Assert( vo );
+  Assert( niterations >= 0 );
 
-    /*====================*/
-    /*---Send face via MPI START (i)---*/
-    /*====================*/
+  int iteration = 0;
 
-    if( is_sweep_step && Faces_is_face_comm_async( &(sweeper->faces)) )
+  if( ! sweeper->mirror )
+  {
+    for( iteration=0; iteration<niterations; ++iteration )
     {
-      Faces_send_faces_start( &(sweeper->faces), &(sweeper->stepscheduler),
-                            sweeper->dims_b, step, env );
+      Sweeper_sweep( sweeper,
+                     iteration%2==0 ? vo : vi,
+                     iteration%2==0 ? vi : vo,
+                     quan,
+                     env );
     }
+    return;
+  }
 
-    /*====================*/
-    /*---Communicate faces (synchronous)---*/
-    /*====================*/
+  /*---Declarations---*/
+
+  const int nstep = SweepPlan_nstep( &(sweeper->sweepplan) );
+  const int nunit = Faces_nunit( &(sweeper->faces) );
+  const int nstep_all = niterations == 0 ? 0 :
+                        sweeper->nstep_iteration * ( niterations - 1 ) + nstep;
+
+  Sweeper*         sweepers[2];
+  SweeperLite      sweeperlite[2];
+  SweeperProgress  progress[2];
+
+  int imirror = 0;
+  int step_all = -1;
+
+  sweepers[0] = sweeper;
+  sweepers[1] = sweeper->mirror;
+
+  for( imirror=0; imirror<2; ++imirror )
+  {
+    sweeperlite[ imirror ] = Sweeper_sweeperlite( sweepers[ imirror ] );
 
-    if( is_sweep_step && ! Faces_is_face_comm_async( &(sweeper->faces)) )
+    progress[ imirror ].faces = &(sweepers[ imirror ]->faces);
+    progress[ imirror ].env   = env;
+#ifdef USE_OPENMP_WORKSTEAL
+    progress[ imirror ].taskrunner = sweepers[ imirror ]->taskrunner;
+#endif
+
+    if( Faces_is_face_comm_progress( &(sweepers[ imirror ]->faces) ) )
     {
-      Faces_communicate_faces( &(sweeper->faces), &(sweeper->stepscheduler),
-                            sweeper->dims_b, step, env );
+      sweeperlite[ imirror ].progress_fn      = Sweeper_progress_faces_;
+      sweeperlite[ imirror ].progress_context = & progress[ imirror ];
     }
+  }
 
-  } /*---step---*/
+  /*--------------------*/
+  /*---Loop over kba parallel steps of all iterations---*/
+  /*--------------------*/
 
-  /*---Increment message tag---*/
+  /*---Extra step at begin/end of each iteration to fill/drain async
+       pipeline---*/
 
-  Env_increment_tag( env, sweeper->noctant_per_block );
+  for( step_all=0-1; step_all<nstep_all+1; ++step_all )
+  {
+    for( iteration=0; iteration<niterations; ++iteration )
+    {
+      const int step = step_all - sweeper->nstep_iteration * iteration;
+      int iunit = 0;
 
-  /*---Finish---*/
+      if( step < 0-1 || step >= nstep+1 )
+      {
+        continue;
+      }
 
-  free( (void*) is_block_init );
+      imirror = iteration % 2;
 
-} /*---sweep---*/
+      for( iunit=0; iunit<nunit; ++iunit )
+      {
+        Sweeper_sweep_step_unit_( sweepers[ imirror ],
+                                  sweeperlite[ imirror ],
+                                  imirror==0 ? vo : vi,
+                                  imirror==0 ? vi : vo,
+                                  quan, step, iunit, env );
+      } /*---iunit---*/
+    } /*---iteration---*/
+  } /*---step_all---*/
+
+  /*---Increment message tag, as for the same sweeps done one by one---*/
+
+  Env_increment_tag( env, niterations * sweeper->noctant_per_block * nunit );
+}
 
 /*===========================================================================*/
 
@@ -52,6 +52,9 @@ TARGET_HD static inline void Sweeper_sweep_cell(
 {
   enum{ NU_PER_THREAD = NU / NTHREAD_U };
 
+  const Dimensions dims_b_vi = Sweeper_dims_b_vi( sweeper );
+  const Dimensions dims_b_vo = Sweeper_dims_b_vo( sweeper );
+
   int ia_base = 0;
 
   const int sweeper_thread_a = Sweeper_thread_a( sweeper );
@@ -67,10 +70,11 @@ TARGET_HD static inline void Sweeper_sweep_cell(
        some threadiung in U is allowed---*/
 
   /*====================*/
-  /*---Master loop over angle blocks---*/
+  /*---Master loop over angle blocks of the current angle set---*/
   /*====================*/
 
-  for( ia_base=0; ia_base<sweeper->dims_b.na; ia_base += NTHREAD_A )
+  for( ia_base=sweeper->iamin_set; ia_base<sweeper->iamax_set;
+                                   ia_base += NTHREAD_A )
   {
     int im_base = 0;
 
@@ -116,7 +120,7 @@ TODO: fix vectorization for this loop.
           if( ( NM % NTHREAD_M == 0 || im < NM ) &&
               is_elt_active )
           {
-            if( ia_base == 0 ||
+            if( ia_base == sweeper->iamin_set ||
                 NM*1 > NTHREAD_M*1 )
             {
               int iu_base = 0;
@@ -130,15 +134,15 @@ TODO: fix vectorization for this loop.
                   *ref_vilocal( vilocal, sweeper->dims_b, NU, NTHREAD_M,
                                             sweeper_thread_m, iu ) =
                   *const_ref_state_flat( vi_this,
-                                         sweeper->dims_b.ncell_x,
-                                         sweeper->dims_b.ncell_y,
-                                         sweeper->dims_b.ncell_z,
-                                         sweeper->dims_b.ne,
+                                         dims_b_vi.ncell_x,
+                                         dims_b_vi.ncell_y,
+                                         dims_b_vi.ncell_z,
+                                         dims_b_vi.ne,
                                          NM,
                                          NU,
                                          ix, iy, iz, ie, im, iu );
                   /*---Can use this for non-MIC case:
-                    --- *const_ref_state( vi_this, sweeper->dims_b, NU,
+                    --- *const_ref_state( vi_this, dims_b_vi, NU,
                     ---                   ix, iy, iz, ie, im, iu );
                   ---*/
                 }
@@ -177,7 +181,7 @@ TODO: fix vectorization for this loop.
 #endif
         {
           const int ia = ia_base + sweeper_thread_a;
-          if( ia < sweeper->dims_b.na && is_elt_active )
+          if( ia < sweeper->iamax_set && is_elt_active )
           {
             int im_in_block = 0;
             int iu = 0;
@@ -270,11 +274,12 @@ TODO: fix vectorization for this loop.
                         ia, sweeper_thread_a, NTHREAD_A,
                         facexy, facexz, faceyz,
                         ix, iy, iz, ie,
-                        ix+quan->ix_base, iy+quan->iy_base, iz+iz_base,
+                        ix+quan->ix_base, iy+quan->iy_base,
+                        iz+iz_base+quan->iz_base,
                         octant, octant_in_block,
                         sweeper->noctant_per_block,
                         sweeper->dims_b, sweeper->dims_g,
-                        is_elt_active );
+                        is_elt_active && ia < sweeper->iamax_set );
     }
 
     /*====================*/
@@ -338,7 +343,7 @@ TODO: fix vectorization for this loop.
             /*---TODO: set up logic here to run fast for all cases---*/
 
 #ifdef __MIC__
-            if( ia_base + NTHREAD_A == sweeper->dims_b.na )
+            if( ia_base + NTHREAD_A == sweeper->iamax_set )
 #else
             if( Bool_false )
 #endif
@@ -391,7 +396,7 @@ TODO: fix vectorization for this loop.
               for( ia_in_block=0; ia_in_block<NTHREAD_A; ++ia_in_block )
               {
                 const int ia = ia_base + ia_in_block;
-                const Bool_t mask = ia < sweeper->dims_b.na;
+                const Bool_t mask = ia < sweeper->iamax_set;
 
                 const P m_from_a_this = mask ? m_from_a[
                                     ind_m_from_a_flat( sweeper->dims_b.nm,
@@ -427,7 +432,7 @@ TODO: fix vectorization for this loop.
             /*---Store/update to shared memory---*/
             /*--------------------*/
 
-            if( ia_base == 0 ||
+            if( ia_base == sweeper->iamin_set ||
                 NM*1 > NTHREAD_M*1 )
             {
 #pragma unroll
@@ -469,28 +474,13 @@ TODO: fix vectorization for this loop.
           if( ( (NM*1) % (NTHREAD_M*1) == 0 || im < NM*1 ) &&
               is_elt_active )
           {
-            if( ia_base+NTHREAD_A >= sweeper->dims_b.na ||
+            if( ia_base+NTHREAD_A >= sweeper->iamax_set ||
                 NM*1 > NTHREAD_M*1 )
             {
               int iu_base = 0;
-#ifdef USE_OPENMP_VO_ATOMIC
-#pragma unroll
-              for( iu_base=0; iu_base<NU; iu += NTHREAD_U )
-              {
-                const int iu = iu_base + sweeper_thread_u;
-
-                if( (NU*1) % (NTHREAD_U*1) == 0 || iu < (NU*1) )
-                {
-#pragma omp atomic update
-                  *ref_state( vo_this, sweeper->dims_b, NU,
-                              ix, iy, iz, ie, im, iu ) +=
-                    *ref_volocal( volocal, sweeper->dims_b, NU, NTHREAD_M,
-                                  sweeper_thread_m, iu );
-                }
-              }
-#else /*---USE_OPENMP_VO_ATOMIC---*/
               if( ( ! do_block_init_this ) ||
-                  ( NM*1 > NTHREAD_M*1 && ! ( ia_base==0 ) ) )
+                  ( NM*1 > NTHREAD_M*1 &&
+                    ! ( ia_base==sweeper->iamin_set ) ) )
               {
 #pragma unroll
                 for( iu_base=0; iu_base<NU; iu_base += NTHREAD_U )
@@ -500,14 +490,14 @@ TODO: fix vectorization for this loop.
                   if( (NU*1) % (NTHREAD_U*1) == 0 || iu < NU*1 )
                   {
                     /*---Can use this for non-MIC case:
-                      --- *ref_state( vo_this, sweeper->dims_b, NU,
+                      --- *ref_state( vo_this, dims_b_vo, NU,
                       ---             ix, iy, iz, ie, im, iu ) +=
                     */
                     *ref_state_flat( vo_this,
-                                     sweeper->dims_b.ncell_x,
-                                     sweeper->dims_b.ncell_y,
-                                     sweeper->dims_b.ncell_z,
-                                     sweeper->dims_b.ne,
+                                     dims_b_vo.ncell_x,
+                                     dims_b_vo.ncell_y,
+                                     dims_b_vo.ncell_z,
+                                     dims_b_vo.ne,
                                      NM,
                                      NU,
                                      ix, iy, iz, ie, im, iu ) +=
@@ -526,14 +516,14 @@ TODO: fix vectorization for this loop.
                   if( (NU*1) % (NTHREAD_U*1) == 0 || iu < NU*1 )
                   {
                     /*---Can use this for non-MIC case:
-                      --- *ref_state( vo_this, sweeper->dims_b, NU,
+                      --- *ref_state( vo_this, dims_b_vo, NU,
                       ---             ix, iy, iz, ie, im, iu ) =
                     */
                     *ref_state_flat( vo_this,
-                                     sweeper->dims_b.ncell_x,
-                                     sweeper->dims_b.ncell_y,
-                                     sweeper->dims_b.ncell_z,
-                                     sweeper->dims_b.ne,
+                                     dims_b_vo.ncell_x,
+                                     dims_b_vo.ncell_y,
+                                     dims_b_vo.ncell_z,
+                                     dims_b_vo.ne,
                                      NM,
                                      NU,
                                      ix, iy, iz, ie, im, iu )  =
@@ -542,7 +532,6 @@ TODO: fix vectorization for this loop.
                   }
                 }
               }
-#endif /*---USE_OPENMP_VO_ATOMIC---*/
             }
           } /*---if im---*/
         }
@@ -554,6 +543,467 @@ TODO: fix vectorization for this loop.
 
 }
 
+#ifdef USE_SIMD
+
+/*===========================================================================*/
+/*---Number of energy groups per register tile for the batched transforms---*/
+
+enum{ NE_PER_TILE_SIMD = 2 };
+
+/*===========================================================================*/
+/*---Transform moments to angles for one register tile: SIMD_LEN angles
+     by NU unknowns by ne_tile energy groups---*/
+
+static inline void Sweeper_a_from_m_tile_simd_(
+  const Dimensions               dims_b,
+  const Dimensions               dims_b_vi,
+  P* const __restrict__          vslocal,
+  const P* const __restrict__    vi_this,
+  const P* const __restrict__    a_from_m,
+  const int                      octant,
+  const int                      ie,
+  const int                      ix,
+  const int                      iy,
+  const int                      iz,
+  const int                      ia,
+  const int                      ia_base,
+  const int                      im_base,
+  const int                      im_end,
+  const int                      ne_tile )
+{
+  VecP v[NU*NE_PER_TILE_SIMD];
+
+  int im = 0;
+  int iu = 0;
+  int ie_in_tile = 0;
+
+  Assert( ne_tile > 0 && ne_tile <= NE_PER_TILE_SIMD );
+
+  for( ie_in_tile=0; ie_in_tile<ne_tile; ++ie_in_tile )
+  {
+    for( iu=0; iu<NU; ++iu )
+    {
+      v[iu+NU*ie_in_tile] = VecP_zero();
+    }
+  }
+
+  /*--------------------*/
+  /*---Compute matvec in registers---*/
+  /*--------------------*/
+
+  /*---Each load of a_from_m is reused for all unknowns and energy groups
+       of the tile---*/
+
+  for( im=im_base; im<im_end; ++im )
+  {
+    const VecP a_from_m_this = VecP_load( const_ref_a_from_m_flat(
+                                   a_from_m, NM, dims_b.na, im, ia, octant ) );
+    for( ie_in_tile=0; ie_in_tile<ne_tile; ++ie_in_tile )
+    {
+      for( iu=0; iu<NU; ++iu )
+      {
+        v[iu+NU*ie_in_tile] += a_from_m_this * VecP_broadcast(
+                   *const_ref_state_flat( vi_this,
+                                          dims_b_vi.ncell_x,
+                                          dims_b_vi.ncell_y,
+                                          dims_b_vi.ncell_z,
+                                          dims_b_vi.ne,
+                                          NM,
+                                          NU,
+                                          ix, iy, iz, ie+ie_in_tile, im, iu ) );
+      }
+    }
+  }
+
+  /*--------------------*/
+  /*---Store/update to local memory---*/
+  /*--------------------*/
+
+  for( ie_in_tile=0; ie_in_tile<ne_tile; ++ie_in_tile )
+  {
+    for( iu=0; iu<NU; ++iu )
+    {
+      P* const __restrict__ vslocal_this = ref_vslocal(
+                        vslocal + NTHREAD_A * NU * ie_in_tile,
+                        dims_b, NU, NTHREAD_A, ia-ia_base, iu );
+      VecP_store( vslocal_this, im_base == 0 ? v[iu+NU*ie_in_tile] :
+                          VecP_load( vslocal_this ) + v[iu+NU*ie_in_tile] );
+    }
+  }
+}
+
+/*===========================================================================*/
+/*---Transform angles to moments for one register tile: SIMD_LEN moments
+     by NU unknowns by ne_tile energy groups---*/
+
+static inline void Sweeper_m_from_a_tile_simd_(
+  const Dimensions               dims_b,
+  P* const __restrict__          volocal,
+  const P* const __restrict__    vslocal,
+  const P* const __restrict__    m_from_a,
+  const int                      octant,
+  const int                      im,
+  const int                      im_base,
+  const int                      ia_base,
+  const int                      ia_end,
+  const Bool_t                   is_volocal_assign,
+  const int                      ne_tile )
+{
+  VecP w[NU*NE_PER_TILE_SIMD];
+
+  int ia = 0;
+  int iu = 0;
+  int ie_in_tile = 0;
+
+  Assert( ne_tile > 0 && ne_tile <= NE_PER_TILE_SIMD );
+
+  for( ie_in_tile=0; ie_in_tile<ne_tile; ++ie_in_tile )
+  {
+    for( iu=0; iu<NU; ++iu )
+    {
+      w[iu+NU*ie_in_tile] = VecP_zero();
+    }
+  }
+
+  /*--------------------*/
+  /*---Compute matvec in registers---*/
+  /*--------------------*/
+
+  for( ia=ia_base; ia<ia_end; ++ia )
+  {
+    const VecP m_from_a_this = VecP_load( &m_from_a[
+                     ind_m_from_a_flat( NM, dims_b.na, im, ia, octant ) ] );
+    for( ie_in_tile=0; ie_in_tile<ne_tile; ++ie_in_tile )
+    {
+      for( iu=0; iu<NU; ++iu )
+      {
+        w[iu+NU*ie_in_tile] += m_from_a_this * VecP_broadcast(
+                   *const_ref_vslocal( vslocal + NTHREAD_A * NU * ie_in_tile,
+                                       dims_b, NU, NTHREAD_A, ia-ia_base, iu ) );
+      }
+    }
+  }
+
+  /*--------------------*/
+  /*---Store/update to local memory---*/
+  /*--------------------*/
+
+  for( ie_in_tile=0; ie_in_tile<ne_tile; ++ie_in_tile )
+  {
+    for( iu=0; iu<NU; ++iu )
+    {
+      P* const __restrict__ volocal_this = ref_volocal(
+                        volocal + NTHREAD_M * NU * ie_in_tile,
+                        dims_b, NU, NTHREAD_M, im-im_base, iu );
+      VecP_store( volocal_this, is_volocal_assign ? w[iu+NU*ie_in_tile] :
+                         VecP_load( volocal_this ) + w[iu+NU*ie_in_tile] );
+    }
+  }
+}
+
+/*===========================================================================*/
+/*---Perform a sweep for a cell, explicitly vectorized CPU version---*/
+
+/*---NOTE: on the CPU a single thread performs all the work for a cell,
+     so the angle, moment and unknown thread axes are simply looped.
+     Vector lanes run across angles for the moments-to-angles transform and
+     the solve, and across moments for the angles-to-moments transform,
+     following the layouts of a_from_m and m_from_a respectively.
+     The summation order for every lane is the same as for Sweeper_sweep_cell,
+     including blocking by NTHREAD_A and NTHREAD_M, so the results are
+     bitwise identical.
+
+     A batch of ne_batch consecutive energy groups is processed together,
+     so that the transforms become small matrix-matrix products whose
+     matrix loads are shared by register tiles of NE_PER_TILE_SIMD groups.
+     vslocal and volocal must hold ne_batch groups.
+---*/
+
+static inline void Sweeper_sweep_cell_simd(
+  SweeperLite* __restrict__      sweeper,
+  P* const __restrict__          vo_this,
+  const P* const __restrict__    vi_this,
+  P* const __restrict__          vslocal,
+  P* const __restrict__          volocal,
+  P* const __restrict__          facexy,
+  P* const __restrict__          facexz,
+  P* const __restrict__          faceyz,
+  const P* const __restrict__    a_from_m,
+  const P* const __restrict__    m_from_a,
+  const Quantities* __restrict__ quan,
+  const int                      octant,
+  const int                      iz_base,
+  const int                      octant_in_block,
+  const int                      ie_min,
+  const int                      ne_batch,
+  const int                      ix,
+  const int                      iy,
+  const int                      iz,
+  const Bool_t                   do_block_init_this,
+  const Bool_t                   is_elt_active )
+{
+  const Dimensions dims_b = sweeper->dims_b;
+  const Dimensions dims_b_vi = Sweeper_dims_b_vi( sweeper );
+  const Dimensions dims_b_vo = Sweeper_dims_b_vo( sweeper );
+  const int na = dims_b.na;
+  const int iamin_set = sweeper->iamin_set;
+  const int iamax_set = sweeper->iamax_set;
+
+  int ia_base = 0;
+
+  Assert( dims_b.nm == NM );
+  Assert( ne_batch > 0 && ne_batch <= sweeper->ne_per_batch );
+  Assert( ie_min >= 0 && ie_min+ne_batch <= dims_b.ne );
+
+  if( ! is_elt_active )
+  {
+    return;
+  }
+
+  /*====================*/
+  /*---Master loop over angle blocks of the current angle set---*/
+  /*====================*/
+
+  for( ia_base=iamin_set; ia_base<iamax_set; ia_base += NTHREAD_A )
+  {
+    const int ia_end = imin( ia_base + NTHREAD_A, iamax_set );
+    const int ia_end_vec = ia_base + SIMD_LEN * ( (ia_end-ia_base) / SIMD_LEN );
+
+    int im_base = 0;
+    int ia = 0;
+    int im = 0;
+    int iu = 0;
+    int ie_in_batch = 0;
+
+    /*====================*/
+    /*---Transform moments to angles---*/
+    /*====================*/
+
+    for( im_base=0; im_base<NM; im_base += NTHREAD_M )
+    {
+      const int im_end = imin( im_base + NTHREAD_M, NM );
+
+      for( ia=ia_base; ia<ia_end_vec; ia += SIMD_LEN )
+      {
+        for( ie_in_batch=0; ie_in_batch+NE_PER_TILE_SIMD<=ne_batch;
+                            ie_in_batch += NE_PER_TILE_SIMD )
+        {
+          Sweeper_a_from_m_tile_simd_( dims_b, dims_b_vi,
+            vslocal + NTHREAD_A * NU * ie_in_batch, vi_this, a_from_m,
+            octant, ie_min+ie_in_batch, ix, iy, iz, ia, ia_base,
+            im_base, im_end, NE_PER_TILE_SIMD );
+        }
+        for( ; ie_in_batch<ne_batch; ++ie_in_batch )
+        {
+          Sweeper_a_from_m_tile_simd_( dims_b, dims_b_vi,
+            vslocal + NTHREAD_A * NU * ie_in_batch, vi_this, a_from_m,
+            octant, ie_min+ie_in_batch, ix, iy, iz, ia, ia_base,
+            im_base, im_end, 1 );
+        }
+      } /*---for ia---*/
+
+      /*---Remainder angles---*/
+
+      for( ; ia<ia_end; ++ia )
+      {
+        for( ie_in_batch=0; ie_in_batch<ne_batch; ++ie_in_batch )
+        {
+          const int ie = ie_min + ie_in_batch;
+
+          P v[NU];
+
+          for( iu=0; iu<NU; ++iu )
+          {
+            v[iu] = ((P)0);
+          }
+
+          for( im=im_base; im<im_end; ++im )
+          {
+            const P a_from_m_this = *const_ref_a_from_m_flat(
+                                         a_from_m, NM, na, im, ia, octant );
+            for( iu=0; iu<NU; ++iu )
+            {
+              v[iu] += a_from_m_this *
+                         *const_ref_state_flat( vi_this,
+                                                dims_b_vi.ncell_x,
+                                                dims_b_vi.ncell_y,
+                                                dims_b_vi.ncell_z,
+                                                dims_b_vi.ne,
+                                                NM,
+                                                NU,
+                                                ix, iy, iz, ie, im, iu );
+            }
+          }
+
+          for( iu=0; iu<NU; ++iu )
+          {
+            P* const __restrict__ vslocal_this = ref_vslocal(
+                          vslocal + NTHREAD_A * NU * ie_in_batch,
+                          dims_b, NU, NTHREAD_A, ia-ia_base, iu );
+            *vslocal_this = im_base == 0 ? v[iu] : *vslocal_this + v[iu];
+          }
+        } /*---for ie_in_batch---*/
+      } /*---for ia---*/
+    } /*---for im_base---*/
+
+    /*====================*/
+    /*---Perform solve---*/
+    /*====================*/
+
+    for( ie_in_batch=0; ie_in_batch<ne_batch; ++ie_in_batch )
+    {
+      const int ie = ie_min + ie_in_batch;
+      P* const __restrict__ vslocal_e = vslocal + NTHREAD_A * NU * ie_in_batch;
+
+      for( ia=ia_base; ia<ia_end_vec; ia += SIMD_LEN )
+      {
+        Quantities_solve_simd( quan, vslocal_e,
+                               ia, ia-ia_base, NTHREAD_A,
+                               facexy, facexz, faceyz,
+                               ix, iy, iz, ie,
+                               ix+quan->ix_base, iy+quan->iy_base,
+                        iz+iz_base+quan->iz_base,
+                               octant, octant_in_block,
+                               sweeper->noctant_per_block,
+                               dims_b, sweeper->dims_g );
+      }
+
+      for( ; ia<ia_end; ++ia )
+      {
+        Quantities_solve( quan, vslocal_e,
+                          ia, ia-ia_base, NTHREAD_A,
+                          facexy, facexz, faceyz,
+                          ix, iy, iz, ie,
+                          ix+quan->ix_base, iy+quan->iy_base,
+                        iz+iz_base+quan->iz_base,
+                          octant, octant_in_block,
+                          sweeper->noctant_per_block,
+                          dims_b, sweeper->dims_g,
+                          is_elt_active );
+      }
+    } /*---for ie_in_batch---*/
+
+    /*====================*/
+    /*---Transform angles to moments---*/
+    /*====================*/
+
+    for( im_base=0; im_base<NM; im_base += NTHREAD_M )
+    {
+      const int im_end = imin( im_base + NTHREAD_M, NM );
+      const int im_end_vec = im_base + SIMD_LEN * ( (im_end-im_base) / SIMD_LEN );
+
+      /*---volocal accumulates across angle blocks unless all moments
+           do not fit in one moment block---*/
+      const Bool_t is_volocal_assign = ia_base == iamin_set ||
+                                       NM*1 > NTHREAD_M*1;
+      const Bool_t do_update_vo = ia_base+NTHREAD_A >= iamax_set ||
+                                  NM*1 > NTHREAD_M*1;
+      const Bool_t is_vo_assign = do_block_init_this &&
+                                  ! ( NM*1 > NTHREAD_M*1 &&
+                                      ia_base != iamin_set );
+
+      for( im=im_base; im<im_end_vec; im += SIMD_LEN )
+      {
+        for( ie_in_batch=0; ie_in_batch+NE_PER_TILE_SIMD<=ne_batch;
+                            ie_in_batch += NE_PER_TILE_SIMD )
+        {
+          Sweeper_m_from_a_tile_simd_( dims_b,
+            volocal + NTHREAD_M * NU * ie_in_batch,
+            vslocal + NTHREAD_A * NU * ie_in_batch, m_from_a,
+            octant, im, im_base, ia_base, ia_end, is_volocal_assign,
+            NE_PER_TILE_SIMD );
+        }
+        for( ; ie_in_batch<ne_batch; ++ie_in_batch )
+        {
+          Sweeper_m_from_a_tile_simd_( dims_b,
+            volocal + NTHREAD_M * NU * ie_in_batch,
+            vslocal + NTHREAD_A * NU * ie_in_batch, m_from_a,
+            octant, im, im_base, ia_base, ia_end, is_volocal_assign, 1 );
+        }
+      } /*---for im---*/
+
+      /*---Remainder moments---*/
+
+      for( ; im<im_end; ++im )
+      {
+        for( ie_in_batch=0; ie_in_batch<ne_batch; ++ie_in_batch )
+        {
+          P w[NU];
+
+          for( iu=0; iu<NU; ++iu )
+          {
+            w[iu] = ((P)0);
+          }
+
+          for( ia=ia_base; ia<ia_end; ++ia )
+          {
+            const P m_from_a_this = m_from_a[
+                             ind_m_from_a_flat( NM, na, im, ia, octant ) ];
+            for( iu=0; iu<NU; ++iu )
+            {
+              w[iu] += m_from_a_this *
+                         *const_ref_vslocal(
+                           vslocal + NTHREAD_A * NU * ie_in_batch,
+                           dims_b, NU, NTHREAD_A, ia-ia_base, iu );
+            }
+          }
+
+          for( iu=0; iu<NU; ++iu )
+          {
+            P* const __restrict__ volocal_this = ref_volocal(
+                          volocal + NTHREAD_M * NU * ie_in_batch,
+                          dims_b, NU, NTHREAD_M, im-im_base, iu );
+            *volocal_this = is_volocal_assign ? w[iu] :
+                                                *volocal_this + w[iu];
+          }
+        } /*---for ie_in_batch---*/
+      } /*---for im---*/
+
+      /*====================*/
+      /*---Store/update portion of vo---*/
+      /*====================*/
+
+      if( do_update_vo )
+      {
+        for( ie_in_batch=0; ie_in_batch<ne_batch; ++ie_in_batch )
+        {
+        for( iu=0; iu<NU; ++iu )
+        {
+          P* const __restrict__ vo_this_u = ref_state_flat( vo_this,
+                                                    dims_b_vo.ncell_x,
+                                                    dims_b_vo.ncell_y,
+                                                    dims_b_vo.ncell_z,
+                                                    dims_b_vo.ne,
+                                                    NM,
+                                                    NU,
+                                                    ix, iy, iz,
+                                                    ie_min+ie_in_batch,
+                                                    0, iu );
+          const P* const __restrict__ volocal_u = ref_volocal(
+                          volocal + NTHREAD_M * NU * ie_in_batch,
+                          dims_b, NU, NTHREAD_M, 0, iu );
+          for( im=im_base; im<im_end_vec; im += SIMD_LEN )
+          {
+            const VecP volocal_this = VecP_load( &volocal_u[im-im_base] );
+            VecP_store( &vo_this_u[im], is_vo_assign ? volocal_this :
+                                 VecP_load( &vo_this_u[im] ) + volocal_this );
+          }
+          for( ; im<im_end; ++im )
+          {
+            vo_this_u[im] = is_vo_assign ? volocal_u[im-im_base] :
+                                     vo_this_u[im] + volocal_u[im-im_base];
+          }
+        } /*---for iu---*/
+        } /*---for ie_in_batch---*/
+      }
+    } /*---for im_base---*/
+
+  } /*---for ia_base---*/
+
+}
+
+#endif /*---USE_SIMD---*/
+
 /*===========================================================================*/
 /*---Perform a sweep for a subblock---*/
 
@@ -597,10 +1047,14 @@ TARGET_HD static inline void Sweeper_sweep_subblock(
 {
   /*---Initializations---*/
 
-  const int iemin = (   sweeper->dims.ne *
+  /*---Energy threads share the energy groups of the current chunk---*/
+
+  const int ne_chunk = sweeper->iemax_chunk - sweeper->iemin_chunk;
+
+  const int iemin = sweeper->iemin_chunk + ( ne_chunk *
                       ( Sweeper_thread_e( sweeper )     ) )
                   /     sweeper->nthread_e;
-  const int iemax = (   sweeper->dims.ne *
+  const int iemax = sweeper->iemin_chunk + ( ne_chunk *
                       ( Sweeper_thread_e( sweeper ) + 1 ) )
                   /     sweeper->nthread_e;
 
@@ -664,7 +1118,7 @@ TARGET_HD static inline void Sweeper_sweep_subblock(
         /*---Set boundary condition if needed: xy---*/
         /*--------------------*/
 
-        const int iz_g = iz + iz_base;
+        const int iz_g = iz + iz_base + quan->iz_base;
         if( ( iz_g == 0                         && dir_z == DIR_UP ) ||
             ( iz_g == sweeper->dims_g.ncell_z-1 && dir_z == DIR_DN ) )
         {
@@ -675,13 +1129,14 @@ TARGET_HD static inline void Sweeper_sweep_subblock(
           for( iu=0; iu<NU; ++iu )
           {
             int ia = 0;
-          for( ia=0; ia<sweeper->dims_b.na; ++ia )
+          for( ia=sweeper->iamin_set; ia<sweeper->iamax_set; ++ia )
           {
             *ref_facexy( facexy, sweeper->dims_b, NU,  
                          sweeper->noctant_per_block,
                          ix, iy, ie, ia, iu, octant_in_block )     
                = Quantities_init_facexy( quan, ix_g, iy_g, iz_g-dir_inc_z,
-                                         ie, ia, iu, octant, sweeper->dims_g );
+                                         ie+quan->ie_base, ia, iu, octant,
+                                         sweeper->dims_g );
           }
           }
         }
@@ -695,19 +1150,20 @@ TARGET_HD static inline void Sweeper_sweep_subblock(
             ( iy_g == sweeper->dims_g.ncell_y-1 && dir_y == DIR_DN ) )
         {
           const int ix_g = ix + quan->ix_base;
-          const int iz_g = iz +       iz_base;
+          const int iz_g = iz + iz_base + quan->iz_base;
           /*---TODO: thread/vectorize in u, a---*/
           int iu = 0;
           for( iu=0; iu<NU; ++iu )
           {
             int ia = 0;
-          for( ia=0; ia<sweeper->dims_b.na; ++ia )
+          for( ia=sweeper->iamin_set; ia<sweeper->iamax_set; ++ia )
           {
             *ref_facexz( facexz, sweeper->dims_b, NU,  
                          sweeper->noctant_per_block,
                          ix, iz, ie, ia, iu, octant_in_block )     
                = Quantities_init_facexz( quan, ix_g, iy_g-dir_inc_y, iz_g,
-                                         ie, ia, iu, octant, sweeper->dims_g );
+                                         ie+quan->ie_base, ia, iu, octant,
+                                         sweeper->dims_g );
           }
           }
         }
@@ -721,19 +1177,20 @@ TARGET_HD static inline void Sweeper_sweep_subblock(
             ( ix_g == sweeper->dims_g.ncell_x-1 && dir_x == DIR_DN ) )
         {
           const int iy_g = iy + quan->iy_base;
-          const int iz_g = iz +       iz_base;
+          const int iz_g = iz + iz_base + quan->iz_base;
           /*---TODO: thread/vectorize in u, a---*/
           int iu = 0;
           for( iu=0; iu<NU; ++iu )
           {
             int ia = 0;
-          for( ia=0; ia<sweeper->dims_b.na; ++ia )
+          for( ia=sweeper->iamin_set; ia<sweeper->iamax_set; ++ia )
           {
             *ref_faceyz( faceyz, sweeper->dims_b, NU,  
                          sweeper->noctant_per_block,
                          iy, iz, ie, ia, iu, octant_in_block )     
                = Quantities_init_faceyz( quan, ix_g-dir_inc_x, iy_g, iz_g,
-                                         ie, ia, iu, octant, sweeper->dims_g );
+                                         ie+quan->ie_base, ia, iu, octant,
+                                         sweeper->dims_g );
           }
           }
         }
@@ -754,7 +1211,10 @@ TARGET_HD static inline void Sweeper_sweep_subblock(
   /*---Loop over energy groups owned by this energy thread---*/
   /*--------------------*/
 
-  for( ie=iemin; ie<iemax; ++ie )
+  /*---NOTE: for the batched case each cell is visited once per batch of
+       energy groups, which are then swept together---*/
+
+  for( ie=iemin; ie<iemax; ie+=sweeper->ne_per_batch )
   {
     /*--------------------*/
     /*---Sweep subblock: loop over cells, in proper direction---*/
@@ -791,11 +1251,22 @@ TARGET_HD static inline void Sweeper_sweep_subblock(
       /*--------------------*/
       /*---Perform sweep on cell---*/
       /*--------------------*/
+#ifdef USE_SIMD
+      Sweeper_sweep_cell_simd( sweeper, vo_this, vi_this, vslocal, volocal,
+                          facexy, facexz, faceyz, a_from_m, m_from_a, quan,
+                          octant, iz_base, octant_in_block,
+                          ie, imin( sweeper->ne_per_batch, iemax-ie ),
+                          ix, iy, iz,
+                          do_block_init_this,
+                          is_elt_active );
+#else
+      Assert( sweeper->ne_per_batch == 1 );
       Sweeper_sweep_cell( sweeper, vo_this, vi_this, vilocal, vslocal, volocal,
                           facexy, facexz, faceyz, a_from_m, m_from_a, quan,
                           octant, iz_base, octant_in_block, ie, ix, iy, iz,
                           do_block_init_this,
                           is_elt_active );
+#endif
     }
     }
     } /*---ix/iy/iz---*/
@@ -908,6 +1379,92 @@ TARGET_HD static inline void Sweeper_sweep_semiblock(
                             dir_inc_x, dir_inc_y, dir_inc_z,
                             do_block_init_this,
                             is_octant_active );
+
+    Sweeper_progress( sweeper );
+  }
+  else if( sweeper->nthread_x != 1 )
+  {
+    /*--------------------*/
+    /*---CASE: Hyperplane threading---*/
+    /*--------------------*/
+
+    /*---Cells with equal jx+jy+jz, measured from the upstream corner of
+         the semiblock, are mutually independent; the cells of each
+         such plane are dealt cyclically to the X threads---*/
+
+    const int ncell_x_semiblock = ixmax_semiblock - ixmin_semiblock + 1;
+    const int ncell_y_semiblock = iymax_semiblock - iymin_semiblock + 1;
+    const int ncell_z_semiblock = izmax_semiblock - izmin_semiblock + 1;
+
+    const int nplane = ncell_x_semiblock
+                     + ncell_y_semiblock
+                     + ncell_z_semiblock - 2;
+
+    const int thread_x = Sweeper_thread_x( sweeper );
+
+    const Bool_t is_subblock_active = Bool_true;
+
+    int plane = 0;
+
+    /*--------------------*/
+    /*---Loop over hyperplanes---*/
+    /*--------------------*/
+
+    for( plane=0; plane<nplane; ++plane )
+    {
+      int icell_in_plane = 0;
+      int jz = 0;
+
+      for( jz=imax( 0, plane-(ncell_x_semiblock-1)-(ncell_y_semiblock-1) );
+           jz<=imin( ncell_z_semiblock-1, plane ); ++jz )
+      {
+      int jy = 0;
+      for( jy=imax( 0, plane-jz-(ncell_x_semiblock-1) );
+           jy<=imin( ncell_y_semiblock-1, plane-jz ); ++jy )
+      {
+        if( icell_in_plane % sweeper->nthread_x == thread_x )
+        {
+          const int jx = plane - jz - jy;
+
+          /*---Cell coordinates, in proper direction---*/
+
+          const int ix = dir_x==DIR_UP ? ixmin_semiblock + jx :
+                                         ixmax_semiblock - jx;
+          const int iy = dir_y==DIR_UP ? iymin_semiblock + jy :
+                                         iymax_semiblock - jy;
+          const int iz = dir_z==DIR_UP ? izmin_semiblock + jz :
+                                         izmax_semiblock - jz;
+
+          /*--------------------*/
+          /*---Perform sweep on cell, as a one-cell subblock---*/
+          /*--------------------*/
+
+          Sweeper_sweep_subblock( sweeper, vo_this, vi_this,
+                                  vilocal, vslocal, volocal,
+                                  facexy, facexz, faceyz,
+                                  a_from_m, m_from_a, quan,
+                                  octant, iz_base, octant_in_block,
+                                  ix, ix, iy, iy, iz, iz,
+                                  is_subblock_active,
+                                  ixmin_semiblock, ixmax_semiblock,
+                                  iymin_semiblock, iymax_semiblock,
+                                  izmin_semiblock, izmax_semiblock,
+                                  dir_x, dir_y, dir_z,
+                                  dir_inc_x, dir_inc_y, dir_inc_z,
+                                  do_block_init_this,
+                                  is_octant_active );
+        }
+        ++icell_in_plane;
+      }
+      } /*---jy/jz---*/
+
+      Sweeper_progress( sweeper );
+
+      if( plane != nplane-1 )
+      {
+        Sweeper_sync_x_threads( sweeper );
+      }
+    } /*---plane---*/
   }
   else /*---if tasking---*/
   {
@@ -1027,6 +1584,8 @@ TARGET_HD static inline void Sweeper_sweep_semiblock(
                               do_block_init_this,
                               is_octant_active );
 
+      Sweeper_progress( sweeper );
+
       if( subblockwave != nsubblockwave-1 )
       {
         Sweeper_sync_yz_threads( sweeper );
@@ -1087,6 +1646,186 @@ TARGET_HD static inline void Sweeper_get_semiblock_bounds(
               ?  ( *imax + 1 ) : *imax;
 }                  
 
+/*===========================================================================*/
+/*---Perform a sweep for one semiblock step, for the octants
+     of the current octant thread---*/
+
+TARGET_HD static inline void Sweeper_sweep_semiblock_step(
+  SweeperLite*           sweeper,
+  P* __restrict__        vo,
+  const P* __restrict__  vi,
+  P* __restrict__        facexy,
+  P* __restrict__        facexz,
+  P* __restrict__        faceyz,
+  const P* __restrict__  a_from_m,
+  const P* __restrict__  m_from_a,
+  const Quantities*      quan,
+  const StepInfoAll*     stepinfoall,
+  unsigned long int      do_block_init,
+  int                    semiblock_step )
+{
+  const int noctant_per_block = sweeper->noctant_per_block;
+
+  const int nsemiblock = sweeper->nsemiblock;
+
+  /*--------------------*/
+  /*---Loop over octants in octant block---*/
+  /*---That is, octants that are computed for this semiblock step---*/
+  /*--------------------*/
+
+  /*---Octants are dealt to the octant threads in turn, so that the octants
+       of a thread share their directions along the semiblocked axes---*/
+
+  int octant_in_block = 0;
+
+  for( octant_in_block=Sweeper_thread_octant( sweeper );
+       octant_in_block<noctant_per_block;
+       octant_in_block+=sweeper->nthread_octant )
+  {
+    /*---Get step info---*/
+
+    const StepInfo stepinfo = stepinfoall->stepinfo[octant_in_block];
+
+    const Bool_t is_octant_active = stepinfo.is_active;
+
+    const int dir_x = Dir_x( stepinfo.octant );
+    const int dir_y = Dir_y( stepinfo.octant );
+    const int dir_z = Dir_z( stepinfo.octant );
+
+    /*--------------------*/
+    /*---Compute semiblock bounds---*/
+    /*--------------------*/
+
+    Bool_t is_semiblock_min_x = 0, is_semiblock_max_x = 0;
+    int ixmin_semiblock = 0, ixmax_semiblock = 0, ixmax_semiblock_up2 = 0;
+
+    Sweeper_get_semiblock_bounds(&is_semiblock_min_x, &is_semiblock_max_x,
+      &ixmin_semiblock, &ixmax_semiblock, &ixmax_semiblock_up2,
+      sweeper->dims_b.ncell_x, DIM_X, dir_x, semiblock_step, nsemiblock);
+
+    /*--------------------*/
+
+    Bool_t is_semiblock_min_y = 0, is_semiblock_max_y = 0;
+    int iymin_semiblock = 0, iymax_semiblock = 0, iymax_semiblock_up2 = 0;
+
+    Sweeper_get_semiblock_bounds(&is_semiblock_min_y, &is_semiblock_max_y,
+      &iymin_semiblock, &iymax_semiblock, &iymax_semiblock_up2,
+      sweeper->dims_b.ncell_y, DIM_Y, dir_y, semiblock_step, nsemiblock);
+
+    /*--------------------*/
+
+    Bool_t is_semiblock_min_z = 0, is_semiblock_max_z = 0;
+    int izmin_semiblock = 0, izmax_semiblock = 0, izmax_semiblock_up2 = 0;
+
+    Sweeper_get_semiblock_bounds(&is_semiblock_min_z, &is_semiblock_max_z,
+      &izmin_semiblock, &izmax_semiblock, &izmax_semiblock_up2,
+      sweeper->dims_b.ncell_z, DIM_Z, dir_z, semiblock_step, nsemiblock);
+
+    /*--------------------*/
+    /*---Perform sweep over subblocks in semiblock---*/
+    /*---(for tasking case, this task sweeps one subblock in semiblock---*/
+    /*--------------------*/
+
+    const int iz_base = stepinfo.block_z * sweeper->dims_b.ncell_z;
+
+    const P* vi_this = const_ref_state( vi, sweeper->dims_v, NU,
+                               sweeper->ix_base_subdomain,
+                               sweeper->iy_base_subdomain, iz_base, 0, 0, 0 );
+
+    /*---A private vo buffer is set afresh on every step, since the
+         octant visits each cell of the block exactly once---*/
+
+    P* vo_this = sweeper->is_vo_private ?
+                   Sweeper_vo_private_this_( sweeper, octant_in_block ) :
+                             ref_state( vo, sweeper->dims_v, NU,
+                               sweeper->ix_base_subdomain,
+                               sweeper->iy_base_subdomain, iz_base, 0, 0, 0 );
+
+    const int do_block_init_this = sweeper->is_vo_private ||
+                     !! ( do_block_init &
+                     ( ((unsigned long int)1) <<
+                       ( octant_in_block + noctant_per_block *
+                         semiblock_step ) ) );
+
+    Sweeper_sweep_semiblock( sweeper, vo_this, vi_this,
+                             facexy, facexz, faceyz,
+                             a_from_m, m_from_a,
+                             quan, stepinfo, octant_in_block,
+                             ixmin_semiblock, ixmax_semiblock_up2,
+                             iymin_semiblock, iymax_semiblock_up2,
+                             izmin_semiblock, izmax_semiblock_up2,
+                             do_block_init_this,
+                             is_octant_active );
+
+  } /*---octant_in_block---*/
+}
+
+#ifdef USE_OPENMP_WORKSTEAL
+/*===========================================================================*/
+/*---Arguments of a sweep block shared by its tasks---*/
+
+typedef struct
+{
+  SweeperLite            sweeper;
+  P* __restrict__        vo;
+  const P* __restrict__  vi;
+  P* __restrict__        facexy;
+  P* __restrict__        facexz;
+  P* __restrict__        faceyz;
+  const P* __restrict__  a_from_m;
+  const P* __restrict__  m_from_a;
+  const Quantities*      quan;
+  const StepInfoAll*     stepinfoall;
+  unsigned long int      do_block_init;
+} SweeperTaskContext;
+
+/*===========================================================================*/
+/*---Run one task of the sweep block task graph---*/
+
+static void Sweeper_run_task( void* context_,
+                              int   task )
+{
+  const SweeperTaskContext* const context
+                                       = (const SweeperTaskContext*)context_;
+
+  /*---Private copy, to hold the thread coordinates of this task---*/
+
+  SweeperLite sweeper = context->sweeper;
+
+  int t = task;
+
+  if( task >= Sweeper_task( &sweeper, 0, 0, 0, 0, 0, sweeper.nsemiblock ) )
+  {
+    return;  /*---Join task, no work---*/
+  }
+
+  /*---Decode task number, leaving the semiblock step in t---*/
+
+  sweeper.thread_x      = t % sweeper.nthread_x;
+  t                     = t / sweeper.nthread_x;
+  sweeper.thread_y      = t % sweeper.nthread_y;
+  t                     = t / sweeper.nthread_y;
+  sweeper.thread_z      = t % sweeper.nthread_z;
+  t                     = t / sweeper.nthread_z;
+  sweeper.thread_e      = t % sweeper.nthread_e;
+  t                     = t / sweeper.nthread_e;
+  sweeper.thread_octant = t % sweeper.nthread_octant;
+  t                     = t / sweeper.nthread_octant;
+
+  Assert( task == Sweeper_task( &sweeper, sweeper.thread_x, sweeper.thread_y,
+                   sweeper.thread_z, sweeper.thread_e, sweeper.thread_octant,
+                   t ) );
+
+  Sweeper_sweep_semiblock_step( &sweeper, context->vo, context->vi,
+                                context->facexy, context->facexz,
+                                context->faceyz,
+                                context->a_from_m, context->m_from_a,
+                                context->quan, context->stepinfoall,
+                                context->do_block_init, t );
+}
+
+#endif /*---USE_OPENMP_WORKSTEAL---*/
+
 /*===========================================================================*/
 /*---Perform a sweep for a block, implementation---*/
 
@@ -1109,8 +1848,6 @@ TARGET_HD void Sweeper_sweep_block_impl(
   unsigned long int      do_block_init )
 {
   /*---Declarations---*/
-    const int noctant_per_block = sweeper.noctant_per_block;
-
     const int nsemiblock = sweeper.nsemiblock;
 
     int semiblock_step = 0;
@@ -1149,8 +1886,10 @@ TARGET_HD void Sweeper_sweep_block_impl(
     =    - If nsemiblock==noctant_per_block, then any value of nthread_octant
     =      applied to the OpenMP loop will work ok.
     =    - If nsemiblock<noctant_per_block==nthread_octant, then
-    =      a potential race condition will occur.  This can be fixed by
-    =      making the update of vo at the end of Sweeper_sweep_semiblock atomic.
+    =      a potential race condition will occur.  This is avoided by
+    =      having each octant accumulate into a private block-sized copy
+    =      of vo, summed into vo once the step is complete
+    =      (see Sweeper_reduce_vo_private_).
     =      What is in question here is the overhead of the semiblock loop.
     =      One might want to reduce the number of semiblocks while keeping
     =      noctant_per_block==nthread_octant high to get more thread
@@ -1158,6 +1897,31 @@ TARGET_HD void Sweeper_sweep_block_impl(
     =      wavefront latency.
     =========================================================================*/
 
+#ifdef USE_OPENMP_WORKSTEAL
+    /*--------------------*/
+    /*---Run all semiblock steps as one task graph---*/
+    /*--------------------*/
+
+    /*---Tasks are the same as below; the semiblock steps are ordered
+         by join tasks per energy thread rather than by a team barrier---*/
+
+    SweeperTaskContext context;
+
+    context.sweeper       = sweeper;
+    context.vo            = vo;
+    context.vi            = vi;
+    context.facexy        = facexy;
+    context.facexz        = facexz;
+    context.faceyz        = faceyz;
+    context.a_from_m      = a_from_m;
+    context.m_from_a      = m_from_a;
+    context.quan          = &quan;
+    context.stepinfoall   = &stepinfoall;
+    context.do_block_init = do_block_init;
+
+    TaskRunner_execute( sweeper.taskrunner, sweeper.taskgraph,
+                        Sweeper_run_task, (void*)&context );
+#else
     /*--------------------*/
     /*---Loop over semiblock steps---*/
     /*--------------------*/
@@ -1245,92 +2009,11 @@ TARGET_HD void Sweeper_sweep_block_impl(
       */
 #endif
 
-      /*--------------------*/
-      /*---Loop over octants in octant block---*/
-      /*---That is, octants that are computed for this semiblock step---*/
-      /*--------------------*/
-
-        const int octant_in_block_min =
-                             (   sweeper.noctant_per_block *
-                               ( Sweeper_thread_octant( &sweeper )     ) )
-                           /     sweeper.nthread_octant;
-        const int octant_in_block_max =
-                             (   sweeper.noctant_per_block *
-                               ( Sweeper_thread_octant( &sweeper ) + 1 ) )
-                           /     sweeper.nthread_octant;
-
-        int octant_in_block = 0;
-
-      for( octant_in_block=octant_in_block_min;
-           octant_in_block<octant_in_block_max; ++octant_in_block )
-      {
-        /*---Get step info---*/
-
-        const StepInfo stepinfo = stepinfoall.stepinfo[octant_in_block];
-
-        const Bool_t is_octant_active = stepinfo.is_active;
-
-        const int dir_x = Dir_x( stepinfo.octant );
-        const int dir_y = Dir_y( stepinfo.octant );
-        const int dir_z = Dir_z( stepinfo.octant );
-
-        /*--------------------*/
-        /*---Compute semiblock bounds---*/
-        /*--------------------*/
-
-        Bool_t is_semiblock_min_x = 0, is_semiblock_max_x = 0;
-        int ixmin_semiblock = 0, ixmax_semiblock = 0, ixmax_semiblock_up2 = 0;
-
-        Sweeper_get_semiblock_bounds(&is_semiblock_min_x, &is_semiblock_max_x,
-          &ixmin_semiblock, &ixmax_semiblock, &ixmax_semiblock_up2,
-          sweeper.dims_b.ncell_x, DIM_X, dir_x, semiblock_step, nsemiblock);
-
-        /*--------------------*/
-
-        Bool_t is_semiblock_min_y = 0, is_semiblock_max_y = 0;
-        int iymin_semiblock = 0, iymax_semiblock = 0, iymax_semiblock_up2 = 0;
-
-        Sweeper_get_semiblock_bounds(&is_semiblock_min_y, &is_semiblock_max_y,
-          &iymin_semiblock, &iymax_semiblock, &iymax_semiblock_up2,
-          sweeper.dims_b.ncell_y, DIM_Y, dir_y, semiblock_step, nsemiblock);
-
-        /*--------------------*/
-
-        Bool_t is_semiblock_min_z = 0, is_semiblock_max_z = 0;
-        int izmin_semiblock = 0, izmax_semiblock = 0, izmax_semiblock_up2 = 0;
-
-        Sweeper_get_semiblock_bounds(&is_semiblock_min_z, &is_semiblock_max_z,
-          &izmin_semiblock, &izmax_semiblock, &izmax_semiblock_up2,
-          sweeper.dims_b.ncell_z, DIM_Z, dir_z, semiblock_step, nsemiblock);
-
-        /*--------------------*/
-        /*---Perform sweep over subblocks in semiblock---*/
-        /*---(for tasking case, this task sweeps one subblock in semiblock---*/
-        /*--------------------*/
-
-        const int iz_base = stepinfo.block_z * sweeper.dims_b.ncell_z;
-
-        const P* vi_this = const_ref_state( vi, sweeper.dims, NU, 0, 0,
-                                                            iz_base, 0, 0, 0 );
-        P* vo_this =             ref_state( vo, sweeper.dims, NU, 0, 0,
-                                                            iz_base, 0, 0, 0 );
-
-        const int do_block_init_this = !! ( do_block_init &
-                         ( ((unsigned long int)1) <<
-                           ( octant_in_block + noctant_per_block *
-                             semiblock_step ) ) );
-
-        Sweeper_sweep_semiblock( &sweeper, vo_this, vi_this,
-                                 facexy, facexz, faceyz,
-                                 a_from_m, m_from_a,
-                                 &quan, stepinfo, octant_in_block,
-                                 ixmin_semiblock, ixmax_semiblock_up2,
-                                 iymin_semiblock, iymax_semiblock_up2,
-                                 izmin_semiblock, izmax_semiblock_up2,
-                                 do_block_init_this,
-                                 is_octant_active );
-
-      } /*---octant_in_block---*/
+      Sweeper_sweep_semiblock_step( &sweeper, vo, vi,
+                                    facexy, facexz, faceyz,
+                                    a_from_m, m_from_a,
+                                    &quan, &stepinfoall, do_block_init,
+                                    semiblock_step );
 
 #ifdef USE_OPENMP_TASKS
       /*
@@ -1353,6 +2036,7 @@ TARGET_HD void Sweeper_sweep_block_impl(
 #endif
 
     } /*---semiblock---*/
+#endif /*---USE_OPENMP_WORKSTEAL---*/
 }
 
 /*===========================================================================*/
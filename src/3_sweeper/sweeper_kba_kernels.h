@@ -18,6 +18,10 @@
 #include "pointer_kernels.h"
 #include "quantities_kernels.h"
 
+#ifdef USE_OPENMP_WORKSTEAL
+#include "taskrunner.h"
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -32,18 +36,19 @@ extern "C"
   enum{ IS_USING_OPENMP_THREADS = 0 };
 #endif
 
-#ifdef USE_OPENMP_VO_ATOMIC
-  enum{ IS_USING_OPENMP_VO_ATOMIC = 1 };
-#else
-  enum{ IS_USING_OPENMP_VO_ATOMIC = 0 };
-#endif
-
 #ifdef USE_OPENMP_TASKS
   enum{ IS_USING_OPENMP_TASKS = 1};
 #else
   enum{ IS_USING_OPENMP_TASKS = 0};
 #endif
 
+/*---The work-stealing runtime executes the same subblock tasks as the
+     OpenMP tasks build, in place of omp task---*/
+
+#if defined(USE_OPENMP_WORKSTEAL) && ! defined(USE_OPENMP_TASKS)
+#error "USE_OPENMP_WORKSTEAL requires USE_OPENMP_TASKS"
+#endif
+
 /*---NOTE: these should NOT be accessed outside of the Sweeper pseudo-class---*/
 
 enum{ NTHREAD_DEVICE_U = VEC_LEN <= NU                  ? VEC_LEN :
@@ -69,6 +74,11 @@ enum{ NTHREAD_DEVICE_A = NTHREAD_DEVICE_U * NTHREAD_DEVICE_M };
 #endif
 #endif
 
+/*===========================================================================*/
+/*---Host function called between subblocks, e.g. to progress comm---*/
+
+typedef void (*Sweeper_progress_fn)( void* context );
+
 /*===========================================================================*/
 /*---Lightweight version of Sweeper class for sending to device---*/
 
@@ -77,10 +87,15 @@ typedef struct
   P* __restrict__  vilocal_host_;
   P* __restrict__  vslocal_host_;
   P* __restrict__  volocal_host_;
+  P* __restrict__  vo_private_host_;
+  int*             sync_counter_host_;
 
   Dimensions       dims;
   Dimensions       dims_b;
   Dimensions       dims_g;
+  Dimensions       dims_v;
+  int              ix_base_subdomain;
+  int              iy_base_subdomain;
 
   int              nthread_e;
   int              nthread_octant;
@@ -95,6 +110,15 @@ typedef struct
   int              ncell_x_per_subblock;
   int              ncell_y_per_subblock;
   int              ncell_z_per_subblock;
+  int              ne_per_batch;
+  int              iemin_chunk;
+  int              iemax_chunk;
+  int              iamin_set;
+  int              iamax_set;
+  Bool_t           is_vo_private;
+  Bool_t           is_numa_placement;
+  Sweeper_progress_fn progress_fn;
+  void*            progress_context;
 #ifdef USE_OPENMP_TASKS
   int              thread_e;
   int              thread_octant;
@@ -103,6 +127,10 @@ typedef struct
   int              thread_z;
   char*            task_dependency;
 #endif
+#ifdef USE_OPENMP_WORKSTEAL
+  TaskRunner*      taskrunner;
+  const TaskGraph* taskgraph;
+#endif
 } SweeperLite;
 
 /*===========================================================================*/
@@ -119,6 +147,7 @@ TARGET_HD static inline int Sweeper_thread_e( const SweeperLite* sweeper )
 #else
   Assert( sweeper->nthread_e *
           sweeper->nthread_octant *
+          sweeper->nthread_x *
           sweeper->nthread_y *
           sweeper->nthread_z == 1 || Env_omp_in_parallel() );
   return Env_omp_thread() % sweeper->nthread_e;
@@ -139,6 +168,7 @@ TARGET_HD static inline int Sweeper_thread_octant( const SweeperLite* sweeper )
 #else
   Assert( sweeper->nthread_e *
           sweeper->nthread_octant *
+          sweeper->nthread_x *
           sweeper->nthread_y *
           sweeper->nthread_z == 1 || Env_omp_in_parallel() );
   return ( Env_omp_thread() / sweeper->nthread_e )
@@ -155,7 +185,20 @@ TARGET_HD static inline int Sweeper_thread_x( const SweeperLite* sweeper )
   Assert(sweeper->thread_x >= 0);
   return sweeper->thread_x;
 #else
+#ifdef __CUDA_ARCH__
   return 0;
+#else
+  Assert( sweeper->nthread_e *
+          sweeper->nthread_octant *
+          sweeper->nthread_x *
+          sweeper->nthread_y *
+          sweeper->nthread_z == 1 || Env_omp_in_parallel() );
+  return ( Env_omp_thread() / ( sweeper->nthread_e *
+                                sweeper->nthread_octant *
+                                sweeper->nthread_y *
+                                sweeper->nthread_z )
+                            %   sweeper->nthread_x );
+#endif
 #endif
 }
 
@@ -172,6 +215,7 @@ TARGET_HD static inline int Sweeper_thread_y( const SweeperLite* sweeper )
 #else
   Assert( sweeper->nthread_e *
           sweeper->nthread_octant *
+          sweeper->nthread_x *
           sweeper->nthread_y *
           sweeper->nthread_z == 1 || Env_omp_in_parallel() );
   return ( Env_omp_thread() / ( sweeper->nthread_e *
@@ -194,6 +238,7 @@ TARGET_HD static inline int Sweeper_thread_z( const SweeperLite* sweeper )
 #else
   Assert( sweeper->nthread_e *
           sweeper->nthread_octant *
+          sweeper->nthread_x *
           sweeper->nthread_y *
           sweeper->nthread_z == 1 || Env_omp_in_parallel() );
   return ( Env_omp_thread() / ( sweeper->nthread_e *
@@ -240,6 +285,41 @@ TARGET_HD static inline int Sweeper_thread_u( const SweeperLite* sweeper )
 /*===========================================================================*/
 /*---Thread synchronization---*/
 
+#ifdef USE_OPENMP_THREADS
+/*---Counter of synchronization points passed by a thread---*/
+
+static inline int* Sweeper_sync_counter_( SweeperLite* sweeper,
+  int thread_e, int thread_octant, int thread_x, int thread_y, int thread_z )
+{
+  return sweeper->sync_counter_host_ + ENV_OMP_COUNTER_STRIDE * (
+    thread_e      + sweeper->nthread_e      * (
+    thread_octant + sweeper->nthread_octant * (
+    thread_y      + sweeper->nthread_y      * (
+    thread_z      + sweeper->nthread_z      * (
+    thread_x )))));
+}
+
+/*---------------------------------------------------------------------------*/
+/*---Advance counter of current thread, return the new value---*/
+
+static inline int Sweeper_sync_advance_( SweeperLite* sweeper )
+{
+  int* const counter = Sweeper_sync_counter_( sweeper,
+    Sweeper_thread_e( sweeper ), Sweeper_thread_octant( sweeper ),
+    Sweeper_thread_x( sweeper ), Sweeper_thread_y( sweeper ),
+    Sweeper_thread_z( sweeper ) );
+
+  /*---Only this thread writes its own counter---*/
+  const int value = *counter + 1;
+
+  Env_omp_counter_set( counter, value );
+
+  return value;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+
 TARGET_HD static inline void Sweeper_sync_octant_threads( SweeperLite* sweeper )
 {
 #ifdef __CUDA_ARCH__
@@ -247,9 +327,37 @@ TARGET_HD static inline void Sweeper_sync_octant_threads( SweeperLite* sweeper )
   Env_cuda_sync_threadblock();
 #else
 #ifdef USE_OPENMP_THREADS
-if( sweeper->nthread_octant != 1 )
+if( sweeper->nthread_octant * sweeper->nthread_x *
+    sweeper->nthread_y * sweeper->nthread_z != 1 )
 {
-#pragma omp barrier
+  /*---Wait for the threads sharing this thread's energy groups, which may
+       have written the semiblock(s) to be visited next; threads of other
+       energy groups are independent---*/
+
+  const int value = Sweeper_sync_advance_( sweeper );
+  const int thread_e = Sweeper_thread_e( sweeper );
+
+  int thread_octant = 0;
+  int thread_x = 0;
+  int thread_y = 0;
+  int thread_z = 0;
+
+  for( thread_x=0; thread_x<sweeper->nthread_x; ++thread_x )
+  {
+  for( thread_z=0; thread_z<sweeper->nthread_z; ++thread_z )
+  {
+    for( thread_y=0; thread_y<sweeper->nthread_y; ++thread_y )
+    {
+      for( thread_octant=0; thread_octant<sweeper->nthread_octant;
+                                                             ++thread_octant )
+      {
+        Env_omp_counter_wait( Sweeper_sync_counter_( sweeper,
+                 thread_e, thread_octant, thread_x, thread_y, thread_z ),
+                 value );
+      }
+    }
+  }
+  }
 }
 #endif
 #endif
@@ -266,7 +374,60 @@ TARGET_HD static inline void Sweeper_sync_yz_threads( SweeperLite* sweeper )
 #ifdef USE_OPENMP_THREADS
 if( sweeper->nthread_y != 1 || sweeper->nthread_z != 1 )
 {
-#pragma omp barrier
+  /*---Wait only for the upstream neighbors in the subblock wavefront.
+       In the stacked domain of Sweeper_sweep_semiblock the upstream
+       subblocks of thread y (z) belong to thread y-1 (z-1), and those of
+       thread 0 to the last thread, on an earlier subblock wave---*/
+
+  const int value = Sweeper_sync_advance_( sweeper );
+  const int thread_e      = Sweeper_thread_e( sweeper );
+  const int thread_octant = Sweeper_thread_octant( sweeper );
+  const int thread_y      = Sweeper_thread_y( sweeper );
+  const int thread_z      = Sweeper_thread_z( sweeper );
+
+  if( sweeper->nthread_y != 1 )
+  {
+    Env_omp_counter_wait( Sweeper_sync_counter_( sweeper,
+      thread_e, thread_octant, 0,
+      ( thread_y + sweeper->nthread_y - 1 ) % sweeper->nthread_y, thread_z ),
+      value );
+  }
+  if( sweeper->nthread_z != 1 )
+  {
+    Env_omp_counter_wait( Sweeper_sync_counter_( sweeper,
+      thread_e, thread_octant, 0,
+      thread_y, ( thread_z + sweeper->nthread_z - 1 ) % sweeper->nthread_z ),
+      value );
+  }
+}
+#endif
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+
+TARGET_HD static inline void Sweeper_sync_x_threads( SweeperLite* sweeper )
+{
+#ifdef __CUDA_ARCH__
+  /*---X threads not used for CUDA case---*/
+#else
+#ifdef USE_OPENMP_THREADS
+if( sweeper->nthread_x != 1 )
+{
+  /*---Wait for all threads sharing the current hyperplane, since any of
+       them may have swept an upstream neighbor of a cell on the next---*/
+
+  const int value = Sweeper_sync_advance_( sweeper );
+  const int thread_e      = Sweeper_thread_e( sweeper );
+  const int thread_octant = Sweeper_thread_octant( sweeper );
+
+  int thread_x = 0;
+
+  for( thread_x=0; thread_x<sweeper->nthread_x; ++thread_x )
+  {
+    Env_omp_counter_wait( Sweeper_sync_counter_( sweeper,
+                          thread_e, thread_octant, thread_x, 0, 0 ), value );
+  }
 }
 #endif
 #endif
@@ -286,6 +447,38 @@ TARGET_HD static inline void Sweeper_sync_amu_threads( SweeperLite* sweeper )
 #endif
 }
 
+/*===========================================================================*/
+/*---Call the host progress function, from the main thread only---*/
+
+/*---For work-stealing builds the progress function itself checks for the
+     main thread---*/
+
+TARGET_HD static inline void Sweeper_progress( SweeperLite* sweeper )
+{
+#ifndef __CUDA_ARCH__
+  if( sweeper->progress_fn != NULL && Env_omp_thread() == 0 )
+  {
+    sweeper->progress_fn( sweeper->progress_context );
+  }
+#endif
+}
+
+/*===========================================================================*/
+/*---Per-thread size of v*local arrays on the host---*/
+
+/*---For NUMA placement each thread's part is padded to whole pages, so
+     that it can be first-touched by that thread---*/
+
+enum{ SWEEPER_NP_PER_PAGE = 4096 / sizeof(P) };
+
+TARGET_HD static inline int Sweeper_nlocal_per_thread_(
+                                                 Bool_t is_numa_placement,
+                                                 int    n )
+{
+  return is_numa_placement ?
+         iceil( n, SWEEPER_NP_PER_PAGE ) * SWEEPER_NP_PER_PAGE : n;
+}
+
 /*===========================================================================*/
 /*---Select which part of v*local to use for current thread/block---*/
 
@@ -310,8 +503,9 @@ TARGET_HD static inline P* __restrict__ Sweeper_vilocal_this_(
   ;
 #else
   return sweeper->vilocal_host_
-    + NTHREAD_M *
-      NU *
+    + Sweeper_nlocal_per_thread_( sweeper->is_numa_placement,
+        NTHREAD_M *
+        NU ) *
       ( Sweeper_thread_octant( sweeper ) + sweeper->nthread_octant * (
         Sweeper_thread_x(      sweeper ) + sweeper->nthread_x      * (
         Sweeper_thread_y(      sweeper ) + sweeper->nthread_y      * (
@@ -345,8 +539,10 @@ TARGET_HD static inline P* __restrict__ Sweeper_vslocal_this_(
   ;
 #else
   return sweeper->vslocal_host_
-    + NTHREAD_A *
-      NU *
+    + Sweeper_nlocal_per_thread_( sweeper->is_numa_placement,
+        NTHREAD_A *
+        NU *
+        sweeper->ne_per_batch ) *
       ( Sweeper_thread_octant( sweeper ) + sweeper->nthread_octant * (
         Sweeper_thread_x(      sweeper ) + sweeper->nthread_x      * (
         Sweeper_thread_y(      sweeper ) + sweeper->nthread_y      * (
@@ -380,8 +576,10 @@ TARGET_HD static inline P* __restrict__ Sweeper_volocal_this_(
   ;
 #else
   return sweeper->volocal_host_
-    + NTHREAD_M *
-      NU *
+    + Sweeper_nlocal_per_thread_( sweeper->is_numa_placement,
+        NTHREAD_M *
+        NU *
+        sweeper->ne_per_batch ) *
       ( Sweeper_thread_octant( sweeper ) + sweeper->nthread_octant * (
         Sweeper_thread_x(      sweeper ) + sweeper->nthread_x      * (
         Sweeper_thread_y(      sweeper ) + sweeper->nthread_y      * (
@@ -392,6 +590,51 @@ TARGET_HD static inline P* __restrict__ Sweeper_volocal_this_(
 #endif
 }
 
+/*===========================================================================*/
+/*---Private block-sized vo buffer of an octant, if vo is privatized---*/
+
+TARGET_HD static inline P* __restrict__ Sweeper_vo_private_this_(
+                                                   SweeperLite* sweeper,
+                                                   int          octant_in_block )
+{
+  Assert( sweeper->is_vo_private );
+  Assert( octant_in_block >= 0 &&
+          octant_in_block < sweeper->noctant_per_block );
+
+  return sweeper->vo_private_host_
+    + ( (size_t)sweeper->dims_b.ncell_x ) *
+      ( (size_t)sweeper->dims_b.ncell_y ) *
+      ( (size_t)sweeper->dims_b.ncell_z ) *
+      ( (size_t)sweeper->dims_b.ne ) *
+      ( (size_t)sweeper->dims_b.nm ) *
+      ( (size_t)NU ) *
+      octant_in_block;
+}
+
+/*===========================================================================*/
+/*---Layout of a block of the state vectors as stored---*/
+
+/*---The state vectors hold the whole block of the proc, of which a
+     subdomain sweeps only part, so they are indexed with the strides
+     of dims_v---*/
+
+TARGET_HD static inline Dimensions Sweeper_dims_b_vi(
+                                               const SweeperLite* sweeper )
+{
+  Dimensions result = sweeper->dims_v;
+  result.ncell_z = sweeper->dims_b.ncell_z;
+  return result;
+}
+
+/*---------------------------------------------------------------------------*/
+
+TARGET_HD static inline Dimensions Sweeper_dims_b_vo(
+                                               const SweeperLite* sweeper )
+{
+  return sweeper->is_vo_private ? sweeper->dims_b :
+                                  Sweeper_dims_b_vi( sweeper );
+}
+
 /*===========================================================================*/
 /*---Helper functions---*/
 
@@ -437,6 +680,41 @@ static inline char* Sweeper_task_dependency( SweeperLite* sweeperlite,
 }
 #endif
 
+/*---------------------------------------------------------------------------*/
+
+#ifdef USE_OPENMP_WORKSTEAL
+/*---Task graph numbering: one task per subblock thread and semiblock step,
+     followed by one join task per energy thread between semiblock steps---*/
+
+static inline int Sweeper_task( const SweeperLite* sweeperlite,
+  int thread_x, int thread_y, int thread_z, int thread_e, int thread_octant,
+  int semiblock_step )
+{
+  return thread_x      + sweeperlite->nthread_x      * (
+         thread_y      + sweeperlite->nthread_y      * (
+         thread_z      + sweeperlite->nthread_z      * (
+         thread_e      + sweeperlite->nthread_e      * (
+         thread_octant + sweeperlite->nthread_octant * (
+         semiblock_step )))));
+}
+
+/*---------------------------------------------------------------------------*/
+
+static inline int Sweeper_task_join( const SweeperLite* sweeperlite,
+  int thread_e, int semiblock_step )
+{
+  return Sweeper_task( sweeperlite, 0, 0, 0, 0, 0, sweeperlite->nsemiblock )
+         + thread_e + sweeperlite->nthread_e * semiblock_step;
+}
+
+/*---------------------------------------------------------------------------*/
+
+static inline int Sweeper_ntask( const SweeperLite* sweeperlite )
+{
+  return Sweeper_task_join( sweeperlite, 0, sweeperlite->nsemiblock - 1 );
+}
+#endif
+
 /*===========================================================================*/
 /*---Perform a sweep for a block, implementation---*/
 
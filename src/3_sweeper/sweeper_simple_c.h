@@ -77,6 +77,19 @@ void Sweeper_destroy( Sweeper* sweeper,
   sweeper->faceyz  = NULL;
 }
 
+/*===========================================================================*/
+/*---Place a state vector in memory near the threads that will use it---*/
+
+void Sweeper_place_state( Sweeper*        sweeper,
+                          P* __restrict__ v,
+                          Env*            env )
+{
+  Assert( sweeper );
+  Assert( v );
+
+  /*---Nothing to do, as this version is not threaded---*/
+}
+
 /*===========================================================================*/
 /*---Perform a sweep---*/
 
@@ -277,6 +290,29 @@ void Sweeper_sweep(
 
 } /*---sweep---*/
 
+/*===========================================================================*/
+/*---Perform several sweeps, each taking the result of the last as input---*/
+
+void Sweeper_sweep_iterations(
+  Sweeper*               sweeper,
+  Pointer*               vo,
+  Pointer*               vi,
+  int                    niterations,
+  const Quantities*      quan,
+  Env*                   env )
+{
+  int iteration = 0;
+
+  for( iteration=0; iteration<niterations; ++iteration )
+  {
+    Sweeper_sweep( sweeper,
+                   iteration%2==0 ? vo : vi,
+                   iteration%2==0 ? vi : vo,
+                   quan,
+                   env );
+  }
+}
+
 /*===========================================================================*/
 
 #ifdef __cplusplus
@@ -71,6 +71,13 @@ static int Sweeper_noctant_per_block( const Sweeper* sweeper )
 void Sweeper_destroy( Sweeper* sweeper,
                       Env*     env );
 
+/*===========================================================================*/
+/*---Place a state vector in memory near the threads that will use it---*/
+
+void Sweeper_place_state( Sweeper*        sweeper,
+                          P* __restrict__ v,
+                          Env*            env );
+
 /*===========================================================================*/
 /*---Perform a sweep---*/
 
@@ -81,6 +88,17 @@ void Sweeper_sweep(
   const Quantities*      quan,
   Env*                   env );
 
+/*===========================================================================*/
+/*---Perform several sweeps, each taking the result of the last as input---*/
+
+void Sweeper_sweep_iterations(
+  Sweeper*               sweeper,
+  Pointer*               vo,
+  Pointer*               vi,
+  int                    niterations,
+  const Quantities*      quan,
+  Env*                   env );
+
 /*===========================================================================*/
 
 #ifdef __cplusplus
@@ -0,0 +1,297 @@
+/*---------------------------------------------------------------------------*/
+/*!
+ * \file   sweepplan_kba.c
+ * \brief  Definitions for precomputed sweep step plan.
+ * \note   Copyright (C) 2014 Oak Ridge National Laboratory, UT-Battelle, LLC.
+ */
+/*---------------------------------------------------------------------------*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "env.h"
+#include "definitions.h"
+#include "stepscheduler_kba.h"
+#include "sweeper_kba_kernels.h"
+#include "sweepplan_kba.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*===========================================================================*/
+/*---Bit in comm flags for a given send/recv axis and direction---*/
+/*---pseudo-private member function---*/
+
+static int SweepPlan_comm_bit_( Bool_t is_send,
+                                int    axis,
+                                int    dir_ind )
+{
+  Assert( axis >= 0 && axis < NDIM );
+  Assert( dir_ind >= 0 && dir_ind < 2 );
+
+  return 1 << ( axis + NDIM * ( dir_ind + 2 * ( is_send ? 0 : 1 ) ) );
+}
+
+/*===========================================================================*/
+/*---Null object---*/
+
+SweepPlan SweepPlan_null()
+{
+  SweepPlan result;
+  memset( (void*)&result, 0, sizeof(SweepPlan) );
+  return result;
+}
+
+/*===========================================================================*/
+/*---Pseudo-constructor for SweepPlan struct---*/
+
+void SweepPlan_create( SweepPlan*           sweepplan,
+                       const StepScheduler* stepscheduler,
+                       int                  nsemiblock,
+                       Env*                 env )
+{
+  const int nstep             = StepScheduler_nstep( stepscheduler );
+  const int noctant_per_block = StepScheduler_noctant_per_block(
+                                                               stepscheduler );
+  const int nblock_z          = StepScheduler_nblock_z( stepscheduler );
+
+  const int proc_x = StepScheduler_proc_x( stepscheduler );
+  const int proc_y = StepScheduler_proc_y( stepscheduler );
+  const int proc_z = Env_proc_z_this( env );
+
+  int step = 0;
+  int octant_in_block = 0;
+  int semiblock_step = 0;
+  int i = 0;
+
+  /*---Running tally of which semiblocks of each block are initialized---*/
+  int* is_block_init = malloc_host_int( nblock_z );
+
+  Insist( noctant_per_block * nsemiblock <=
+          (int)( 8 * sizeof(unsigned long int) )
+          ? "Too many octants and semiblocks for init mask" : 0 );
+
+  sweepplan->nstep_             = nstep;
+  sweepplan->noctant_per_block_ = noctant_per_block;
+  sweepplan->nsemiblock_        = nsemiblock;
+
+  sweepplan->stepinfoall_ = (StepInfoAll*)
+                                     malloc( nstep * sizeof( StepInfoAll ) );
+  sweepplan->do_block_init_ = (unsigned long int*)
+                               malloc( nstep * sizeof( unsigned long int ) );
+  sweepplan->comm_flags_ = malloc_host_int( ( nstep + 1 ) *
+                                            noctant_per_block );
+
+  Insist( sweepplan->stepinfoall_ && sweepplan->do_block_init_
+          ? "Memory allocation failure" : 0 );
+
+  for( i=0; i<nblock_z; ++i )
+  {
+    is_block_init[i] = 0;
+  }
+
+  /*====================*/
+  /*---Loop over steps---*/
+  /*====================*/
+
+  for( step=0; step<nstep; ++step )
+  {
+    StepInfoAll* stepinfoall = & sweepplan->stepinfoall_[step];
+    unsigned long int do_block_init = 0;
+
+    /*---Tabulate stepinfo for required octants---*/
+
+    for( octant_in_block=0; octant_in_block<NOCTANT; ++octant_in_block )
+    {
+      stepinfoall->stepinfo[octant_in_block].block_z   = 0;
+      stepinfoall->stepinfo[octant_in_block].octant    = 0;
+      stepinfoall->stepinfo[octant_in_block].is_active = Bool_false;
+    }
+
+    for( octant_in_block=0; octant_in_block<noctant_per_block;
+                                                            ++octant_in_block )
+    {
+      stepinfoall->stepinfo[octant_in_block] = StepScheduler_stepinfo(
+           stepscheduler, step, octant_in_block, proc_x, proc_y, proc_z );
+    }
+
+    /*---Tabulate initialization schedule---*/
+    /*---Determine whether this is the first calculation for this sweep step
+         and semiblock step - in which case set values rather than add
+         values---*/
+
+    for( semiblock_step=0; semiblock_step<nsemiblock; ++semiblock_step )
+    {
+      for( octant_in_block=0; octant_in_block<noctant_per_block;
+                                                            ++octant_in_block )
+      {
+        const StepInfo stepinfo = stepinfoall->stepinfo[octant_in_block];
+        if( stepinfo.is_active )
+        {
+          const Bool_t is_semiblock_min_x = ! is_axis_semiblocked(
+                                                       nsemiblock, DIM_X ) ||
+            is_semiblock_min_when_semiblocked( nsemiblock, semiblock_step,
+                                         DIM_X, Dir_x( stepinfo.octant ) );
+          const Bool_t is_semiblock_min_y = ! is_axis_semiblocked(
+                                                       nsemiblock, DIM_Y ) ||
+            is_semiblock_min_when_semiblocked( nsemiblock, semiblock_step,
+                                         DIM_Y, Dir_y( stepinfo.octant ) );
+          const Bool_t is_semiblock_min_z = ! is_axis_semiblocked(
+                                                       nsemiblock, DIM_Z ) ||
+            is_semiblock_min_when_semiblocked( nsemiblock, semiblock_step,
+                                         DIM_Z, Dir_z( stepinfo.octant ) );
+
+          /*---Which semiblock is being processed, according to a uniform
+               direction-independent numbering scheme---*/
+
+          const int semiblock_num = ( is_semiblock_min_x ? 0 : 1 ) + 2 * (
+                                    ( is_semiblock_min_y ? 0 : 1 ) + 2 * (
+                                    ( is_semiblock_min_z ? 0 : 1 ) ));
+
+          if( ! ( is_block_init[ stepinfo.block_z ] & ( 1 << semiblock_num ) ) )
+          {
+            do_block_init |= ( ((unsigned long int)1) <<
+                               ( octant_in_block + noctant_per_block *
+                                 semiblock_step ) );
+            is_block_init[ stepinfo.block_z ] |= ( 1 << semiblock_num );
+          }
+        }
+      } /*---octant_in_block---*/
+    } /*---semiblock---*/
+
+    sweepplan->do_block_init_[step] = do_block_init;
+  } /*---step---*/
+
+  /*====================*/
+  /*---Tabulate face communication, including step -1 for pipeline fill---*/
+  /*====================*/
+
+  for( step=-1; step<nstep; ++step )
+  {
+    for( octant_in_block=0; octant_in_block<noctant_per_block;
+                                                            ++octant_in_block )
+    {
+      int flags = 0;
+      int axis = 0;
+      for( axis=0; axis<NDIM; ++axis )
+      {
+        int dir_ind = 0;
+        for( dir_ind=0; dir_ind<2; ++dir_ind )
+        {
+          if( StepScheduler_must_do_send( (StepScheduler*)stepscheduler,
+                                   step, axis, dir_ind, octant_in_block, env ) )
+          {
+            flags |= SweepPlan_comm_bit_( Bool_true, axis, dir_ind );
+          }
+          if( StepScheduler_must_do_recv( (StepScheduler*)stepscheduler,
+                                   step, axis, dir_ind, octant_in_block, env ) )
+          {
+            flags |= SweepPlan_comm_bit_( Bool_false, axis, dir_ind );
+          }
+        }
+      }
+      sweepplan->comm_flags_[ octant_in_block + noctant_per_block *
+                                                         ( step + 1 ) ] = flags;
+    }
+  }
+
+  free_host_int( is_block_init );
+}
+
+/*===========================================================================*/
+/*---Pseudo-destructor for SweepPlan struct---*/
+
+void SweepPlan_destroy( SweepPlan* sweepplan )
+{
+  if( sweepplan->stepinfoall_ )
+  {
+    free( (void*) sweepplan->stepinfoall_ );
+  }
+  if( sweepplan->do_block_init_ )
+  {
+    free( (void*) sweepplan->do_block_init_ );
+  }
+  if( sweepplan->comm_flags_ )
+  {
+    free_host_int( sweepplan->comm_flags_ );
+  }
+
+  *sweepplan = SweepPlan_null();
+}
+
+/*===========================================================================*/
+/*---Number of kba parallel steps---*/
+
+int SweepPlan_nstep( const SweepPlan* sweepplan )
+{
+  return sweepplan->nstep_;
+}
+
+/*===========================================================================*/
+/*---Information describing a sweep step for each octant in block---*/
+
+const StepInfoAll* SweepPlan_stepinfoall( const SweepPlan* sweepplan,
+                                          int              step )
+{
+  Assert( step >= 0 && step < sweepplan->nstep_ );
+
+  return & sweepplan->stepinfoall_[step];
+}
+
+/*===========================================================================*/
+/*---Mask indicating which (octant_in_block, semiblock_step) pairs are the
+     first to write a semiblock of a block, thus set rather than add vo---*/
+
+unsigned long int SweepPlan_do_block_init( const SweepPlan* sweepplan,
+                                           int              step )
+{
+  Assert( step >= 0 && step < sweepplan->nstep_ );
+
+  return sweepplan->do_block_init_[step];
+}
+
+/*===========================================================================*/
+/*---Determine whether to send a face computed at step, used at step+1---*/
+
+Bool_t SweepPlan_must_do_send( const SweepPlan* sweepplan,
+                               int              step,
+                               int              axis,
+                               int              dir_ind,
+                               int              octant_in_block )
+{
+  Assert( octant_in_block >= 0 &&
+          octant_in_block < sweepplan->noctant_per_block_ );
+
+  return step >= -1 && step < sweepplan->nstep_ &&
+    ( sweepplan->comm_flags_[ octant_in_block + sweepplan->noctant_per_block_ *
+                                                            ( step + 1 ) ] &
+      SweepPlan_comm_bit_( Bool_true, axis, dir_ind ) ) != 0;
+}
+
+/*===========================================================================*/
+/*---Determine whether to recv a face computed at step, used at step+1---*/
+
+Bool_t SweepPlan_must_do_recv( const SweepPlan* sweepplan,
+                               int              step,
+                               int              axis,
+                               int              dir_ind,
+                               int              octant_in_block )
+{
+  Assert( octant_in_block >= 0 &&
+          octant_in_block < sweepplan->noctant_per_block_ );
+
+  return step >= -1 && step < sweepplan->nstep_ &&
+    ( sweepplan->comm_flags_[ octant_in_block + sweepplan->noctant_per_block_ *
+                                                            ( step + 1 ) ] &
+      SweepPlan_comm_bit_( Bool_false, axis, dir_ind ) ) != 0;
+}
+
+/*===========================================================================*/
+
+#ifdef __cplusplus
+} /*---extern "C"---*/
+#endif
+
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1 @@
+./sweepplan_kba.c
\ No newline at end of file
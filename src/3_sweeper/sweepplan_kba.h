@@ -0,0 +1,105 @@
+/*---------------------------------------------------------------------------*/
+/*!
+ * \file   sweepplan_kba.h
+ * \brief  Declarations for precomputed sweep step plan.
+ * \note   Copyright (C) 2014 Oak Ridge National Laboratory, UT-Battelle, LLC.
+ */
+/*---------------------------------------------------------------------------*/
+
+#ifndef _sweepplan_kba_h_
+#define _sweepplan_kba_h_
+
+#include "env.h"
+#include "definitions.h"
+#include "stepscheduler_kba.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*===========================================================================*/
+/*---Struct with tabulated per-step schedule info for a sweep---*/
+
+/*---The plan is built once from the StepScheduler for the current process
+     and then consulted on every step of every sweep, so that the
+     schedule logic is not reevaluated while sweeping.
+---*/
+
+typedef struct
+{
+  int                 nstep_;
+  int                 noctant_per_block_;
+  int                 nsemiblock_;
+  /*---Indexed by step---*/
+  StepInfoAll*        stepinfoall_;
+  /*---Indexed by step---*/
+  unsigned long int*  do_block_init_;
+  /*---Indexed by octant_in_block + noctant_per_block * ( step + 1 ),
+       for steps -1 ... nstep-1---*/
+  int*                comm_flags_;
+} SweepPlan;
+
+/*===========================================================================*/
+/*---Null object---*/
+
+SweepPlan SweepPlan_null(void);
+
+/*===========================================================================*/
+/*---Pseudo-constructor for SweepPlan struct---*/
+
+void SweepPlan_create( SweepPlan*           sweepplan,
+                       const StepScheduler* stepscheduler,
+                       int                  nsemiblock,
+                       Env*                 env );
+
+/*===========================================================================*/
+/*---Pseudo-destructor for SweepPlan struct---*/
+
+void SweepPlan_destroy( SweepPlan* sweepplan );
+
+/*===========================================================================*/
+/*---Number of kba parallel steps---*/
+
+int SweepPlan_nstep( const SweepPlan* sweepplan );
+
+/*===========================================================================*/
+/*---Information describing a sweep step for each octant in block---*/
+
+const StepInfoAll* SweepPlan_stepinfoall( const SweepPlan* sweepplan,
+                                          int              step );
+
+/*===========================================================================*/
+/*---Mask indicating which (octant_in_block, semiblock_step) pairs are the
+     first to write a semiblock of a block, thus set rather than add vo---*/
+
+unsigned long int SweepPlan_do_block_init( const SweepPlan* sweepplan,
+                                           int              step );
+
+/*===========================================================================*/
+/*---Determine whether to send a face computed at step, used at step+1---*/
+
+Bool_t SweepPlan_must_do_send( const SweepPlan* sweepplan,
+                               int              step,
+                               int              axis,
+                               int              dir_ind,
+                               int              octant_in_block );
+
+/*===========================================================================*/
+/*---Determine whether to recv a face computed at step, used at step+1---*/
+
+Bool_t SweepPlan_must_do_recv( const SweepPlan* sweepplan,
+                               int              step,
+                               int              axis,
+                               int              dir_ind,
+                               int              octant_in_block );
+
+/*===========================================================================*/
+
+#ifdef __cplusplus
+} /*---extern "C"---*/
+#endif
+
+#endif /*---_sweepplan_kba_h_---*/
+
+/*---------------------------------------------------------------------------*/
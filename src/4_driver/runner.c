@@ -45,6 +45,109 @@ void Runner_destroy( Runner* runner )
 {
 }
 
+/*===========================================================================*/
+/*---Face bytes sent in a sweep to neighbors on and off this proc's node---*/
+/*---pseudo-private member function---*/
+
+/*---Over the whole sweep, the faces of an octant sent to the downstream
+     neighbor along an axis cover the full face of the subdomain.
+---*/
+
+static void Runner_face_bytes_( Dimensions dims,
+                                Env*       env,
+                                double*    bytes_on_node,
+                                double*    bytes_off_node )
+{
+  const int proc_x = Env_proc_x_this( env );
+  const int proc_y = Env_proc_y_this( env );
+  const int proc_z = Env_proc_z_this( env );
+
+  const double size_face[NDIM] = {
+    ( (double) dims.ncell_y ) * dims.ncell_z * dims.ne * dims.na * NU,
+    ( (double) dims.ncell_x ) * dims.ncell_z * dims.ne * dims.na * NU,
+    ( (double) dims.ncell_x ) * dims.ncell_y * dims.ne * dims.na * NU };
+
+  int octant = 0;
+  int axis = 0;
+
+  *bytes_on_node = 0;
+  *bytes_off_node = 0;
+
+  for( octant=0; octant<NOCTANT; ++octant )
+  for( axis=0; axis<NDIM; ++axis )
+  {
+    const int inc_x = axis==0 ? Dir_inc( Dir_x( octant ) ) : 0;
+    const int inc_y = axis==1 ? Dir_inc( Dir_y( octant ) ) : 0;
+    const int inc_z = axis==2 ? Dir_inc( Dir_z( octant ) ) : 0;
+
+    const Bool_t has_proc_send =
+                 proc_x+inc_x >= 0 && proc_x+inc_x < Env_nproc_x( env ) &&
+                 proc_y+inc_y >= 0 && proc_y+inc_y < Env_nproc_y( env ) &&
+                 proc_z+inc_z >= 0 && proc_z+inc_z < Env_nproc_z( env );
+
+    if( has_proc_send )
+    {
+      const int proc = Env_proc( env, proc_x+inc_x, proc_y+inc_y,
+                                      proc_z+inc_z );
+      if( Env_proc_node( env, proc ) >= 0 )
+      {
+        *bytes_on_node += size_face[axis] * sizeof(P);
+      }
+      else
+      {
+        *bytes_off_node += size_face[axis] * sizeof(P);
+      }
+    }
+  }
+}
+
+/*===========================================================================*/
+/*---Pack the state vectors of several right hand sides into one---*/
+/*---pseudo-private member function---*/
+
+/*---v_rhs holds nrhs state vectors of dims_rhs; v is interleaved along
+     the energy axis, as set out in pack_state_rhs---*/
+
+static void Runner_pack_rhs_( Pointer*   v,
+                              Pointer*   v_rhs,
+                              int        nrhs,
+                              Dimensions dims_rhs )
+{
+  const P** const v_rhs_h = (const P**)malloc( nrhs * sizeof(const P*) );
+  int irhs = 0;
+
+  for( irhs=0; irhs<nrhs; ++irhs )
+  {
+    v_rhs_h[irhs] = Pointer_h( &v_rhs[irhs] );
+  }
+
+  pack_state_rhs( Pointer_h( v ), v_rhs_h, dims_rhs, NU, nrhs );
+
+  free( (void*)v_rhs_h );
+}
+
+/*===========================================================================*/
+/*---Unpack the state vectors of several right hand sides from one---*/
+/*---pseudo-private member function---*/
+
+static void Runner_unpack_rhs_( Pointer*   v_rhs,
+                                Pointer*   v,
+                                int        nrhs,
+                                Dimensions dims_rhs )
+{
+  P** const v_rhs_h = (P**)malloc( nrhs * sizeof(P*) );
+  int irhs = 0;
+
+  for( irhs=0; irhs<nrhs; ++irhs )
+  {
+    v_rhs_h[irhs] = Pointer_h( &v_rhs[irhs] );
+  }
+
+  unpack_state_rhs( v_rhs_h, Pointer_h( v ), dims_rhs, NU, nrhs );
+
+  free( (void*)v_rhs_h );
+}
+
 /*===========================================================================*/
 /*---Perform run---*/
 
@@ -57,14 +160,19 @@ void Runner_run_case( Runner* runner, Arguments* args, Env* env )
   Quantities  quan;
   Sweeper     sweeper = Sweeper_null();
 
-  Pointer vi = Pointer_null();
-  Pointer vo = Pointer_null();
+  Pointer* vi_rhs = NULL;   /*---state vectors of each right hand side---*/
+  Pointer* vo_rhs = NULL;
+  Pointer  vi_packed = Pointer_null();  /*---all of them, interleaved---*/
+  Pointer  vo_packed = Pointer_null();
+  Pointer* vi     = NULL;   /*---state vectors swept---*/
+  Pointer* vo     = NULL;
+  int      irhs   = 0;
 
   runner->normsq     = P_zero();
   runner->normsqdiff = P_zero();
 
-  int iteration   = 0;
   int niterations = 0;
+  int nrhs        = 0;
 
   Timer t1             = 0;
   Timer t2             = 0;
@@ -74,6 +182,8 @@ void Runner_run_case( Runner* runner, Arguments* args, Env* env )
   runner->floprate   = 0;
   runner->normsq     = 0;
   runner->normsqdiff = 0;
+  runner->face_bytes_on_node  = 0;
+  runner->face_bytes_off_node = 0;
 
   /*---Define problem specs---*/
 
@@ -83,6 +193,7 @@ void Runner_run_case( Runner* runner, Arguments* args, Env* env )
   dims_g.ne   = Arguments_consume_int_or_default( args, "--ne", 30 );
   dims_g.na   = Arguments_consume_int_or_default( args, "--na", 33 );
   niterations = Arguments_consume_int_or_default( args, "--niterations", 1 );
+  nrhs        = Arguments_consume_int_or_default( args, "--nrhs", 1 );
   dims_g.nm   = NM;
 
   Insist( dims_g.ncell_x > 0 ? "Invalid ncell_x supplied." : 0 );
@@ -92,6 +203,7 @@ void Runner_run_case( Runner* runner, Arguments* args, Env* env )
   Insist( dims_g.nm > 0      ? "Invalid nm supplied." : 0 );
   Insist( dims_g.na > 0      ? "Invalid na supplied." : 0 );
   Insist( niterations >= 0   ? "Invalid iteration count supplied." : 0 );
+  Insist( nrhs > 0           ? "Invalid nrhs supplied." : 0 );
 
   /*---Initialize (local) dimensions - domain decomposition---*/
 
@@ -105,32 +217,34 @@ void Runner_run_case( Runner* runner, Arguments* args, Env* env )
       ( ( Env_proc_y_this( env ) + 1 ) * dims_g.ncell_y ) / Env_nproc_y( env )
     - ( ( Env_proc_y_this( env )     ) * dims_g.ncell_y ) / Env_nproc_y( env );
 
-  /*---Initialize quantities---*/
+  dims.ncell_z =
+      ( ( Env_proc_z_this( env ) + 1 ) * dims_g.ncell_z ) / Env_nproc_z( env )
+    - ( ( Env_proc_z_this( env )     ) * dims_g.ncell_z ) / Env_nproc_z( env );
 
-  Quantities_create( &quan, dims, env );
+  /*---Energy groups are independent, so each energy slice is swept
+       separately, by its own set of procs---*/
 
-  /*---Allocate arrays---*/
+  dims.ne =
+      ( ( Env_proc_e_this( env ) + 1 ) * dims_g.ne ) / Env_nproc_e( env )
+    - ( ( Env_proc_e_this( env )     ) * dims_g.ne ) / Env_nproc_e( env );
 
-  Pointer_create( &vi, Dimensions_size_state( dims, NU ),
-                                            Env_cuda_is_using_device( env ) );
-  Pointer_set_pinned( &vi, Bool_true );
-  Pointer_allocate( &vi );
+  Insist( dims.ne > 0 ? "Currently required that all energy slices be nonempty"
+                      : 0 );
 
-  Pointer_create( &vo, Dimensions_size_state( dims, NU ),
-                                            Env_cuda_is_using_device( env ) );
-  Pointer_set_pinned( &vo, Bool_true );
-  Pointer_allocate( &vo );
+  /*---Multiple right hand sides are swept together by folding the RHS axis
+       into the energy axis, as the faster varying index:
+       ie_sweep = irhs + nrhs * ie; see pack_state_rhs.  Each energy
+       slice holds the same groups of every right hand side.
+  ---*/
 
-  /*---Initialize input state array---*/
+  const Dimensions dims_rhs = dims;
 
-  initialize_state( Pointer_h( &vi ), dims, NU, &quan );
+  dims_g.ne *= nrhs;
+  dims.ne   *= nrhs;
 
-  /*---Initialize output state array---*/
-  /*---This is not strictly required for the output vector but might
-       have a performance effect from pre-touching pages.
-  ---*/
+  /*---Initialize quantities---*/
 
-  initialize_state_zero( Pointer_h( &vo ), dims, NU );
+  Quantities_create( &quan, dims, env );
 
   /*---Initialize sweeper---*/
 
@@ -141,41 +255,149 @@ void Runner_run_case( Runner* runner, Arguments* args, Env* env )
   Insist( Arguments_are_all_consumed( args )
                                           ? "Invalid argument detected." : 0 );
 
-  /*---Call sweeper---*/
+  /*---Allocate arrays---*/
+  /*---With several right hand sides, only the packed vectors are used
+       on the device---*/
 
-  t1 = Env_get_synced_time( env );
+  vi_rhs = (Pointer*)malloc( nrhs * sizeof(Pointer) );
+  vo_rhs = (Pointer*)malloc( nrhs * sizeof(Pointer) );
+
+  for( irhs=0; irhs<nrhs; ++irhs )
+  {
+    vi_rhs[irhs] = Pointer_null();
+    Pointer_create( &vi_rhs[irhs], Dimensions_size_state( dims_rhs, NU ),
+                    Env_cuda_is_using_device( env ) && nrhs == 1 );
+    Pointer_set_pinned( &vi_rhs[irhs], Bool_true );
+    Pointer_allocate( &vi_rhs[irhs] );
+
+    vo_rhs[irhs] = Pointer_null();
+    Pointer_create( &vo_rhs[irhs], Dimensions_size_state( dims_rhs, NU ),
+                    Env_cuda_is_using_device( env ) && nrhs == 1 );
+    Pointer_set_pinned( &vo_rhs[irhs], Bool_true );
+    Pointer_allocate( &vo_rhs[irhs] );
+
+    /*---Place state arrays near the threads that will use them, before
+         any other access---*/
+
+    if( nrhs == 1 )
+    {
+      Sweeper_place_state( &sweeper, Pointer_h( &vi_rhs[irhs] ), env );
+      Sweeper_place_state( &sweeper, Pointer_h( &vo_rhs[irhs] ), env );
+    }
+
+    /*---Initialize input state array, each right hand side with its own
+         source---*/
+
+    initialize_state_rhs( Pointer_h( &vi_rhs[irhs] ), dims_rhs, NU, &quan,
+                          irhs, nrhs );
+
+    /*---Initialize output state array---*/
+    /*---This is not strictly required for the output vector but might
+         have a performance effect from pre-touching pages.
+    ---*/
+
+    initialize_state_zero( Pointer_h( &vo_rhs[irhs] ), dims_rhs, NU );
+  }
+
+  /*---With several right hand sides, they are packed into the vectors
+       swept, outside the timed sweep---*/
 
-  for( iteration=0; iteration<niterations; ++iteration )
+  if( nrhs == 1 )
   {
-    Sweeper_sweep( &sweeper,
-                   iteration%2==0 ? &vo : &vi,
-                   iteration%2==0 ? &vi : &vo,
-                   &quan,
-                   env );
+    vi = &vi_rhs[0];
+    vo = &vo_rhs[0];
   }
+  else
+  {
+    Pointer_create( &vi_packed, Dimensions_size_state( dims, NU ),
+                                            Env_cuda_is_using_device( env ) );
+    Pointer_set_pinned( &vi_packed, Bool_true );
+    Pointer_allocate( &vi_packed );
+
+    Pointer_create( &vo_packed, Dimensions_size_state( dims, NU ),
+                                            Env_cuda_is_using_device( env ) );
+    Pointer_set_pinned( &vo_packed, Bool_true );
+    Pointer_allocate( &vo_packed );
+
+    Sweeper_place_state( &sweeper, Pointer_h( &vi_packed ), env );
+    Sweeper_place_state( &sweeper, Pointer_h( &vo_packed ), env );
+
+    Runner_pack_rhs_( &vi_packed, vi_rhs, nrhs, dims_rhs );
+    Runner_pack_rhs_( &vo_packed, vo_rhs, nrhs, dims_rhs );
+
+    vi = &vi_packed;
+    vo = &vo_packed;
+  }
+
+  /*---Call sweeper---*/
+  /*---As for Sweeper_sweep_iterations, even iterations sweep vi into vo
+       and odd ones vo into vi---*/
+
+  t1 = Env_get_synced_time( env );
+
+  Sweeper_sweep_iterations( &sweeper, vo, vi, niterations, &quan, env );
 
   t2 = Env_get_synced_time( env );
   runner->time = t2 - t1;
 
+  if( nrhs != 1 )
+  {
+    Runner_unpack_rhs_( vi_rhs, &vi_packed, nrhs, dims_rhs );
+    Runner_unpack_rhs_( vo_rhs, &vo_packed, nrhs, dims_rhs );
+
+    Pointer_destroy( &vi_packed );
+    Pointer_destroy( &vo_packed );
+  }
+
   /*---Compute flops used---*/
+  /*---Each angle group does its share of the octants---*/
 
   runner->flops = Env_sum_d( env, niterations *
          ( Dimensions_size_state( dims, NU ) * NOCTANT * 2. * dims.na
          + Dimensions_size_state_angles( dims, NU )
                                         * Quantities_flops_per_solve( dims )
-         + Dimensions_size_state( dims, NU ) * NOCTANT * 2. * dims.na ) );
+         + Dimensions_size_state( dims, NU ) * NOCTANT * 2. * dims.na ) )
+         / Env_nproc_a( env );
 
   runner->floprate = runner->time <= (Timer)0 ?
                                    0 : runner->flops / runner->time / 1e9;
 
+  /*---Compute face bytes communicated, likewise shared by angle groups---*/
+
+  double face_bytes_on_node = 0;
+  double face_bytes_off_node = 0;
+
+  Runner_face_bytes_( dims, env, &face_bytes_on_node, &face_bytes_off_node );
+
+  runner->face_bytes_on_node = Env_sum_d( env, niterations *
+                               face_bytes_on_node ) / Env_nproc_a( env );
+  runner->face_bytes_off_node = Env_sum_d( env, niterations *
+                               face_bytes_off_node ) / Env_nproc_a( env );
+
   /*---Compute, print norm squared of result---*/
+  /*---Each right hand side is checked against its own input---*/
 
-  get_state_norms( Pointer_h( &vi ), Pointer_h( &vo ),
-                     dims, NU, &runner->normsq, &runner->normsqdiff, env );
+  for( irhs=0; irhs<nrhs; ++irhs )
+  {
+    P normsq     = P_zero();
+    P normsqdiff = P_zero();
+
+    get_state_norms( Pointer_h( &vi_rhs[irhs] ), Pointer_h( &vo_rhs[irhs] ),
+                     dims_rhs, NU, &normsq, &normsqdiff, env );
+
+    runner->normsq     += normsq;
+    runner->normsqdiff += normsqdiff;
+  }
 
   /*---Deallocations---*/
-  Pointer_destroy( &vi );
-  Pointer_destroy( &vo );
+
+  for( irhs=0; irhs<nrhs; ++irhs )
+  {
+    Pointer_destroy( &vi_rhs[irhs] );
+    Pointer_destroy( &vo_rhs[irhs] );
+  }
+  free( (void*)vi_rhs );
+  free( (void*)vo_rhs );
 
   Sweeper_destroy( &sweeper, env );
   Quantities_destroy( &quan );
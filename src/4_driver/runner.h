@@ -14,6 +14,10 @@
 #include "arguments.h"
 #include "env.h"
 #include "definitions.h"
+#include "dimensions.h"
+#include "pointer.h"
+#include "quantities.h"
+#include "sweeper.h"
 
 #ifdef __cplusplus
 extern "C"
@@ -30,6 +34,8 @@ typedef struct
   double flops;
   double floprate;
   Timer  time;
+  double face_bytes_on_node;
+  double face_bytes_off_node;
 } Runner;
 
 /*===========================================================================*/
@@ -54,6 +54,15 @@ int main( int argc, char** argv )
             (double)runner.normsq, (double)runner.normsqdiff,
             runner.normsqdiff==P_zero() ? "PASS" : "FAIL",
             (double)runner.time, runner.floprate );
+    /*---Face traffic, split by whether the neighbor shares the node---*/
+    if( Env_nproc( &env ) > 1 )
+    {
+      const double face_bytes = runner.face_bytes_on_node +
+                                runner.face_bytes_off_node;
+      printf( "Face bytes on node: %.3e  off node: %.3e  on-node fraction:"
+              " %.3f\n", runner.face_bytes_on_node, runner.face_bytes_off_node,
+              face_bytes > 0 ? runner.face_bytes_on_node / face_bytes : 0. );
+    }
     /*---If invoked with no arguments as part of tester, then ouptut
          pass/fail count banner to be parsed by testing script---*/
     if( argc == 1 )
@@ -9,6 +9,7 @@
 /*---------------------------------------------------------------------------*/
 
 #include <stdio.h>
+#include <string.h>
 
 #include "arguments.h"
 #include "env.h"
@@ -95,6 +96,62 @@ static void test_serial( Env* env, int* ntest, int* ntest_passed )
       }
       }
     }
+
+    /*-----*/
+
+    {
+      char string_common[] = "--ncell_x 3 --ncell_y 4 --ncell_z 2 --na 5";
+      compare_runs_helper( env, ntest, ntest_passed, string_common,
+        "--ne 12", "--ne 4 --nrhs 3" );
+      compare_runs_helper( env, ntest, ntest_passed, string_common,
+        "--ne 12 --niterations 3", "--ne 4 --nrhs 3 --niterations 3" );
+      if( IS_USING_SIMD )
+      {
+        compare_runs_helper( env, ntest, ntest_passed, string_common,
+          "--ne 12", "--ne 4 --nrhs 3 --ne_per_batch 3" );
+      }
+    }
+
+    /*-----*/
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 3 --ncell_y 4 --ncell_z 6 --ne 3 --na 5 --nblock_z 3",
+      "", "--schedule 1" );
+
+    /*-----*/
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 3 --ncell_y 4 --ncell_z 6 --ne 3 --na 5 --nblock_z 3",
+      "", "--nangle_set 3 --nechunk 2" );
+
+    /*-----*/
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 3 --ncell_y 4 --ncell_z 6 --ne 3 --na 5 --nblock_z 3",
+      "", "--nsubdomain_x 2 --nsubdomain_y 3" );
+
+    /*-----*/
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 3 --ncell_y 4 --ncell_z 6 --ne 3 --na 5 --nblock_z 3",
+      "--niterations 3", "--niterations 3 --is_iteration_pipelined 1" );
+
+    /*-----*/
+
+    if( IS_USING_SIMD )
+    {
+      char string_common[] = "--ncell_x 3 --ncell_y 2 --ncell_z 3 "
+                             "--ne 7 --na 37";
+      int ne_per_batch = 0;
+      for( ne_per_batch=2; ne_per_batch<=8; ++ne_per_batch )
+      {
+        char string1[] = "";
+        char string2[MAX_LINE_LEN];
+        sprintf( string2, "--ne_per_batch %i", ne_per_batch );
+        compare_runs_helper( env, ntest, ntest_passed, string_common,
+          string1, string2 );
+      }
+    }
   }
 }
 
@@ -161,6 +218,118 @@ static void test_openmp( Env* env, int* ntest, int* ntest_passed )
 
     /*-----*/
 
+    if( IS_USING_SIMD )
+    {
+      char string2_3[MAX_LINE_LEN];
+      sprintf( string2_3, string_pat_2, 3, 2 );
+      strcat( string2_3, " --ne_per_batch 4" );
+
+      compare_runs_helper( env, ntest, ntest_passed, "", string1_2, string2_3 );
+    }
+
+    /*-----*/
+
+    /*---Several subblock chunks per thread along y and z---*/
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 4 --ncell_y 7 --ncell_z 5 --ne 3 --na 5 "
+      "--ncell_y_per_subblock 1 --ncell_z_per_subblock 1 ",
+      "--nthread_y 1 --nthread_z 1 --nthread_octant 1",
+      "--nthread_y 3 --nthread_z 2 --nthread_octant 4" );
+
+    /*-----*/
+
+    /*---Hyperplane threading, with odd semiblock sizes---*/
+
+    int nthread_x = 0;
+
+    for( nthread_x=2; nthread_x<=5; nthread_x+=3 )
+    {
+    for( nthread_octant=1; nthread_octant<=8; nthread_octant*=8 )
+    {
+      char string2_4[MAX_LINE_LEN];
+      sprintf( string2_4, "--nthread_x %i --nthread_e 2 --nthread_octant %i",
+               nthread_x, nthread_octant );
+
+      compare_runs_helper( env, ntest, ntest_passed,
+        "--ncell_x 5 --ncell_y 4 --ncell_z 3 --ne 3 --na 5 ",
+        "", string2_4 );
+    }
+    }
+
+    /*-----*/
+
+    /*---Fewer semiblock steps than octant threads: privatized vo---*/
+
+    int nsemiblock = 0;
+
+    for( nsemiblock=1; nsemiblock<=4; nsemiblock*=2 )
+    {
+      char string2_5[MAX_LINE_LEN];
+      sprintf( string2_5, "--nthread_e 2 --nthread_octant 8 --nsemiblock %i",
+               nsemiblock );
+
+      compare_runs_helper( env, ntest, ntest_passed,
+        "--ncell_x 5 --ncell_y 4 --ncell_z 6 --ne 3 --na 5 --nblock_z 3 ",
+        "", string2_5 );
+    }
+
+    /*-----*/
+
+    /*---NUMA placement: padded thread-local arrays, first touch---*/
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 5 --ncell_y 4 --ncell_z 3 --ne 5 --na 5 --nblock_z 3 ",
+      "", "--is_numa_placement 1 --nthread_e 3 --nthread_octant 4 "
+          "--nthread_x 2" );
+
+    /*-----*/
+
+    /*---Energy chunks: each step swept one chunk of energies at a time,
+         optionally also split into angle sets---*/
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 5 --ncell_y 4 --ncell_z 6 --ne 7 --na 5 --nblock_z 3 ",
+      "", "--nechunk 3 --nthread_e 2 --nthread_octant 8 --nsemiblock 2" );
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 5 --ncell_y 4 --ncell_z 6 --ne 7 --na 5 --nblock_z 3 ",
+      "", "--nangle_set 2 --nechunk 3 --nthread_e 2 --nthread_octant 8 "
+          "--nsemiblock 2" );
+
+    /*-----*/
+
+    /*---All-octant schedule: each octant thread sweeps several octants---*/
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 5 --ncell_y 4 --ncell_z 6 --ne 7 --na 5 --nblock_z 3 ",
+      "", "--schedule 1 --nthread_e 2 --nthread_octant 2" );
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 5 --ncell_y 4 --ncell_z 6 --ne 7 --na 5 --nblock_z 3 ",
+      "", "--schedule 1 --nthread_octant 4 --nsemiblock 2" );
+
+    /*-----*/
+
+    /*---Over-decomposition: several subdomains swept by each proc---*/
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 5 --ncell_y 4 --ncell_z 6 --ne 7 --na 5 --nblock_z 3 ",
+      "", "--nsubdomain_x 2 --nsubdomain_y 2 --nangle_set 2 --nthread_e 2 "
+          "--nthread_octant 8 --nsemiblock 2" );
+
+    /*-----*/
+
+    /*---Pipelining of iterations: each sweep overlaps the one before---*/
+
+    compare_runs_helper( env, ntest, ntest_passed,
+      "--ncell_x 5 --ncell_y 4 --ncell_z 6 --ne 7 --na 5 --nblock_z 3 "
+      "--niterations 4 ",
+      "", "--is_iteration_pipelined 1 --nthread_e 2 --nthread_octant 4 "
+          "--nechunk 2" );
+
+    /*-----*/
+
     const int ncell_x = 3;
     const int ncell_y = 4;
     const int ncell_z = 2;
@@ -449,6 +618,72 @@ static void test_mpi( Env* env, int* ntest, int* ntest_passed )
     compare_runs_helper( env, ntest, ntest_passed, string_common_4,
         "--nproc_x 4 --nproc_y 4 --nblock_z 2",
         "--nproc_x 4 --nproc_y 4 --nblock_z 4" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 4 --nproc_y 4 --nblock_z 4 --is_face_comm_aggregated 1" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 4 --nproc_y 4 --nblock_z 4 --nechunk 3" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 4 --nproc_y 4 --nblock_z 4 --nechunk 3"
+        " --is_face_comm_progress 1" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 4 --nproc_y 4 --nblock_z 4 --nechunk 3"
+        " --is_face_comm_shm 1" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 4 --nproc_y 4 --nblock_z 4 --is_proc_grid_node_aware 1" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 4 --nproc_y 4 --nblock_z 4 --schedule 1" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 4 --nproc_y 4 --nblock_z 4 --nangle_set 2 --nechunk 3" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 2 --nproc_y 2 --nproc_z 4 --nblock_z 2" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 2 --nproc_y 2 --nproc_z 4 --nblock_z 2"
+        " --is_face_comm_async 0" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 2 --nproc_y 2 --nproc_e 4 --nblock_z 2" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 2 --nproc_y 2 --nproc_a 4 --nblock_z 2" );
+
+    compare_runs_helper( env, ntest, ntest_passed,
+        "--ncell_x 5 --ncell_y 8 --ncell_z 16 --na 12",
+        "--ne 16 --nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--ne 4 --nrhs 4 --nproc_x 2 --nproc_y 2 --nproc_e 4 --nblock_z 2" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 2 --nproc_y 2 --nproc_e 4 --nblock_z 2"
+        " --nsubdomain_x 2 --nsubdomain_y 2 --nangle_set 2" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1",
+        "--nproc_x 4 --nproc_y 4 --nblock_z 4 --nsubdomain_y 2" );
+
+    compare_runs_helper( env, ntest, ntest_passed, string_common_4,
+        "--nproc_x 1 --nproc_y 1 --nblock_z 1 --niterations 3",
+        "--nproc_x 4 --nproc_y 4 --nblock_z 2 --niterations 3"
+        " --is_iteration_pipelined 1 --nangle_set 2" );
   }
 }
 